@@ -0,0 +1,107 @@
+#include "accesslist.h"
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+
+// 🔹 Рядок файлу: "<user_id>" або "<user_id> #коментар"
+static QSet<qint64> readIds(const QString &path) {
+    QSet<qint64> ids;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return ids;
+    }
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        bool ok = false;
+        qint64 id = in.readLine().section('#', 0, 0).trimmed().toLongLong(&ok);
+        if (ok) {
+            ids.insert(id);
+        }
+    }
+    return ids;
+}
+
+AccessList::AccessList(const QString &configDir) : configDir(configDir) {}
+
+AccessList::Data AccessList::readFiles(const QString &configDir) {
+    Data data;
+    data.admins = readIds(configDir + "/admins.txt");
+    data.users = readIds(configDir + "/users.txt");
+    data.blacklist = readIds(configDir + "/blacklist.txt");
+    return data;
+}
+
+void AccessList::reset(const Data &newData) {
+    data = newData;
+    loaded = true;
+    qDebug() << "🔐 Списки доступу завантажено: адмінів" << data.admins.size()
+             << ", користувачів" << data.users.size() << ", заблокованих" << data.blacklist.size();
+}
+
+/**
+ * @brief Якщо фонове завантаження ще не завершилось — читаємо синхронно
+ */
+void AccessList::ensureLoaded() {
+    if (!loaded) {
+        reload();
+    }
+}
+
+bool AccessList::isAdmin(qint64 userId) {
+    ensureLoaded();
+    return data.admins.contains(userId);
+}
+
+bool AccessList::isUser(qint64 userId) {
+    ensureLoaded();
+    return data.users.contains(userId);
+}
+
+bool AccessList::isBlacklisted(qint64 userId) {
+    ensureLoaded();
+    return data.blacklist.contains(userId);
+}
+
+QList<qint64> AccessList::admins() {
+    ensureLoaded();
+    return data.admins.values();
+}
+
+bool AccessList::addUser(qint64 userId, const QString &comment) {
+    ensureLoaded();
+    QString line = QString::number(userId);
+    if (!comment.isEmpty()) {
+        line += " #" + comment;
+    }
+    if (!appendLine(configDir + "/users.txt", line)) {
+        return false;
+    }
+    data.users.insert(userId);
+    return true;
+}
+
+bool AccessList::addBlacklisted(qint64 userId) {
+    ensureLoaded();
+    if (!appendLine(configDir + "/blacklist.txt", QString::number(userId))) {
+        return false;
+    }
+    data.blacklist.insert(userId);
+    return true;
+}
+
+void AccessList::allowInMemory(const QSet<qint64> &userIds) {
+    ensureLoaded();
+    data.users.unite(userIds);
+}
+
+bool AccessList::appendLine(const QString &path, const QString &line) {
+    QFile file(path);
+    if (!file.open(QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "❌ Не вдалося оновити" << path;
+        return false;
+    }
+    QTextStream out(&file);
+    out << line << "\n";
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef ACCESSLIST_H
+#define ACCESSLIST_H
+
+#include <QString>
+#include <QSet>
+#include <QList>
+
+/**
+ * @brief Списки доступу (admins.txt, users.txt, blacklist.txt) у пам'яті.
+ *
+ * Файли читаються один раз (можна у фоновому потоці під час старту),
+ * перевірки доступу далі не торкаються диска. Зміни через бота
+ * дописуються у файли і одразу потрапляють у пам'ять.
+ */
+class AccessList {
+public:
+    struct Data {
+        QSet<qint64> admins;
+        QSet<qint64> users;
+        QSet<qint64> blacklist;
+    };
+
+    explicit AccessList(const QString &configDir);
+
+    static Data readFiles(const QString &configDir);  // Без стану — безпечно викликати з будь-якого потоку
+    void reset(const Data &data);                     // Публікує прочитані списки
+    void reload() { reset(readFiles(configDir)); }
+    bool isLoaded() const { return loaded; }
+
+    bool isAdmin(qint64 userId);
+    bool isUser(qint64 userId);
+    bool isBlacklisted(qint64 userId);
+    QList<qint64> admins();
+
+    bool addUser(qint64 userId, const QString &comment);  // Дописує у users.txt
+    bool addBlacklisted(qint64 userId);                   // Дописує у blacklist.txt
+    void allowInMemory(const QSet<qint64> &userIds);      // Доступ без запису у файл (replay)
+
+private:
+    void ensureLoaded();
+    static bool appendLine(const QString &path, const QString &line);
+
+    QString configDir;
+    Data data;
+    bool loaded = false;
+};
+
+#endif // ACCESSLIST_H
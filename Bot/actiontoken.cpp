@@ -0,0 +1,24 @@
+#include "actiontoken.h"
+#include <QDebug>
+
+ActionToken::Ptr ActionToken::create(const QString &action, QDeadlineTimer deadline) {
+    return Ptr(new ActionToken(action, deadline));
+}
+
+void ActionToken::extendDeadline(QDeadlineTimer deadline) {
+    if (deadline > m_deadline) {
+        m_deadline = deadline;
+    }
+}
+
+void ActionToken::cancel(const QString &reason) {
+    if (m_cancelled) {
+        return;
+    }
+    m_cancelled = true;
+    m_reason = reason;
+    if (m_pending > 0) {
+        qDebug() << "🚫 Дію" << m_action << "скасовано (" << reason << "), запитів у польоті:" << m_pending;
+    }
+    emit cancelled();
+}
@@ -0,0 +1,52 @@
+#ifndef ACTIONTOKEN_H
+#define ACTIONTOKEN_H
+
+#include <QObject>
+#include <QString>
+#include <QDeadlineTimer>
+#include <memory>
+
+/**
+ * @brief Токен скасування і дедлайн однієї дії користувача.
+ *
+ * Створюється на кожну команду чату і передається в запити до Palantír:
+ * шлюз обмежує дедлайном transferTimeout і обриває запити дії
+ * (QNetworkReply::abort), коли її скасовано. Продовження перевіряють
+ * isCancelled() і не рендерять відповідь, яка вже нікому не потрібна.
+ * Вичерпаний дедлайн — не скасування: користувач досі чекає, тож шлюз
+ * віддає кеш або ознаку деградації, а бот повідомляє про тайм-аут.
+ */
+class ActionToken : public QObject {
+    Q_OBJECT
+public:
+    using Ptr = std::shared_ptr<ActionToken>;
+
+    static Ptr create(const QString &action, QDeadlineTimer deadline);
+
+    void cancel(const QString &reason);   // Повторне скасування нічого не робить
+    bool isCancelled() const { return m_cancelled; }   // Нова дія, меню, скидання сесії
+    bool isExpired() const { return !m_cancelled && m_deadline.hasExpired(); }
+    QDeadlineTimer deadline() const { return m_deadline; }
+    void extendDeadline(QDeadlineTimer deadline);   // Лише подовжує: спільний запит кількох дій
+    QString action() const { return m_action; }     // Команда, з якої почалась дія
+    QString reason() const { return m_reason; }
+
+    // 🔹 Запити дії, що ще в польоті (ведуть шлюз і клієнт Palantír)
+    void addWork() { ++m_pending; }
+    void doneWork() { --m_pending; }
+    int pending() const { return m_pending; }
+
+signals:
+    void cancelled();
+
+private:
+    ActionToken(const QString &action, QDeadlineTimer deadline) : m_action(action), m_deadline(deadline) {}
+
+    QString m_action;
+    QDeadlineTimer m_deadline;
+    QString m_reason;
+    bool m_cancelled = false;
+    int m_pending = 0;
+};
+
+#endif // ACTIONTOKEN_H
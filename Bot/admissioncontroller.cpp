@@ -0,0 +1,124 @@
+#include "admissioncontroller.h"
+#include "accesslist.h"
+#include "config.h"
+
+static const qint64 kNoticeIntervalMs = 10 * 1000;
+static const qint64 kIdleBucketMs = 10 * 60 * 1000;
+static const quint64 kPruneEvery = 1024;
+
+AdmissionController::AdmissionController(AccessList &acl) : acl(acl) {
+    clock.start();
+}
+
+/**
+ * @brief Вирішує, чи обробляти повідомлення, до будь-якого розбору тексту
+ */
+AdmissionController::Verdict AdmissionController::admit(qint64 userId, qint64 chatId, bool authorized, int backendInFlight) {
+    if (++calls % kPruneEvery == 0) {
+        pruneIdle();
+    }
+
+    if (acl.isBlacklisted(userId)) {
+        ++m_counters.blacklisted;
+        return Verdict::Blacklisted;
+    }
+
+    if (acl.isAdmin(userId)) {
+        ++m_counters.admitted;
+        return Verdict::Admit;
+    }
+
+    const ConfigSnapshot &config = Config::current();
+    qint64 now = clock.elapsed();
+
+    // 🔹 Невідомий користувач: один запит на доступ за період очікування
+    if (!authorized) {
+        auto it = approvalRequestedMs.find(userId);
+        if (it != approvalRequestedMs.end() && now - it.value() < qint64(config.approvalCooldownSec) * 1000) {
+            ++m_counters.approvalThrottled;
+            return Verdict::ApprovalThrottled;
+        }
+        approvalRequestedMs.insert(userId, now);
+        ++m_counters.admitted;
+        return Verdict::Admit;
+    }
+
+    if (config.maxBackendInFlight > 0 && backendInFlight >= config.maxBackendInFlight) {
+        ++m_counters.shed;
+        return Verdict::Shed;
+    }
+
+    if (!take(userBuckets[userId], config.userRatePerMin, config.userBurst)) {
+        ++m_counters.userLimited;
+        return Verdict::UserLimited;
+    }
+
+    if (!take(chatBuckets[chatId], config.chatRatePerMin, config.chatBurst)) {
+        ++m_counters.chatLimited;
+        return Verdict::ChatLimited;
+    }
+
+    ++m_counters.admitted;
+    return Verdict::Admit;
+}
+
+bool AdmissionController::take(Bucket &bucket, double perMinute, int burst) {
+    qint64 now = clock.elapsed();
+    if (bucket.tokens < 0) {
+        bucket.tokens = burst;
+    } else {
+        bucket.tokens = qMin(double(burst), bucket.tokens + (now - bucket.lastMs) * perMinute / 60000.0);
+    }
+    bucket.lastMs = now;
+
+    if (bucket.tokens < 1.0) {
+        return false;
+    }
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+bool AdmissionController::shouldNotify(qint64 chatId) {
+    qint64 now = clock.elapsed();
+    auto it = notifiedMs.find(chatId);
+    if (it != notifiedMs.end() && now - it.value() < kNoticeIntervalMs) {
+        return false;
+    }
+    notifiedMs.insert(chatId, now);
+    return true;
+}
+
+/**
+ * @brief Прибирає відра, що давно не використовувались (вони вже повні)
+ */
+void AdmissionController::pruneIdle() {
+    qint64 now = clock.elapsed();
+    auto pruneBuckets = [now](QHash<qint64, Bucket> &buckets) {
+        for (auto it = buckets.begin(); it != buckets.end();) {
+            it = now - it.value().lastMs > kIdleBucketMs ? buckets.erase(it) : std::next(it);
+        }
+    };
+    pruneBuckets(userBuckets);
+    pruneBuckets(chatBuckets);
+
+    for (auto it = notifiedMs.begin(); it != notifiedMs.end();) {
+        it = now - it.value() > kIdleBucketMs ? notifiedMs.erase(it) : std::next(it);
+    }
+
+    qint64 approvalMs = qint64(Config::current().approvalCooldownSec) * 1000;
+    for (auto it = approvalRequestedMs.begin(); it != approvalRequestedMs.end();) {
+        it = now - it.value() > approvalMs ? approvalRequestedMs.erase(it) : std::next(it);
+    }
+}
+
+QString AdmissionController::verdictName(Verdict verdict) {
+    switch (verdict) {
+    case Verdict::Admit: return "admit";
+    case Verdict::Blacklisted: return "blacklisted";
+    case Verdict::ApprovalThrottled: return "approval_throttled";
+    case Verdict::UserLimited: return "user_limited";
+    case Verdict::ChatLimited: return "chat_limited";
+    case Verdict::Shed: return "shed";
+    }
+    return "unknown";
+}
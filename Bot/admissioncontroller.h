@@ -0,0 +1,68 @@
+#ifndef ADMISSIONCONTROLLER_H
+#define ADMISSIONCONTROLLER_H
+
+#include <QHash>
+#include <QElapsedTimer>
+#include <QString>
+
+class AccessList;
+
+/**
+ * @brief Контроль допуску вхідних повідомлень.
+ *
+ * Дешева перевірка на самому початку обробки: чорний список, token bucket
+ * на користувача і на чат, обмеження запитів на доступ від невідомих
+ * користувачів і глобальне скидання навантаження, коли черга до Palantír
+ * переповнена. Адміністратори лімітам не підлягають.
+ */
+class AdmissionController {
+public:
+    enum class Verdict {
+        Admit,
+        Blacklisted,       // Мовчки ігноруємо
+        ApprovalThrottled, // Невідомий користувач уже чекає на рішення адміна
+        UserLimited,
+        ChatLimited,
+        Shed,              // Бекенд перевантажений
+    };
+
+    struct Counters {
+        quint64 admitted = 0;
+        quint64 blacklisted = 0;
+        quint64 approvalThrottled = 0;
+        quint64 userLimited = 0;
+        quint64 chatLimited = 0;
+        quint64 shed = 0;
+        quint64 dropped() const { return blacklisted + approvalThrottled + userLimited + chatLimited + shed; }
+    };
+
+    explicit AdmissionController(AccessList &acl);
+
+    // @param authorized Чи має користувач доступ (false — лише запит на доступ)
+    // @param backendInFlight Поточна кількість запитів до Palantír
+    Verdict admit(qint64 userId, qint64 chatId, bool authorized, int backendInFlight);
+    bool shouldNotify(qint64 chatId);     // Не частіше одного попередження на чат
+    const Counters &counters() const { return m_counters; }
+
+    static QString verdictName(Verdict verdict);
+
+private:
+    struct Bucket {
+        double tokens = -1;   // < 0 — ще не ініціалізовано
+        qint64 lastMs = 0;
+    };
+
+    bool take(Bucket &bucket, double perMinute, int burst);
+    void pruneIdle();
+
+    AccessList &acl;
+    QElapsedTimer clock;
+    QHash<qint64, Bucket> userBuckets;
+    QHash<qint64, Bucket> chatBuckets;
+    QHash<qint64, qint64> approvalRequestedMs;  // Останній запит на доступ від невідомого користувача
+    QHash<qint64, qint64> notifiedMs;           // Останнє попередження про ліміт у чаті
+    Counters m_counters;
+    quint64 calls = 0;
+};
+
+#endif // ADMISSIONCONTROLLER_H
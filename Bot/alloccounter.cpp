@@ -0,0 +1,54 @@
+#include "alloccounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef SHADOWFAX_ALLOC_COUNTERS
+static std::atomic<quint64> allocationCount{0};
+static std::atomic<quint64> allocatedBytes{0};
+
+void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
+namespace AllocCounter {
+
+bool isEnabled() {
+#ifdef SHADOWFAX_ALLOC_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+quint64 allocations() {
+#ifdef SHADOWFAX_ALLOC_COUNTERS
+    return allocationCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+quint64 bytes() {
+#ifdef SHADOWFAX_ALLOC_COUNTERS
+    return allocatedBytes.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+}
@@ -0,0 +1,16 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <QtGlobal>
+
+// 🔹 Лічильник динамічних алокацій для порівняння збірок під час replay.
+//    Працює лише у збірці з SHADOWFAX_ALLOC_COUNTERS (замінює глобальний operator new).
+namespace AllocCounter {
+
+bool isEnabled();
+quint64 allocations();   // Кількість викликів operator new від старту процесу
+quint64 bytes();         // Сумарно запитано байт
+
+}
+
+#endif // ALLOCCOUNTER_H
@@ -1,11 +1,13 @@
 #include "bot.h"
 #include "config.h"
+#include "renderers.h"
+#include "jsonarraystream.h"
+#include "localsocketnetworkmanager.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QNetworkReply>
 #include <QDebug>
-#include <QSettings>
 #include <QFile>
 #include <QDir>
 #include <QTextStream>
@@ -13,21 +15,107 @@
 #include <QDateTime>
 #include <QRegularExpression>
 #include <QUrlQuery>
-#include <QThread>
 #include <QProcess>
+#include <QBuffer>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QLocale>
+#include <QThreadPool>
+#include <variant>
 
 static QFile logFile;
+static QMutex logMutex;  // Ротація логів пише з потоку пулу
 
 
-Bot::Bot(QObject *parent) : QObject(parent) {
+Bot::Bot(QNetworkAccessManager *transport, QObject *parent)
+    : QObject(parent), acl(QCoreApplication::applicationDirPath() + "/Config"), admission(acl) {
+    replaying = transport != nullptr;
     lastUpdateId = 0;  // Ініціалізуємо update_id
-    networkManager = new QNetworkAccessManager(this);
-    loadBotToken();
+    // 🔹 Palantír на тому ж хості — через Unix-сокет, якщо задано [Palantir] socket
+    networkManager = replaying ? transport : new LocalSocketNetworkManager(this);
+    startup = new StartupSequence(networkManager, this);
+    palantir = new PalantirGateway(networkManager, this);
+    client = new PalantirClient(palantir, this);
+    // 🔹 Фонові задачі не витісняють кеш користувачів і не відкривають їхній запобіжник
+    backgroundPalantir = new PalantirGateway(networkManager, this);
+    backgroundClient = new PalantirClient(backgroundPalantir, this);
+
+    // 🗂 Знімок каталогу: відповіді після перезапуску і при недоступному Palantír
+    if (!replaying) {
+        snapshot = new CatalogSnapshot(QCoreApplication::applicationDirPath() + "/Config/catalog.snap", this);
+        palantir->setSnapshot(snapshot);
+        backgroundPalantir->setSnapshot(snapshot);   // Обхід парку — головне джерело свіжого знімка
+    }
+    telegram = new TelegramApi(networkManager, this);
+    if (replaying) {
+        botToken = "replay";
+    } else {
+        loadBotToken();
+    }
+    telegram->setToken(botToken);
+    // ⏱ Затримка циклу подій: проба і потік-сторож
+    loopMonitor = new LoopMonitor(this);
+    loopMonitor->start(Config::current().lagProbeMs, Config::current().stallThresholdMs);
+
+    pollTimer = new QTimer(this);
+    pollTimer->setSingleShot(true);
+    connect(pollTimer, &QTimer::timeout, this, &Bot::getUpdates);
+    pollWatchdog = new QTimer(this);
+    connect(pollWatchdog, &QTimer::timeout, this, &Bot::checkPolling);
+
+    outbound = new OutboundQueue(telegram, this);
+    views = new ChatViews(telegram, outbound, this);
+
+    // 📢 Продовжуємо розсилку, перервану перезапуском
+    broadcastJob = new BroadcastJob(telegram, QCoreApplication::applicationDirPath() + "/Config", this);
+
+    // 🔭 Фоновий обхід терміналів і сповіщення підписників про зміни
+    fleetWatcher = new FleetWatcher(backgroundPalantir, QCoreApplication::applicationDirPath() + "/Config", this);
+    fleetWatcher->setIndex(&fleetIndex);
+    connect(fleetWatcher, &FleetWatcher::changeDetected, this, [this](qint64 chatId, const QString &text) {
+        sendMessage(chatId, text);
+    });
+
+    // 📰 Зведення за розкладом: дані клієнта запитуються один раз на всіх підписників
+    digests = new DigestScheduler(backgroundPalantir, backgroundClient, QCoreApplication::applicationDirPath() + "/Config", this);
+    digests->setIndex(&fleetIndex);
+    connect(digests, &DigestScheduler::deliver, this, [this](qint64 chatId, const QString &text) {
+        sendMessage(chatId, text);
+    });
+
+    // 🔄 Новий знімок конфігурації: підхоплюємо токен та інтервали без перезапуску
+    connect(&Config::instance(), &Config::reloaded, this, [this]() {
+        const ConfigSnapshot &config = Config::current();
+        if (!config.botToken.isEmpty() && config.botToken != botToken) {
+            botToken = config.botToken;
+            telegram->setToken(botToken);
+            qInfo() << "🔄 Токен бота оновлено.";
+        }
+        if (!replaying && !handingOff) {
+            fleetWatcher->start(config.sweepIntervalMin * 60 * 1000);
+            snapshot->start(config.snapshotFlushSec * 1000);
+            digests->start();   // [Digest] time міг змінитися
+        }
+        loopMonitor->start(config.lagProbeMs, config.stallThresholdMs);
+        acl.reload();  // Списки доступу могли змінити вручну
+    });
+
+    // ⏱ Time-to-first-reply: перша успішна відповідь користувачу після запуску
+    auto firstReply = std::make_shared<QMetaObject::Connection>();
+    *firstReply = connect(networkManager, &QNetworkAccessManager::finished, this, [this, firstReply](QNetworkReply *reply) {
+        static const QStringList replyMethods = { "sendMessage", "editMessageText", "sendDocument" };
+        QString method = reply->url().path().section('/', -1);
+        if (reply->error() == QNetworkReply::NoError && replyMethods.contains(method)) {
+            startup->markFirstReply();
+            disconnect(*firstReply);
+        }
+    });
 
-    // ⏰ Запускаємо ротацію логів щодня о 00:01
+    // ⏰ Запускаємо ротацію логів щодня о 00:01 — у пулі, як і на старті: 7z не блокує цикл подій
     QTimer *logRotationTimer = new QTimer(this);
     connect(logRotationTimer, &QTimer::timeout, this, []() {
-        Bot::rotateOldLogs();
+        QThreadPool::globalInstance()->start(&Bot::rotateOldLogs);
     });
 
     int msecToNextRun = QTime::currentTime().msecsTo(QTime(0, 1, 0));
@@ -37,7 +125,7 @@ Bot::Bot(QObject *parent) : QObject(parent) {
 
     QTimer::singleShot(msecToNextRun, this, [this, logRotationTimer]() {
         logRotationTimer->start(24 * 60 * 60 * 1000);  // запуск кожні 24 год
-        Bot::rotateOldLogs();  // перший виклик одразу
+        QThreadPool::globalInstance()->start(&Bot::rotateOldLogs);  // перший виклик одразу
         qDebug() << "🕐 Перша ротація логів відбулася одразу після опівночі.";
     });
 
@@ -53,7 +141,7 @@ void Bot::initLogging() {
     if (!logDir.exists()) {
         logDir.mkpath(".");
     }
-    rotateOldLogs();
+    // Ротація старих логів виконується у фоні під час старту (Bot::startPolling)
     QString currentDate = QDate::currentDate().toString("yyyy-MM-dd");
     QString logFilePath = logDirPath + QString("/shadowfax_%1.log").arg(currentDate);
 
@@ -70,6 +158,7 @@ void Bot::initLogging() {
         .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"))
             .arg(msg);
 
+        QMutexLocker locker(&logMutex);
         QTextStream logStream(&logFile);
         logStream << logEntry << "\n";  // 🔹 Записуємо у файл
         logStream.flush();
@@ -82,9 +171,9 @@ void Bot::initLogging() {
 }
 
 void Bot::rotateOldLogs() {
-    QString configPath = QCoreApplication::applicationDirPath() + "/config/config.ini";
-    QSettings settings(configPath, QSettings::IniFormat);
-    QString sevenZipPath = settings.value("Logging/seven_zip_path", "").toString();
+    LoopMonitor::Activity activity("Bot::rotateOldLogs");
+    const ConfigSnapshot &config = Config::current();
+    QString sevenZipPath = config.sevenZipPath;
 
     if (sevenZipPath.isEmpty() || !QFile::exists(sevenZipPath)) {
         qCritical() << "❌ 7z.exe not found! Set Logging/seven_zip_path in config.ini";
@@ -137,7 +226,7 @@ void Bot::rotateOldLogs() {
     }
 
     // 🔸 Очистка старих архівів
-    int retentionDays = settings.value("Logging/log_retention_days", 7).toInt();
+    int retentionDays = config.logRetentionDays;
     QDate thresholdDate = today.addDays(-retentionDays);
 
     QStringList archiveFiles = logDir.entryList(QStringList() << "shadowfax_*.7z", QDir::Files);
@@ -161,7 +250,7 @@ void Bot::rotateOldLogs() {
  * @brief Завантажує токен бота з config.ini або створює файл, якщо його немає.
  */
 void Bot::loadBotToken() {
-    QString configPath = QCoreApplication::applicationDirPath() + "/config/config.ini";
+    QString configPath = Config::configPath();
     qDebug() << "Checking config file at:" << configPath;
 
     QFile configFile(configPath);
@@ -189,9 +278,8 @@ void Bot::loadBotToken() {
         }
     }
 
-    // 🔹 Читаємо токен
-    QSettings settings(configPath, QSettings::IniFormat);
-    botToken = settings.value("Telegram/bot_token", "").toString();
+    // 🔹 Читаємо токен зі знімка конфігурації
+    botToken = Config::current().botToken;
     qDebug() << "Read bot token from config.ini:" << (botToken.isEmpty() ? "EMPTY" : "LOADED");
 
     if (botToken.isEmpty()) {
@@ -203,106 +291,501 @@ void Bot::loadBotToken() {
 }
 
 
+/**
+ * @brief Запускає бота: незалежні кроки старту виконуються паралельно з першим long poll
+ */
 void Bot::startPolling() {
     qDebug() << "🤖 Бот запущений!";
+    const ConfigSnapshot &config = Config::current();
+
+    // 🔹 Фонові задачі, що пишуть на диск, стартують тут, а не в конструкторі:
+    //    при передачі стану — лише після того, як старий процес їх зупинив
+    if (!replaying) {
+        startBackgroundJobs();
+
+        // 🔹 TLS-рукостискання до того, як прийде перший користувач
+        startup->preconnect(QUrl(config.telegramApiUrl));
+        startup->preconnect(QUrl(config.palantirBaseUrl));
+    }
+
+    // 🔹 Архівація 7z — найдовший крок, не повинна затримувати відповіді
+    startup->runInPool("log rotation", &Bot::rotateOldLogs);
+
+    // 🔹 Адміністратор за замовчуванням і списки доступу
+    QString configDir = QCoreApplication::applicationDirPath() + "/Config";
+    auto accessData = std::make_shared<AccessList::Data>();
+    startup->runInPool("access lists", [configDir, accessData]() {
+        if (Config::current().useAuth) {
+            ensureAdminExists();
+        }
+        *accessData = AccessList::readFiles(configDir);
+    }, [this, accessData]() {
+        if (!acl.isLoaded()) {
+            acl.reset(*accessData);
+        }
+    });
+
+    // 🔹 Каталог клієнтів для /clients і кнопок вибору клієнта:
+    //    зі знімка — одразу, з Palantír — оновлення у фоні
+    QByteArray snapshotClients;
+    QDateTime snapshotClientsAt;
+    bool fromSnapshot = snapshot && snapshot->lookup("clients?", &snapshotClients, &snapshotClientsAt);
+    if (fromSnapshot) {
+        cacheClients(snapshotClients);
+        qInfo() << "🗂 Каталог клієнтів зі знімка станом на" << snapshotClientsAt.toString("dd.MM HH:mm");
+    } else {
+        startup->beginStep("clients");
+    }
+    palantir->get("clients", QUrlQuery(), [this, fromSnapshot](const PalantirResponse &response) {
+        if (response.ok && !(fromSnapshot && response.fromCache)) {
+            cacheClients(response.body);
+        } else if (!response.ok) {
+            qWarning() << "❌ Не вдалося попередньо завантажити клієнтів:" << response.errorString;
+        }
+        if (!fromSnapshot) {
+            startup->finishStep("clients");
+        }
+    });
+
+    startup->start();
+    getUpdates();
+    pollWatchdog->start(10 * 1000);
+
+    if (replaying) {
+        return;   // Справжній процес на тому ж сокеті віддав би нам свій стан
+    }
+
+    // 🔁 Наступна версія процесу зможе забрати стан без простою
+    handoffServer = new HandoffServer(config.handoffSocket, [this](HandoffServer::Ready ready) {
+        beginHandoff(std::move(ready));
+    }, this);
+    connect(handoffServer, &HandoffServer::handedOff, this, &Bot::finishHandoff);
+    connect(handoffServer, &HandoffServer::aborted, this, &Bot::resumeAfterHandoff);
+    handoffServer->listen();
+}
+
+void Bot::startBackgroundJobs() {
+    const ConfigSnapshot &config = Config::current();
+    broadcastJob->resume();  // 📢 Продовжуємо розсилку, перервану перезапуском
+    fleetWatcher->start(config.sweepIntervalMin * 60 * 1000);
+    snapshot->start(config.snapshotFlushSec * 1000);
+    digests->start();
+}
+
+/**
+ * @brief Новий процес просить стан: зупиняємо опитування і фонові задачі.
+ *        Стан віддаємо, коли розсилка не має повідомлень у польоті — інакше
+ *        новий процес надіслав би їх повторно.
+ */
+void Bot::beginHandoff(HandoffServer::Ready ready) {
+    handingOff = true;
+    stopPolling();
+    fleetWatcher->stop();
+    snapshot->stop();
+    digests->stop();
+    broadcastJob->suspend();
+
+    QElapsedTimer waited;
+    waited.start();
+    QTimer *timer = new QTimer(this);
+    connect(timer, &QTimer::timeout, this, [this, timer, waited, ready]() {
+        if (!broadcastJob->isIdle() && waited.elapsed() < 5000) {
+            return;
+        }
+        timer->deleteLater();
+        ready(exportState());
+    });
+    timer->start(20);
+}
+
+/**
+ * @brief Новий процес прийняв стан: дочищаємо вихідну чергу і відповіді Palantír у польоті, потім виходимо
+ */
+void Bot::finishHandoff() {
+    const int drainMs = Config::current().handoffDrainSec * 1000;
+    qInfo() << "🔁 Дочищаємо вихідні черги перед завершенням (до" << drainMs / 1000 << "с)";
+
+    QElapsedTimer waited;
+    waited.start();
+    QTimer *timer = new QTimer(this);
+    connect(timer, &QTimer::timeout, this, [this, waited, drainMs]() {
+        const bool drained = outbound->isIdle() && palantir->inFlight() == 0 && backgroundPalantir->inFlight() == 0
+                             && broadcastJob->isIdle() && digests->isIdle();
+        if (!drained && waited.elapsed() < drainMs) {
+            return;
+        }
+        if (!drained) {
+            qWarning() << "⚠️ Черги не дочищено за" << drainMs / 1000 << "с, завершуємо";
+        }
+        qInfo() << "👋 Роботу передано новому процесу";
+        QCoreApplication::quit();
+    });
+    timer->start(100);
+}
+
+/**
+ * @brief Передачу перервано: продовжуємо працювати самі
+ */
+void Bot::resumeAfterHandoff() {
+    handingOff = false;
+    startBackgroundJobs();
     getUpdates();
+    pollWatchdog->start(10 * 1000);
+}
+
+/**
+ * @brief Стан для нового процесу: offset оновлень, сесії, види чатів і теплі кеші
+ */
+QJsonObject Bot::exportState() const {
+    QJsonObject state;
+    state["version"] = 1;
+    state["offset"] = lastUpdateId;
+
+    state["session"] = QJsonObject{
+        {"chat_id", lastChatId},
+        {"client_id", lastSelectedClientId},
+        {"terminal_id", lastSelectedTerminalId},
+        {"waiting_terminal", waitingForTerminal},
+        {"waiting_broadcast", waitingForBroadcastMessage},
+    };
+
+    QJsonObject activity;
+    for (auto it = lastActivity.cbegin(); it != lastActivity.cend(); ++it) {
+        activity[QString::number(it.key())] = it.value().toMSecsSinceEpoch();
+    }
+    state["activity"] = activity;
+
+    QJsonObject approvals;
+    for (auto it = lastApprovalRequest.cbegin(); it != lastApprovalRequest.cend(); ++it) {
+        const auto &[firstName, lastName, username] = it.value();
+        approvals[QString::number(it.key())] = QJsonArray{ firstName, lastName, username };
+    }
+    state["approvals"] = approvals;
+
+    QJsonObject chatViews;
+    const QHash<qint64, qint64> messageIds = views->messageIds();
+    for (auto it = messageIds.cbegin(); it != messageIds.cend(); ++it) {
+        chatViews[QString::number(it.key())] = it.value();
+    }
+    state["views"] = chatViews;
+
+    state["clients"] = QString::fromLatin1(clientsCatalog.toBase64());
+
+    QJsonArray cache;
+    for (const PalantirGateway::CachedResponse &response : palantir->cachedResponses()) {
+        cache.append(QJsonObject{
+            {"url", response.url},
+            {"body", QString::fromLatin1(response.body.toBase64())},
+            {"fetched_at", response.fetchedAt.toMSecsSinceEpoch()},
+        });
+    }
+    state["cache"] = cache;
+    return state;
+}
+
+void Bot::restoreState(const QJsonObject &state) {
+    lastUpdateId = state["offset"].toVariant().toLongLong();
+
+    const QJsonObject session = state["session"].toObject();
+    lastChatId = session["chat_id"].toVariant().toLongLong();
+    lastSelectedClientId = session["client_id"].toVariant().toLongLong();
+    lastSelectedTerminalId = session["terminal_id"].toVariant().toLongLong();
+    waitingForTerminal = session["waiting_terminal"].toBool();
+    waitingForBroadcastMessage = session["waiting_broadcast"].toBool();
+
+    const QJsonObject activity = state["activity"].toObject();
+    for (auto it = activity.begin(); it != activity.end(); ++it) {
+        lastActivity[it.key().toLongLong()] = QDateTime::fromMSecsSinceEpoch(it.value().toVariant().toLongLong());
+    }
+
+    const QJsonObject approvals = state["approvals"].toObject();
+    for (auto it = approvals.begin(); it != approvals.end(); ++it) {
+        const QJsonArray user = it.value().toArray();
+        lastApprovalRequest[it.key().toLongLong()] = std::make_tuple(user[0].toString(), user[1].toString(), user[2].toString());
+    }
+
+    const QJsonObject chatViews = state["views"].toObject();
+    for (auto it = chatViews.begin(); it != chatViews.end(); ++it) {
+        views->attach(it.key().toLongLong(), it.value().toVariant().toLongLong());
+    }
+
+    const QByteArray clients = QByteArray::fromBase64(state["clients"].toString().toLatin1());
+    if (!clients.isEmpty()) {
+        cacheClients(clients);
+    }
+
+    QList<PalantirGateway::CachedResponse> responses;
+    for (const QJsonValue &value : state["cache"].toArray()) {
+        const QJsonObject entry = value.toObject();
+        responses.append(PalantirGateway::CachedResponse{
+            entry["url"].toString(),
+            QByteArray::fromBase64(entry["body"].toString().toLatin1()),
+            QDateTime::fromMSecsSinceEpoch(entry["fetched_at"].toVariant().toLongLong()),
+        });
+    }
+    palantir->warmCache(responses);
+
+    qInfo() << "🔁 Прийнято стан: offset" << lastUpdateId << ", сесій" << lastActivity.size()
+            << ", видів" << chatViews.size() << ", відповідей у кеші" << responses.size();
 }
 
 
 
 void Bot::getUpdates() {
-    QString url = QString("https://api.telegram.org/bot%1/getUpdates?offset=%2&timeout=30")
-    .arg(botToken)
-        .arg(lastUpdateId + 1);
+    const ConfigSnapshot &config = Config::current();
+    QString url = QString("%1/bot%2/getUpdates?offset=%3&timeout=%4")
+    .arg(config.telegramApiUrl, botToken)
+        .arg(lastUpdateId + 1)
+        .arg(config.pollTimeoutSec);
 
     qDebug() << "🔹 Виконуємо запит до Telegram API:" << url;
 
     QNetworkRequest request(url);
+    request.setTransferTimeout((config.pollTimeoutSec + config.pollWatchdogSec) * 1000);
     QNetworkReply *reply = networkManager->get(request);
+    pollReply = reply;
+    pollActivity.start();
 
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        LoopMonitor::Activity activity("Bot::getUpdates");
+
         if (reply->error() != QNetworkReply::NoError) {
             qWarning() << "❌ Помилка мережі:" << reply->errorString();
             reply->deleteLater();
-            QTimer::singleShot(5000, this, &Bot::getUpdates);
+            schedulePoll(5000);
             return;
         }
 
-        QByteArray responseData = reply->readAll();
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(responseData);
-        QJsonObject jsonObject = jsonResponse.object();
-
-        qDebug() << "📩 Отримано відповідь від Telegram API:" << jsonObject;
-
-        if (!jsonObject["ok"].toBool()) {
-            qWarning() << "❌ Telegram API повернуло помилку!" << jsonObject;
+        QList<QJsonObject> updates;
+        if (!parseUpdates(reply->readAll(), updates, lastUpdateId)) {
             reply->deleteLater();
-            QTimer::singleShot(5000, this, &Bot::getUpdates);
+            schedulePoll(5000);
             return;
         }
 
-        QJsonArray updates = jsonObject["result"].toArray();
-        qDebug() << "🔹 Кількість нових повідомлень:" << updates.size();
+        for (const QJsonObject &updateObj : std::as_const(updates)) {
+            processUpdate(updateObj);
+        }
 
-        for (const QJsonValue &update : updates) {
-            QJsonObject updateObj = update.toObject();
-            qint64 updateId = updateObj["update_id"].toVariant().toLongLong();
+        reply->deleteLater();
+        schedulePoll(2000);
+    });
+}
 
-            if (updateId > lastUpdateId)
-                lastUpdateId = updateId;
+/**
+ * @brief Розбирає відповідь getUpdates
+ * @param updates Сюди додаються оновлення в порядку Telegram
+ * @param lastUpdateId Оновлюється найбільшим update_id
+ * @return false, якщо Telegram повернув помилку
+ */
+bool Bot::parseUpdates(const QByteArray &body, QList<QJsonObject> &updates, qint64 &lastUpdateId) {
+    QJsonObject jsonObject = QJsonDocument::fromJson(body).object();
 
-            QJsonObject message;
+    if (!jsonObject["ok"].toBool()) {
+        qWarning() << "❌ Telegram API повернуло помилку!" << jsonObject;
+        return false;
+    }
 
-            // 🔍 Шукаємо або message, або edited_message
-            if (updateObj.contains("message")) {
-                message = updateObj["message"].toObject();
-            } else if (updateObj.contains("edited_message")) {
-                message = updateObj["edited_message"].toObject();
-            } else {
-                // 🟡 Ігноруємо інші типи оновлень (наприклад, my_chat_member)
-                qWarning() << "❌ Отримано оновлення без message або edited_message. Повне оновлення:" << updateObj;
-                continue;  // ✅ Продовжуємо цикл
-            }
+    const QJsonArray result = jsonObject["result"].toArray();
+    qDebug() << "🔹 Кількість нових повідомлень:" << result.size();
 
-            if (message.isEmpty()) {
-                qWarning() << "⚠️ message порожнє.";
-                continue;
-            }
+    updates.reserve(updates.size() + result.size());
+    for (const QJsonValue &update : result) {
+        QJsonObject updateObj = update.toObject();
+        qint64 updateId = updateObj["update_id"].toVariant().toLongLong();
 
-            // 🔹 Обробка чату
-            qint64 chatId = message["chat"].toObject()["id"].toVariant().toLongLong();
-            if (chatId == 0) {
-                qWarning() << "❌ Помилка: отримано chatId = 0! Повне повідомлення:" << message;
-                continue;
-            }
+        if (updateId > lastUpdateId)
+            lastUpdateId = updateId;
 
-            QString text = message["text"].toString();
-            qDebug() << "🔹 Отримано текстове повідомлення:" << text;
+        updates.append(updateObj);
+    }
+    return true;
+}
 
-            // 🔍 Витягуємо додаткову інформацію про користувача
-            QJsonObject from = message["from"].toObject();
-            qint64 userId = from["id"].toVariant().toLongLong();
-            QString firstName = from["first_name"].toString();
-            QString lastName = from["last_name"].toString();
-            QString username = from["username"].toString();
+/**
+ * @brief Планує наступний long poll; один таймер — не більше одного циклу опитування
+ */
+void Bot::schedulePoll(int delayMs) {
+    pollReply = nullptr;
+    pollActivity.start();
+    pollTimer->start(delayMs);
+}
 
-            QString cleanText = text.simplified().trimmed();
-            qInfo() << "📩 Обробка повідомлення від" << userId << "(Chat ID:" << chatId << "):" << cleanText;
+/**
+ * @brief Сторож long poll: якщо getUpdates довго не запускався і не завершувався — перезапуск
+ */
+void Bot::checkPolling() {
+    const ConfigSnapshot &config = Config::current();
+    const qint64 limitMs = qint64(config.pollTimeoutSec + config.pollWatchdogSec) * 1000;
+    if (!pollActivity.isValid() || pollActivity.elapsed() < limitMs) {
+        return;
+    }
 
-            // 🔁 Передаємо повідомлення на обробку
-            processMessage(chatId, userId, text, firstName, lastName, username);
-        }
+    ++pollRestarts;
+    qWarning() << "🐕 Long poll не відповідає" << pollActivity.elapsed() / 1000 << "с — перезапускаємо";
 
-        reply->deleteLater();
-        QTimer::singleShot(2000, this, &Bot::getUpdates);
-    });
+    abortPoll();
+    getUpdates();
+}
+
+/**
+ * @brief Скасовує заплановане або поточне опитування без планування наступного
+ */
+void Bot::abortPoll() {
+    pollTimer->stop();
+    if (pollReply) {
+        QNetworkReply *stuck = pollReply;
+        pollReply = nullptr;
+        disconnect(stuck, nullptr, this, nullptr);   // Обірваний запит не планує власний цикл
+        stuck->abort();
+        stuck->deleteLater();
+    }
+}
+
+/**
+ * @brief Зупиняє опитування Telegram; непідтверджені оновлення лишаються на сервері
+ */
+void Bot::stopPolling() {
+    pollWatchdog->stop();
+    abortPoll();
+    pollActivity.invalidate();
+}
+
+
+
+/**
+ * @brief Обробляє одне оновлення Telegram (повідомлення або натискання кнопки)
+ * @param updateObj Об'єкт оновлення з getUpdates (або із запису трафіку)
+ */
+void Bot::processUpdate(const QJsonObject &updateObj) {
+    LoopMonitor::Activity activity("Bot::processUpdate");
+
+    if (recorder) {
+        recorder->recordUpdate(updateObj);
+    }
+
+    // 🔘 Натискання inline-кнопки поточного виду
+    if (updateObj.contains("callback_query")) {
+        handleCallbackQuery(updateObj["callback_query"].toObject());
+        return;
+    }
+
+    QJsonObject message;
+
+    // 🔍 Шукаємо або message, або edited_message
+    if (updateObj.contains("message")) {
+        message = updateObj["message"].toObject();
+    } else if (updateObj.contains("edited_message")) {
+        message = updateObj["edited_message"].toObject();
+    } else {
+        // 🟡 Ігноруємо інші типи оновлень (наприклад, my_chat_member)
+        qWarning() << "❌ Отримано оновлення без message або edited_message. Повне оновлення:" << updateObj;
+        return;
+    }
+
+    if (message.isEmpty()) {
+        qWarning() << "⚠️ message порожнє.";
+        return;
+    }
+
+    // 🔹 Обробка чату
+    qint64 chatId = message["chat"].toObject()["id"].toVariant().toLongLong();
+    if (chatId == 0) {
+        qWarning() << "❌ Помилка: отримано chatId = 0! Повне повідомлення:" << message;
+        return;
+    }
+
+    QString text = message["text"].toString();
+    qDebug() << "🔹 Отримано текстове повідомлення:" << text;
+
+    // 📍 Користувач поділився геопозицією — це запит найближчих АЗС
+    //    (оновлення live-локації приходять як edited_message і ігноруються)
+    if (message.contains("location") && !updateObj.contains("edited_message")) {
+        QJsonObject location = message["location"].toObject();
+        text = QString("/nearest %1 %2")
+                   .arg(location["latitude"].toDouble(), 0, 'f', 6)
+                   .arg(location["longitude"].toDouble(), 0, 'f', 6);
+    }
+
+    // 🔍 Витягуємо додаткову інформацію про користувача
+    QJsonObject from = message["from"].toObject();
+    qint64 userId = from["id"].toVariant().toLongLong();
+    QString firstName = from["first_name"].toString();
+    QString lastName = from["last_name"].toString();
+    QString username = from["username"].toString();
+
+    QString cleanText = text.simplified().trimmed();
+    qInfo() << "📩 Обробка повідомлення від" << userId << "(Chat ID:" << chatId << "):" << cleanText;
+
+    // 🔹 Користувач написав сам — наступний вид з'явиться новим повідомленням під його текстом
+    views->detach(chatId);
+
+    // 🔁 Передаємо повідомлення на обробку
+    processMessage(chatId, userId, text, firstName, lastName, username);
+}
+
+void Bot::setRecorder(TrafficRecorder *trafficRecorder) {
+    recorder = trafficRecorder;
+    palantir->setRecorder(trafficRecorder);
+    backgroundPalantir->setRecorder(trafficRecorder);
 }
 
+void Bot::allowUsers(const QSet<qint64> &userIds) {
+    acl.allowInMemory(userIds);
+}
+
+
+
+/**
+ * @brief Обробляє натискання inline-кнопки: відповідає Telegram і виконує команду з callback_data
+ * @param callbackQuery Об'єкт callback_query з оновлення
+ */
+void Bot::handleCallbackQuery(const QJsonObject &callbackQuery) {
+    QJsonObject answer;
+    answer["callback_query_id"] = callbackQuery["id"].toString();
+    telegram->call("answerCallbackQuery", answer);
+
+    QJsonObject message = callbackQuery["message"].toObject();
+    qint64 chatId = message["chat"].toObject()["id"].toVariant().toLongLong();
+    qint64 messageId = message["message_id"].toVariant().toLongLong();
+    if (chatId == 0) {
+        qWarning() << "❌ callback_query без чату:" << callbackQuery;
+        return;
+    }
+
+    QJsonObject from = callbackQuery["from"].toObject();
+    qint64 userId = from["id"].toVariant().toLongLong();
+    QString data = callbackQuery["data"].toString();
+
+    qInfo() << "🔘 Натиснуто кнопку" << data << "користувачем" << userId << "(Chat ID:" << chatId << ")";
+
+    // 🔹 Відповідь покажемо в тому ж повідомленні, під яким натиснули кнопку
+    views->attach(chatId, messageId);
+
+    processMessage(chatId, userId, data, from["first_name"].toString(),
+                   from["last_name"].toString(), from["username"].toString());
+}
 
 
 void Bot::processMessage(qint64 chatId, qint64 userId, const QString &text,
                          const QString &firstName, const QString &lastName, const QString &username)
 {
+    // 🚦 Допуск: дешева відмова до будь-якого розбору тексту та запитів до Palantír
+    bool authorized = !Config::current().useAuth || isUserAuthorized(userId);
+    AdmissionController::Verdict verdict = admission.admit(userId, chatId, authorized, palantir->inFlight());
+    if (verdict != AdmissionController::Verdict::Admit) {
+        qDebug() << "🚦 Повідомлення від" << userId << "відхилено:" << AdmissionController::verdictName(verdict);
+        bool limited = verdict == AdmissionController::Verdict::UserLimited
+                       || verdict == AdmissionController::Verdict::ChatLimited
+                       || verdict == AdmissionController::Verdict::Shed;
+        if (limited && admission.shouldNotify(chatId)) {
+            sendMessage(chatId, verdict == AdmissionController::Verdict::Shed
+                                    ? "⏳ Бот зараз перевантажений, спробуйте за хвилину."
+                                    : "⏳ Забагато запитів, зачекайте кілька секунд.");
+        }
+        return;
+    }
+
     // 🔹 Поточний час
     QDateTime now = QDateTime::currentDateTime();
 
@@ -316,6 +799,7 @@ void Bot::processMessage(qint64 chatId, qint64 userId, const QString &text,
             lastSelectedTerminalId = 0;
             waitingForTerminal = false;
             waitingForBroadcastMessage = false;
+            cancelAction(chatId, "бездіяльність");
 
             sendMessage(chatId, "⏳ Ви не працювали з ботом більше 30 хв. Стан скинуто.");
             handleStartCommand(chatId);
@@ -327,23 +811,8 @@ void Bot::processMessage(qint64 chatId, qint64 userId, const QString &text,
     // 🔄 Якщо запису ще не було — вважаємо, що користувач активний
     lastActivity[chatId] = now;
 
-    QString blacklistFilePath = QCoreApplication::applicationDirPath() + "/Config/blacklist.txt";
-
-    QFile blacklistFile(blacklistFilePath);
-    if (blacklistFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&blacklistFile);
-        while (!in.atEnd()) {
-            if (in.readLine().trimmed() == QString::number(userId)) {
-                qDebug() << "❌ Користувач " << userId << " у чорному списку! Ігноруємо повідомлення.";
-                blacklistFile.close();
-                return;
-            }
-        }
-        blacklistFile.close();
-    }
-
-    if (Config::instance().useAuth()) {
-        if (!isUserAuthorized(userId)) {
+    if (Config::current().useAuth) {
+        if (!authorized) {
             qDebug() << "❌ Unauthorized user" << userId << "attempted to use the bot.";
             sendMessage(chatId, "❌ У вас немає доступу до цього бота. Зверніться до адміністратора.");
             requestAdminApproval(userId, chatId, firstName, lastName, username);
@@ -364,9 +833,16 @@ void Bot::processMessage(qint64 chatId, qint64 userId, const QString &text,
     if (cleanText == "🛢 Резервуари") cleanText = "/get_reservoir_info";
     if (cleanText == "⛽ ПРК") cleanText = "/get_prk_info";
     if (cleanText == "📍 Показати на карті") cleanText = "/show_location";
+    if (cleanText == "📊 Дашборд") cleanText = "/dashboard";
 
     qInfo() << "📩 Отримано повідомлення від" << userId << "(Chat ID:" << chatId << "):" << cleanText;
 
+    // 🔹 Нова дія скасовує попередню; та сама кнопка під час дії — ігнорується
+    if (!beginAction(chatId, cleanText)) {
+        qDebug() << "⏭ Повторне натискання" << cleanText << "під час виконання, чат" << chatId;
+        return;
+    }
+
     // 🔹 Очікування номера терміналу
     if (waitingForTerminal) {
         processTerminalInput(chatId, cleanText);
@@ -411,100 +887,225 @@ void Bot::processMessage(qint64 chatId, qint64 userId, const QString &text,
         handlePrkInfo(chatId);
     } else if (cleanText == "/broadcast") {
         handleBroadcastCommand(chatId, userId);
+    } else if (cleanText == "/broadcast_cancel") {
+        handleBroadcastCancel(chatId, userId);
     } else if (cleanText == "/show_location") {
         handleLocationRequest(chatId);
+    } else if (cleanText == "/dashboard") {
+        handleDashboard(chatId);
+    } else if (cleanText == "/subscribe" || cleanText.startsWith("/subscribe ")) {
+        handleSubscribeCommand(chatId, cleanText, true);
+    } else if (cleanText == "/unsubscribe" || cleanText.startsWith("/unsubscribe ")) {
+        handleSubscribeCommand(chatId, cleanText, false);
+    } else if (cleanText == "/subscriptions") {
+        handleSubscriptionsCommand(chatId);
+    } else if (cleanText == "/digest" || cleanText.startsWith("/digest ")) {
+        handleDigestCommand(chatId, userId, cleanText);
+    } else if (cleanText == "/digests") {
+        handleDigestsCommand(chatId);
+    } else if (cleanText == "/stats") {
+        handleStatsCommand(chatId, userId);
+    } else if (cleanText.startsWith("/nearest ")) {
+        handleNearestCommand(chatId, cleanText);
+    } else if (cleanText == "/q" || cleanText.startsWith("/q ")) {
+        handleQueryCommand(chatId, userId, cleanText);
+    } else if (cleanText == "/export" || cleanText.startsWith("/export ")) {
+        handleExportCommand(chatId, cleanText);
     } else {
         sendMessage(chatId, "❌ Невідома команда.");
     }
 }
 
+/**
+ * @brief Починає нову дію чату: скасовує попередню і ставить дедлайн action_deadline_sec
+ * @param action Команда дії (після конвертації кнопок)
+ * @return Токен дії або nullptr, якщо та сама дія ще чекає на Palantír
+ */
+ActionToken::Ptr Bot::beginAction(qint64 chatId, const QString &action) {
+    const ActionToken::Ptr previous = actions.value(chatId);
+    if (previous && !previous->isCancelled() && previous->pending() > 0) {
+        if (previous->action() == action) {
+            ++duplicateTaps;
+            return nullptr;
+        }
+        ++supersededActions;
+    }
+    if (previous) {
+        previous->cancel("нова дія");
+    }
 
-void Bot::handleLocationRequest(qint64 chatId) {
-    qDebug() << "📍 Запит на геолокацію для терміналу" << lastSelectedTerminalId;
+    const ActionToken::Ptr token = ActionToken::create(
+        action, QDeadlineTimer(std::chrono::seconds(Config::current().actionDeadlineSec)));
+    actions.insert(chatId, token);
+    return token;
+}
 
-    QUrl url(QString("http://localhost:8181/terminal_info?client_id=%1&terminal_id=%2")
-                 .arg(lastSelectedClientId)
-                 .arg(lastSelectedTerminalId));
+void Bot::cancelAction(qint64 chatId, const QString &reason) {
+    const ActionToken::Ptr token = actions.take(chatId);
+    if (!token) {
+        return;
+    }
+    if (!token->isCancelled() && token->pending() > 0) {
+        ++supersededActions;
+    }
+    token->cancel(reason);
+}
 
-    QNetworkRequest request(url);
-    QNetworkReply *reply = networkManager->get(request);
+ActionToken::Ptr Bot::currentAction(qint64 chatId) const {
+    return actions.value(chatId);
+}
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply, chatId]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "❌ Помилка при отриманні координат:" << reply->errorString();
-            sendMessage(chatId, "❌ Не вдалося отримати координати.");
-            reply->deleteLater();
+void Bot::handleLocationRequest(qint64 chatId) {
+    qDebug() << "📍 Запит на геолокацію для терміналу" << lastSelectedTerminalId;
+
+    const ActionToken::Ptr token = currentAction(chatId);
+    client->terminal(lastSelectedClientId, lastSelectedTerminalId, token)
+        .then(this, [this, chatId, token](const PalantirClient::TerminalResult &result) {
+        if (token && token->isCancelled()) {
             return;
         }
-
-        QByteArray data = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
-        reply->deleteLater();
-
-        if (!jsonDoc.isObject()) {
-            qWarning() << "❌ Некоректна відповідь сервера.";
-            sendMessage(chatId, "❌ Сталася помилка.");
+        if (!checkPalantirResult(chatId, result, "❌ Не вдалося отримати координати.")) {
             return;
         }
 
-        QJsonObject obj = jsonDoc.object();
-        if (!obj.contains("latitude") || !obj.contains("longitude")) {
+        const Palantir::Terminal &terminal = result.value;
+        if (!terminal.hasCoordinates) {
             sendMessage(chatId, "ℹ️ Відсутні координати для цієї АЗС.");
             return;
         }
 
-        double lat = obj["latitude"].toDouble();
-        double lon = obj["longitude"].toDouble();
-
-        if (lat == 0.0 && lon == 0.0) {
+        if (terminal.latitude == 0.0 && terminal.longitude == 0.0) {
             sendMessage(chatId, "ℹ️ Для цієї АЗС координати не задані.");
             return;
         }
 
-        // ✅ Надсилаємо геопозицію
-        sendLocation(chatId, lat, lon);
+        // 🔹 Карта з назвою та адресою — одним sendVenue
+        if (!result.fromCache) {
+            sendVenue(chatId, terminal.latitude, terminal.longitude,
+                      QString("🏪 %1 · ⛽ Термінал %2").arg(terminal.clientName).arg(terminal.terminalId),
+                      QString("📍 %1 · 📞 %2").arg(terminal.address, terminal.phone));
+            return;
+        }
+
+        // ✅ Дані з кешу: карта і опис з позначкою застарілості
+        sendLocation(chatId, terminal.latitude, terminal.longitude);
 
-        // ✅ Після карти надсилаємо опис
-        QString responseText;
-        responseText += QString("🏪 <b>%1</b> ").arg(obj["client_name"].toString());
-        responseText += QString("⛽ <b>Термінал:</b> %1\n").arg(obj["terminal_id"].toInt());
-        responseText += QString("📍 %1\n").arg(obj["adress"].toString());
-        responseText += QString("📞 <code>%1</code>\n").arg(obj["phone"].toString());
+        QString responseText = staleNote(result);
+        responseText += QString("🏪 <b>%1</b> ").arg(terminal.clientName);
+        responseText += QString("⛽ <b>Термінал:</b> %1\n").arg(terminal.terminalId);
+        responseText += QString("📍 %1\n").arg(terminal.address);
+        responseText += QString("📞 <code>%1</code>\n").arg(terminal.phone);
 
         sendMessage(chatId, responseText);
     });
 }
 
 
-void Bot::sendLocation(qint64 chatId, double latitude, double longitude) {
-    QUrl url(QString("https://api.telegram.org/bot%1/sendLocation").arg(botToken));
+/**
+ * @brief Найближчі до точки АЗС усіх клієнтів з просторового індексу
+ * @param text /nearest <latitude> <longitude> [k] (надходить і з поділеної геопозиції)
+ */
+void Bot::handleNearestCommand(qint64 chatId, const QString &text) {
+    static const int kDefaultNearest = 5;
+    static const int kMaxNearest = 20;
+
+    QStringList parts = text.split(" ", Qt::SkipEmptyParts);
+    bool latOk = false;
+    bool lonOk = false;
+    double latitude = parts.value(1).toDouble(&latOk);
+    double longitude = parts.value(2).toDouble(&lonOk);
+    int k = parts.size() > 3 ? qBound(1, parts[3].toInt(), kMaxNearest) : kDefaultNearest;
+
+    if (!latOk || !lonOk || qAbs(latitude) > 90 || qAbs(longitude) > 180) {
+        sendMessage(chatId, "❌ Формат: /nearest &lt;широта&gt; &lt;довгота&gt; [кількість] або надішліть геопозицію.");
+        return;
+    }
+
+    // 🔹 Дерево перебудовується лише коли обхід парку змінив координати
+    if (stations.revision() != fleetIndex.locationRevision()) {
+        QElapsedTimer buildTimer;
+        buildTimer.start();
+        stations.build(fleetIndex.locations(), fleetIndex.locationRevision());
+        qDebug() << "📍 Просторовий індекс:" << stations.size() << "АЗС за" << buildTimer.nsecsElapsed() / 1000 << "мкс";
+    }
+
+    if (stations.size() == 0) {
+        // 🔹 Обхід парку не запускаємо: його планує FleetWatcher, а не запити користувачів
+        sendMessage(chatId, "ℹ️ Індекс АЗС ще не готовий — координати з'являться після планового обходу терміналів.");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QList<GeoIndex::Hit> hits = stations.nearest(latitude, longitude, k);
+    qInfo() << "📍 Найближчі АЗС до" << latitude << longitude << ":" << hits.size()
+            << "за" << timer.nsecsElapsed() / 1000 << "мкс";
+
+    QString responseText = QString("📍 <b>Найближчі АЗС</b> (%1)\n\n").arg(hits.size());
+    for (const GeoIndex::Hit &hit : hits) {
+        QString clientName = fleetIndex.clientName(hit.station.clientId);
+        responseText += QString("🔹 <b>%1 км</b> — %2, термінал %3\n")
+                            .arg(hit.distanceKm, 0, 'f', hit.distanceKm < 10 ? 1 : 0)
+                            .arg(clientName.isEmpty() ? QString::number(hit.station.clientId) : clientName.toHtmlEscaped())
+                            .arg(hit.station.terminalId);
+        if (!hit.station.address.isEmpty()) {
+            responseText += QString("   %1\n").arg(hit.station.address.toHtmlEscaped());
+        }
+    }
+    if (fleetIndex.syncedAt().isValid()) {
+        responseText += QString("\n<i>Дані обходу станом на %1</i>").arg(fleetIndex.syncedAt().toString("dd.MM HH:mm"));
+    }
+
+    sendMessage(chatId, responseText);
+}
 
+void Bot::sendLocation(qint64 chatId, double latitude, double longitude) {
     QJsonObject payload;
     payload["chat_id"] = chatId;
     payload["latitude"] = latitude;
     payload["longitude"] = longitude;
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    outbound->call(chatId, "sendLocation", payload, [](const TelegramResult &result) {
+        if (result.ok) {
+            qDebug() << "📍 Локацію успішно надіслано.";
+        }
+    });
+}
 
-    QNetworkReply *reply = networkManager->post(request, QJsonDocument(payload).toJson());
+/**
+ * @brief Надсилає точку на карті з назвою та адресою (замість sendLocation + опис)
+ */
+void Bot::sendVenue(qint64 chatId, double latitude, double longitude, const QString &title, const QString &address) {
+    QJsonObject payload;
+    payload["chat_id"] = chatId;
+    payload["latitude"] = latitude;
+    payload["longitude"] = longitude;
+    payload["title"] = title;
+    payload["address"] = address;
 
-    connect(reply, &QNetworkReply::finished, this, [reply]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "❌ Помилка надсилання локації:" << reply->errorString();
-        } else {
-            qDebug() << "📍 Локацію успішно надіслано.";
+    outbound->call(chatId, "sendVenue", payload, [](const TelegramResult &result) {
+        if (result.ok) {
+            qDebug() << "📍 Місце успішно надіслано.";
         }
-        reply->deleteLater();
     });
 }
 
 
 
+/**
+ * @brief Запускає фонову розсилку повідомлення всім користувачам з users.txt
+ * @param chatId Чат адміна (тут показується прогрес)
+ * @param message Текст розсилки
+ */
 void Bot::startBroadcast(qint64 chatId, const QString &message) {
     qDebug() << "📢 Починаємо розсилку повідомлення:" << message;
 
-    QFile file("Config/users.txt");
+    if (broadcastJob->isRunning()) {
+        sendMessage(chatId, "⏳ Попередня розсилка ще триває. Скасувати: /broadcast_cancel");
+        return;
+    }
+
+    QFile file(QCoreApplication::applicationDirPath() + "/Config/users.txt");
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         qWarning() << "❌ Не вдалося відкрити users.txt!";
         sendMessage(chatId, "❌ Помилка: список користувачів недоступний.");
@@ -512,11 +1113,11 @@ void Bot::startBroadcast(qint64 chatId, const QString &message) {
     }
 
     QTextStream in(&file);
-    QStringList userIds;
+    QList<qint64> userIds;
     while (!in.atEnd()) {
         QString line = in.readLine().trimmed();
         if (!line.isEmpty() && line[0].isDigit()) {
-            userIds.append(line.split(" ").first());
+            userIds.append(line.split(" ").first().toLongLong());
         }
     }
     file.close();
@@ -528,54 +1129,349 @@ void Bot::startBroadcast(qint64 chatId, const QString &message) {
 
     qDebug() << "👥 Користувачів для розсилки:" << userIds.size();
 
-    for (int i = 0; i < userIds.size(); ++i) {
-        qint64 userId = userIds[i].toLongLong();
-
-        QUrl url(QString("https://api.telegram.org/bot%1/sendMessage").arg(botToken));
-        QNetworkRequest request(url);
-        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
-        QJsonObject payload;
-        payload["chat_id"] = userId;
-        payload["text"] = "📢 " + message;
-        payload["parse_mode"] = "HTML";  // ✅ Щоб підтримувались перенос рядків
+    broadcastJob->start(chatId, "📢 " + message, userIds);
+}
 
-        QNetworkReply *reply = networkManager->post(request, QJsonDocument(payload).toJson());
 
-        connect(reply, &QNetworkReply::finished, this, [reply]() {
-            if (reply->error() != QNetworkReply::NoError) {
-                qWarning() << "❌ Не вдалося надіслати повідомлення:" << reply->errorString();
-            } else {
-                qDebug() << "✅ Повідомлення надіслано.";
-            }
-            reply->deleteLater();
-        });
+void Bot::handleBroadcastCancel(qint64 chatId, qint64 userId) {
+    if (!isAdmin(userId)) {
+        sendMessage(chatId, "❌ У вас немає прав для використання цієї команди.");
+        return;
+    }
 
-        QThread::msleep(1500);  // ⏱ Пауза між повідомленнями
+    if (!broadcastJob->isRunning()) {
+        sendMessage(chatId, "ℹ️ Немає активної розсилки.");
+        return;
     }
 
-    sendMessage(chatId, "✅ Повідомлення розіслано " + QString::number(userIds.size()) + " користувачам.");
+    broadcastJob->cancel();
 }
 
 
 
-bool Bot::isAdmin(qint64 userId) {
-    QFile file("Config/admins.txt");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "❌ Не вдалося відкрити файл admins.txt!";
-        return false;
+/**
+ * @brief Показує адміну лічильники допуску, стан Palantír і стиснення
+ */
+void Bot::handleStatsCommand(qint64 chatId, qint64 userId) {
+    if (!isAdmin(userId)) {
+        sendMessage(chatId, "❌ У вас немає прав для використання цієї команди.");
+        return;
     }
 
-    QTextStream in(&file);
-    while (!in.atEnd()) {
-        if (in.readLine().trimmed() == QString::number(userId)) {
-            file.close();
-            return true;
+    const AdmissionController::Counters &counters = admission.counters();
+    QString text = "📈 <b>Статистика</b>\n\n";
+    text += "🚦 <b>Допуск повідомлень</b>\n";
+    text += QString("Прийнято: %1\n").arg(counters.admitted);
+    text += QString("Відхилено: %1\n").arg(counters.dropped());
+    text += QString("  чорний список: %1\n").arg(counters.blacklisted);
+    text += QString("  повторні запити доступу: %1\n").arg(counters.approvalThrottled);
+    text += QString("  ліміт користувача: %1\n").arg(counters.userLimited);
+    text += QString("  ліміт чату: %1\n").arg(counters.chatLimited);
+    text += QString("  перевантаження бекенду: %1\n").arg(counters.shed);
+
+    static const char *const kBreakerStates[] = { "закритий", "відкритий", "напіввідкритий" };
+    text += "\n🛰 <b>Palantír</b>\n";
+    text += QString("Запитів у польоті: %1\n").arg(palantir->inFlight());
+    text += QString("Запобіжник: %1\n").arg(kBreakerStates[int(palantir->breakerState())]);
+    text += QString("Hedged-запитів: %1, відхилено запобіжником: %2\n")
+                .arg(palantir->hedgedRequests()).arg(palantir->rejectedRequests());
+    text += QString("Фонові запити: у польоті %1, запобіжник: %2, відхилено: %3\n")
+                .arg(backgroundPalantir->inFlight()).arg(kBreakerStates[int(backgroundPalantir->breakerState())])
+                .arg(backgroundPalantir->rejectedRequests());
+    text += QString("Скасовано запитів: %1 (дій скасовано: %2, повторних натискань: %3), після дедлайну: %4\n")
+                .arg(palantir->cancelledRequests()).arg(supersededActions).arg(duplicateTaps)
+                .arg(palantir->timedOutRequests());
+    text += QString("📦 Пакетів: %1 на %2 запитів, конвеєром: %3\n")
+                .arg(client->batcher()->bulkRequests()).arg(client->batcher()->bulkLookups())
+                .arg(client->batcher()->pipelinedLookups());
+    if (auto *local = qobject_cast<LocalSocketNetworkManager *>(networkManager); local && local->localRequests() > 0) {
+        text += QString("🔌 Через Unix-сокет: %1 запитів, конвеєром %2, з'єднань %3 (відкрито %4)\n")
+                    .arg(local->localRequests()).arg(local->pipelinedRequests())
+                    .arg(local->openConnections()).arg(local->connectionsOpened());
+    }
+
+    const QHash<QString, PalantirGateway::CompressionStats> compression = palantir->compressionStats();
+    for (auto it = compression.cbegin(); it != compression.cend(); ++it) {
+        text += QString("🗜 %1: %2 відповідей, %3 → %4 КБ (%5x)\n")
+                    .arg(it.key())
+                    .arg(it.value().responses)
+                    .arg(it.value().encodedBytes / 1024)
+                    .arg(it.value().decodedBytes / 1024)
+                    .arg(it.value().ratio(), 0, 'f', 2);
+    }
+
+    text += QString("\n🖼 Пропущено незмінених оновлень виду: %1\n").arg(views->skippedUpdates());
+    text += QString("📤 Викликів Telegram з черги: %1, злито повідомлень: %2\n")
+                .arg(outbound->sentCalls()).arg(outbound->mergedMessages());
+    text += QString("📰 Зведень надіслано: %1, запитано даних клієнтів: %2\n")
+                .arg(digests->deliveredDigests()).arg(digests->fetchedClients());
+
+    text += "\n⏱ <b>Цикл подій</b>\n";
+    text += QString("Затримка: p50 %1 мс, p99 %2 мс, макс %3 мс (%4 проб)\n")
+                .arg(loopMonitor->percentileMs(0.50)).arg(loopMonitor->percentileMs(0.99))
+                .arg(loopMonitor->maxLagMs()).arg(loopMonitor->samples());
+    const std::array<quint64, LoopMonitor::kBuckets> histogram = loopMonitor->histogram();
+    for (int bucket = 0; bucket < LoopMonitor::kBuckets; ++bucket) {
+        if (histogram[size_t(bucket)] > 0) {
+            text += QString("  %1: %2\n").arg(LoopMonitor::bucketTitle(bucket)).arg(histogram[size_t(bucket)]);
         }
     }
+    text += QString("Зависань: %1").arg(loopMonitor->stallCount());
+    if (loopMonitor->stallCount() > 0) {
+        const LoopMonitor::Stall stall = loopMonitor->lastStall();
+        text += QString(", останнє: %1 мс у %2 о %3")
+                    .arg(stall.durationMs).arg(stall.activity.toHtmlEscaped(), stall.at.toString("HH:mm:ss"));
+    }
+    text += QString("\nПерезапусків long poll: %1\n").arg(pollRestarts);
+    sendMessage(chatId, text);
+}
 
-    file.close();
-    return false;
+/**
+ * @brief Запити адміна по колонковому індексу парку
+ * @param text /q <колонка> <значення> — термінали з таким значенням ("abc*" — префікс, "!abc" — усі, крім)
+ *             /q top <колонка> — найпоширеніші значення
+ */
+void Bot::handleQueryCommand(qint64 chatId, qint64 userId, const QString &text) {
+    if (!isAdmin(userId)) {
+        sendMessage(chatId, "❌ У вас немає прав для використання цієї команди.");
+        return;
+    }
+
+    static const int kMaxLines = 40;
+    QStringList parts = text.split(" ", Qt::SkipEmptyParts);
+
+    if (parts.size() < 3) {
+        QString help = "🔎 <b>Запити по парку</b>\n"
+                       "/q &lt;колонка&gt; &lt;значення&gt; — де зустрічається значення\n"
+                       "   <code>2.1*</code> — префікс, <code>!2.1.3</code> — усі, крім\n"
+                       "/q top &lt;колонка&gt; — найпоширеніші значення\n\n"
+                       "Колонки:\n";
+        for (const QString &name : FleetIndex::columnNames()) {
+            FleetIndex::Column column;
+            FleetIndex::columnFromName(name, &column);
+            help += QString("• <code>%1</code> — %2 (%3 рядків)\n")
+                        .arg(name, FleetIndex::columnTitle(column)).arg(fleetIndex.rowCount(column));
+        }
+        help += QString("\nТерміналів в індексі: %1").arg(fleetIndex.terminalCount());
+        if (fleetIndex.syncedAt().isValid()) {
+            help += QString(", обхід завершено %1").arg(fleetIndex.syncedAt().toString("dd.MM HH:mm"));
+        }
+        sendMessage(chatId, help);
+        return;
+    }
+
+    if (fleetIndex.terminalCount() == 0) {
+        sendMessage(chatId, "ℹ️ Індекс парку ще порожній — дочекайтесь завершення обходу терміналів.");
+        if (!fleetWatcher->isSweeping()) {
+            fleetWatcher->sweep();
+        }
+        return;
+    }
+
+    FleetIndex::Column column;
+
+    // 🔹 /q top <колонка>
+    if (parts[1] == "top") {
+        if (!FleetIndex::columnFromName(parts[2], &column)) {
+            sendMessage(chatId, "❌ Невідома колонка. Список: /q");
+            return;
+        }
+        const QList<QPair<QString, int>> histogram = fleetIndex.histogram(column);
+        QString responseText = QString("🔎 <b>%1</b> — %2 значень\n\n").arg(FleetIndex::columnTitle(column)).arg(histogram.size());
+        for (int i = 0; i < histogram.size() && i < kMaxLines; ++i) {
+            QString value = histogram[i].first.isEmpty() ? "(порожньо)" : histogram[i].first.toHtmlEscaped();
+            responseText += QString("%1 — %2\n").arg(value).arg(histogram[i].second);
+        }
+        sendMessage(chatId, responseText);
+        return;
+    }
+
+    if (!FleetIndex::columnFromName(parts[1], &column)) {
+        sendMessage(chatId, "❌ Невідома колонка. Список: /q");
+        return;
+    }
+
+    QString pattern = parts.mid(2).join(" ");
+    FleetIndex::Selection selection = fleetIndex.select(column, pattern, kMaxLines);
+    qInfo() << "🔎 /q" << parts[1] << pattern << "→" << selection.rows << "рядків за" << selection.elapsedUs << "мкс";
+
+    QString responseText = QString("🔎 <b>%1</b> = <code>%2</code>\n")
+                               .arg(FleetIndex::columnTitle(column), pattern.toHtmlEscaped());
+    responseText += QString("Знайдено: %1 у %2 терміналах (%3 мкс)\n\n")
+                        .arg(selection.rows).arg(selection.terminals).arg(selection.elapsedUs);
+
+    for (const FleetIndex::Match &match : selection.matches) {
+        QString clientName = fleetIndex.clientName(match.clientId);
+        responseText += QString("• %1 (%2), термінал %3 — %4: %5\n")
+                            .arg(clientName.isEmpty() ? QString::number(match.clientId) : clientName.toHtmlEscaped())
+                            .arg(match.clientId)
+                            .arg(match.terminalId)
+                            .arg(match.detail, match.value.toHtmlEscaped());
+    }
+    if (selection.rows > selection.matches.size()) {
+        responseText += QString("… і ще %1\n").arg(selection.rows - selection.matches.size());
+    }
+
+    sendMessage(chatId, responseText);
+}
+
+/**
+ * @brief Експорт таблицею у файл — один sendDocument замість десятків повідомлень
+ * @param text /export azs [csv|xlsx] — АЗС обраного клієнта; /export prk [csv|xlsx] — ПРК обраного терміналу
+ */
+void Bot::handleExportCommand(qint64 chatId, const QString &text) {
+    const QStringList args = text.split(' ', Qt::SkipEmptyParts);
+    const QString what = args.value(1);
+    TableExport::Format format = TableExport::Format::Xlsx;
+
+    if ((what != "azs" && what != "prk") || args.size() > 3
+        || (args.size() == 3 && !TableExport::formatFromName(args[2], &format))) {
+        sendMessage(chatId, "❌ Формат: /export azs|prk [csv|xlsx]");
+        return;
+    }
+
+    if (lastSelectedClientId == 0) {
+        sendMessage(chatId, "❌ Спочатку оберіть клієнта (/clients).");
+        return;
+    }
+
+    if (what == "azs") {
+        exportAzsList(chatId, format);
+    } else {
+        exportPrk(chatId, format);
+    }
+}
+
+/**
+ * @brief Список АЗС клієнта у файл: рядки пишуться на диск у міру надходження потоку
+ */
+void Bot::exportAzsList(qint64 chatId, TableExport::Format format) {
+    const qint64 clientId = lastSelectedClientId;
+
+    struct AzsExport {
+        std::unique_ptr<TableExport> table;
+        std::unique_ptr<JsonArrayStream> parser;
+    };
+    auto state = std::make_shared<AzsExport>();
+    state->table = std::make_unique<TableExport>(format, "АЗС");
+    if (!state->table->open({ "Термінал", "Назва" })) {
+        qWarning() << "❌ Не вдалося створити файл експорту:" << state->table->errorString();
+        sendMessage(chatId, "❌ Не вдалося сформувати файл.");
+        return;
+    }
+
+    TableExport *table = state->table.get();  // Належить state — без циклу shared_ptr
+    const JsonArrayStream::ElementCallback onElement = [table](const QJsonValue &value) {
+        const QJsonObject azs = value.toObject();
+        table->addRow({ azs["terminal_id"].toInt(), azs["name"].toString() });
+    };
+    state->parser = std::make_unique<JsonArrayStream>("azs_list", onElement);
+
+    QUrlQuery query;
+    query.addQueryItem("client_id", QString::number(clientId));
+    const ActionToken::Ptr token = currentAction(chatId);
+
+    palantir->getStream("azs_list", query, [state](const QByteArray &chunk) {
+        state->parser->feed(chunk);
+    }, [this, chatId, clientId, state, token, onElement](const PalantirResponse &response) {
+        if (response.cancelled || (token && token->isCancelled())) {
+            return;   // Користувач перейшов до іншої дії — файл нікому не потрібен
+        }
+
+        // 🔹 Обрив посеред потоку: неповний файл не надсилаємо
+        if (state->parser->elementCount() > 0 && (!response.ok || response.fromCache)) {
+            qWarning() << "❌ Потік azs_list для експорту обірвано:" << response.errorString;
+            sendMessage(chatId, "⚠️ Експорт перервано: з'єднання з Palantír обірвалося.");
+            return;
+        }
+
+        if (!checkPalantirResponse(chatId, response, "❌ Не вдалося отримати список АЗС.")) {
+            return;
+        }
+
+        // 🔹 Потік міг обірватися всередині масиву ще до першого елемента — кеш розбирає новий парсер
+        if (response.fromCache) {
+            state->parser = std::make_unique<JsonArrayStream>("azs_list", onElement);
+            state->parser->feed(response.body);
+        }
+
+        if (!state->parser->finish() || state->parser->envelope().contains("error")) {
+            qWarning() << "❌ Некоректна відповідь azs_list:" << state->parser->errorString();
+            sendMessage(chatId, "❌ Сталася помилка при обробці відповіді сервера.");
+            return;
+        }
+
+        if (state->parser->elementCount() == 0) {
+            sendMessage(chatId, "ℹ️ Немає доступних АЗС для цього клієнта.");
+            return;
+        }
+
+        sendExport(chatId, *state->table, QString("azs_%1").arg(clientId),
+                   staleNote(response) + QString("📋 Список АЗС: %1").arg(state->table->rowCount()));
+    }, token);
+}
+
+/**
+ * @brief ПРК обраного терміналу у файл: рядок на кожен пістолет
+ */
+void Bot::exportPrk(qint64 chatId, TableExport::Format format) {
+    if (lastSelectedTerminalId == 0) {
+        sendMessage(chatId, "ℹ️ Спочатку оберіть клієнта та термінал.");
+        return;
+    }
+
+    const qint64 terminalId = lastSelectedTerminalId;
+    const ActionToken::Ptr token = currentAction(chatId);
+
+    client->terminal(lastSelectedClientId, terminalId, token)
+        .then(this, [this, chatId, terminalId, format, token](const PalantirClient::TerminalResult &result) {
+        if (token && token->isCancelled()) {
+            return;
+        }
+        if (!checkPalantirResult(chatId, result, "❌ Не вдалося отримати інформацію про ПРК.")) {
+            return;
+        }
+
+        TableExport table(format, QString("ПРК АЗС %1").arg(terminalId));
+        if (!table.open({ "ПРК", "Протокол", "Порт", "Швидкість", "Адреса", "Пістолет", "Резервуар", "Пальне" })) {
+            qWarning() << "❌ Не вдалося створити файл експорту:" << table.errorString();
+            sendMessage(chatId, "❌ Не вдалося сформувати файл.");
+            return;
+        }
+
+        for (const Palantir::Dispenser &dispenser : result.value.dispensers) {
+            for (const Palantir::Pump &pump : dispenser.pumps) {
+                table.addRow({ dispenser.dispenserId, dispenser.protocol, dispenser.port, dispenser.speed,
+                               dispenser.address, pump.pumpId, pump.tankId, pump.fuelShortName });
+            }
+        }
+
+        if (table.rowCount() == 0) {
+            sendMessage(chatId, "ℹ️ Немає даних про ПРК для цього терміналу.");
+            return;
+        }
+
+        sendExport(chatId, table, QString("prk_%1").arg(terminalId),
+                   staleNote(result) + QString("⛽ ПРК терміналу %1").arg(terminalId));
+    });
+}
+
+/**
+ * @brief Завершує файл експорту і надсилає його документом прямо з диска
+ */
+void Bot::sendExport(qint64 chatId, TableExport &table, const QString &baseName, const QString &caption) {
+    if (!table.finish()) {
+        qWarning() << "❌ Не вдалося записати файл експорту:" << table.errorString();
+        sendMessage(chatId, "❌ Не вдалося сформувати файл.");
+        return;
+    }
+
+    qInfo() << "📥 Експорт" << table.fileName(baseName) << ":" << table.rowCount() << "рядків," << table.size() << "байт";
+    sendDocument(chatId, table.fileName(baseName), table.takeDevice(), table.mimeType(), caption);
+}
+
+bool Bot::isAdmin(qint64 userId) {
+    return acl.isAdmin(userId);
 }
 
 
@@ -602,121 +1498,168 @@ void Bot::processClientSelection(qint64 chatId, const QString &clientName) {
     // sendMessage(chatId, "🏪 Мережа АЗС - " + clientName + ".\nВкажіть номер терміналу:");
     // waitingForTerminal = true;
     qint64 clientId = clientIdMap[clientName];
+    if (clientId != lastSelectedClientId) {
+        lastSelectedTerminalId = 0;   // Термінал попереднього клієнта тут не дійсний
+    }
     lastSelectedClientId = clientId;
 
     qInfo() << "✅ Користувач вибрав клієнта:" << clientName << "(ID:" << clientId << ")";
 
-    sendMessage(chatId, "📌 Ви вибрали клієнта: " + clientName + ".\nОберіть дію:", true);
-
-    // Відправляємо три кнопки
-    QJsonObject keyboard;
-    QJsonArray keyboardArray;
+    // 🔹 Один вид з inline-кнопками замість двох повідомлень
+    views->show(chatId, "📌 Ви вибрали клієнта: " + clientName + ".\nОберіть дію:", clientMenuMarkup());
+}
 
+/**
+ * @brief Inline-клавіатура меню клієнта
+ */
+QJsonObject Bot::clientMenuMarkup() {
     QJsonArray row1;
-    row1.append("🏪 Оберіть термінал");
-    row1.append("📋 Список АЗС");
+    row1.append(QJsonObject{{"text", "🏪 Оберіть термінал"}, {"callback_data", "/get_terminal_id"}});
+    row1.append(QJsonObject{{"text", "📋 Список АЗС"}, {"callback_data", "/get_azs_list"}});
 
     QJsonArray row2;
-    row2.append("🔙 Головне меню");  // Використовуємо вже існуючу логіку
+    row2.append(QJsonObject{{"text", "📥 Експорт АЗС (XLSX)"}, {"callback_data", "/export azs xlsx"}});
+    row2.append(QJsonObject{{"text", "🔙 Головне меню"}, {"callback_data", "/start"}});
 
+    QJsonArray keyboardArray;
     keyboardArray.append(row1);
     keyboardArray.append(row2);
 
-    keyboard["keyboard"] = keyboardArray;
-    keyboard["resize_keyboard"] = true;
-    keyboard["one_time_keyboard"] = false;
+    return QJsonObject{{"inline_keyboard", keyboardArray}};
+}
 
-    QJsonObject payload;
-    payload["chat_id"] = chatId;
-    payload["text"] = "Оберіть дію:";
-    payload["reply_markup"] = keyboard;
+/**
+ * @brief Inline-клавіатура меню терміналу
+ */
+QJsonObject Bot::terminalMenuMarkup() {
+    QJsonArray row1;
+    row1.append(QJsonObject{{"text", "💳 РРО"}, {"callback_data", "/get_rro_info"}});
+    row1.append(QJsonObject{{"text", "🛢 Резервуари"}, {"callback_data", "/get_reservoir_info"}});
+    row1.append(QJsonObject{{"text", "⛽ ПРК"}, {"callback_data", "/get_prk_info"}});
 
-    sendMessageWithKeyboard(payload);
+    QJsonArray row2;
+    row2.append(QJsonObject{{"text", "📍 Показати на карті"}, {"callback_data", "/show_location"}});
+    row2.append(QJsonObject{{"text", "📊 Дашборд"}, {"callback_data", "/dashboard"}});
+    row2.append(QJsonObject{{"text", "🔙 Головне меню"}, {"callback_data", "/start"}});
+
+    QJsonArray row3;
+    row3.append(QJsonObject{{"text", "📥 ПРК (XLSX)"}, {"callback_data", "/export prk xlsx"}});
+    row3.append(QJsonObject{{"text", "📥 ПРК (CSV)"}, {"callback_data", "/export prk csv"}});
+
+    QJsonArray keyboardArray;
+    keyboardArray.append(row1);
+    keyboardArray.append(row2);
+    keyboardArray.append(row3);
+
+    return QJsonObject{{"inline_keyboard", keyboardArray}};
 }
+
 void Bot::handleTerminalSelection(qint64 chatId) {
-    sendMessage(chatId, "🏪 Ви обрали термінал. Введіть номер терміналу:");
+    sendMessage(chatId, "🏪 Ви обрали термінал. Введіть номер терміналу (або кілька: 101, 105, 120-135):");
     waitingForTerminal = true;  // ✅ Тепер бот чекає введення номера терміналу
 }
 
 void Bot::handleAzsList(qint64 chatId) {
     qDebug() << "✅ Виконано handleAzsList() для чату" << chatId;
 
-    QUrl url(QString("http://localhost:8181/azs_list?client_id=%1").arg(lastSelectedClientId));
-
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    QUrlQuery query;
+    query.addQueryItem("client_id", QString::number(lastSelectedClientId));
+
+    // 🔹 Список розбирається поелементно в міру надходження: перша частина йде
+    //    користувачу, поки решта ще завантажується; у пам'яті — лише одна частина
+    struct AzsListStream {
+        QString prefix;
+        QString text;
+        int parts = 0;
+        QElapsedTimer sinceFirstPart;
+        std::unique_ptr<JsonArrayStream> parser;
+    };
+    auto state = std::make_shared<AzsListStream>();
+    AzsListStream *stream = state.get();  // Парсер належить state — без циклу shared_ptr
+    const int messageLimit = Config::current().messageLimit;
+    const ActionToken::Ptr token = currentAction(chatId);
+
+    // 🔹 Надсилає накопичену частину з інтервалом 700 мс між частинами
+    auto flush = [this, chatId, stream, token]() {
+        if (stream->text.isEmpty()) {
+            return;
+        }
+        if (stream->parts == 0) {
+            stream->sinceFirstPart.start();
+        }
+        qint64 delay = qMax<qint64>(0, qint64(stream->parts) * 700 - stream->sinceFirstPart.elapsed());
+        QString part = stream->text;
+        stream->text.clear();
+        ++stream->parts;
+        QTimer::singleShot(delay, this, [this, chatId, part, token]() {
+            if (token && token->isCancelled()) {
+                return;   // Користувач перейшов до іншої дії — решту списку не надсилаємо
+            }
+            sendMessage(chatId, part);
+        });
+    };
+
+    const JsonArrayStream::ElementCallback onElement = [stream, flush, messageLimit](const QJsonValue &value) {
+        QString line = Renderers::azsListLine(value.toObject());
+        if (stream->text.isEmpty()) {
+            stream->text = stream->parts == 0 ? stream->prefix + Renderers::azsListHeader(false) : Renderers::azsListHeader(true);
+        } else if (stream->text.size() + line.size() > messageLimit) {
+            flush();
+            stream->text = Renderers::azsListHeader(true);
+        }
+        stream->text += line;
+    };
+    state->parser = std::make_unique<JsonArrayStream>("azs_list", onElement);
+
+    palantir->getStream("azs_list", query, [state](const QByteArray &chunk) {
+        state->parser->feed(chunk);
+    }, [this, chatId, state, flush, token, onElement](const PalantirResponse &response) {
+        if (response.cancelled || (token && token->isCancelled())) {
+            return;
+        }
 
-    QNetworkReply *reply = networkManager->get(request);
+        // 🔹 Обрив після частини списку: кеш не змішуємо з уже надісланим
+        if (state->parser->elementCount() > 0 && (!response.ok || response.fromCache)) {
+            flush();
+            qWarning() << "❌ Потік azs_list обірвано:" << response.errorString;
+            sendMessage(chatId, response.timedOut ? "⚠️ Список АЗС неповний: Palantír не встиг передати його вчасно."
+                                                  : "⚠️ Список АЗС неповний: з'єднання з Palantír перервано.");
+            return;
+        }
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply, chatId]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "❌ Помилка отримання списку АЗС:" << reply->errorString();
-            sendMessage(chatId, "❌ Не вдалося отримати список АЗС.");
-            reply->deleteLater();
+        if (!checkPalantirResponse(chatId, response, "❌ Не вдалося отримати список АЗС.")) {
             return;
         }
 
-        QByteArray responseData = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
-        reply->deleteLater();
+        // 🔹 Потік міг обірватися всередині масиву ще до першого елемента — кеш розбирає новий парсер
+        if (response.fromCache) {
+            state->prefix = staleNote(response);
+            state->parser = std::make_unique<JsonArrayStream>("azs_list", onElement);
+            state->parser->feed(response.body);
+        }
 
-        if (!jsonDoc.isObject()) {
-            qWarning() << "❌ Отримано некоректний JSON!";
+        if (!state->parser->finish()) {
+            qWarning() << "❌ Отримано некоректний JSON!" << state->parser->errorString();
+            flush();
             sendMessage(chatId, "❌ Сталася помилка при обробці відповіді сервера.");
             return;
         }
 
-        QJsonObject jsonObj = jsonDoc.object();
-
-        if (jsonObj.contains("error")) {
-            QString errorMessage = jsonObj["error"].toString();
+        QJsonObject envelope = state->parser->envelope();
+        if (envelope.contains("error")) {
+            QString errorMessage = envelope["error"].toString();
             qWarning() << "❌ Сервер повернув помилку:" << errorMessage;
             sendMessage(chatId, "❌ " + errorMessage);
             return;
         }
 
-        QJsonArray azsList = jsonObj["azs_list"].toArray();
-
-        if (azsList.isEmpty()) {
+        if (state->parser->elementCount() == 0) {
             sendMessage(chatId, "ℹ️ Немає доступних АЗС для цього клієнта.");
             return;
         }
 
-        // 🔹 Формуємо список повідомлень
-        QStringList parts;
-        QString responseText = "⛽ <b>Список АЗС</b>\n";
-        int messageLimit = 3500;
-        int currentLength = responseText.size();
-
-        for (const QJsonValue &val : azsList) {
-            QJsonObject obj = val.toObject();
-            QString line = QString("🔹 %1 - %2\n")
-                               .arg(obj["terminal_id"].toInt())
-                               .arg(obj["name"].toString());
-
-            if (currentLength + line.size() > messageLimit) {
-                parts.append(responseText);
-                responseText = "⛽ <b>Список АЗС (продовження)</b>\n";
-                currentLength = responseText.size();
-            }
-
-            responseText += line;
-            currentLength += line.size();
-        }
-
-        if (!responseText.isEmpty()) {
-            parts.append(responseText);
-        }
-
-        // 🔹 Надсилаємо всі частини з затримкою
-        int delay = 0;
-        for (const QString &part : parts) {
-            QTimer::singleShot(delay, this, [this, chatId, part]() {
-                sendMessage(chatId, part);
-            });
-            delay += 700;  // ⏱ 700 мс затримка між повідомленнями
-        }
-    });
+        flush();
+    }, token);
 }
 
 
@@ -724,70 +1667,26 @@ void Bot::handleAzsList(qint64 chatId) {
 void Bot::handleReservoirInfo(qint64 chatId) {
     qDebug() << "✅ Виконано handleReservoirsInfo() для чату" << chatId;
 
-    QUrl url(QString("http://localhost:8181/reservoirs_info?client_id=%1&terminal_id=%2")
-                 .arg(lastSelectedClientId)
-                 .arg(lastSelectedTerminalId));
-
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
-    QNetworkReply *reply = networkManager->get(request);
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply, chatId]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "❌ Помилка отримання даних про резервуари:" << reply->errorString();
-            sendMessage(chatId, "❌ Не вдалося отримати інформацію про резервуари.");
-            reply->deleteLater();
-            return;
-        }
-
-        QByteArray responseData = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
-        reply->deleteLater();
-
-        if (!jsonDoc.isObject()) {
-            qWarning() << "❌ Отримано некоректний JSON!";
-            sendMessage(chatId, "❌ Сталася помилка при обробці відповіді сервера.");
+    const ActionToken::Ptr token = currentAction(chatId);
+    client->reservoirs(lastSelectedClientId, lastSelectedTerminalId, token)
+        .then(this, [this, chatId, token](const PalantirClient::ReservoirsResult &result) {
+        if (token && token->isCancelled()) {
             return;
         }
-
-        QJsonObject jsonObj = jsonDoc.object();
-
-        // 🔹 Перевіряємо, чи є помилка у відповіді
-        if (jsonObj.contains("error")) {
-            QString errorMessage = jsonObj["error"].toString();
-            qWarning() << "❌ Сервер повернув помилку:" << errorMessage;
-            sendMessage(chatId, "❌ " + errorMessage);
+        if (!checkPalantirResult(chatId, result, "❌ Не вдалося отримати інформацію про резервуари.")) {
             return;
         }
 
-        QJsonArray reservoirs = jsonObj["reservoirs_info"].toArray();
-
-        if (reservoirs.isEmpty()) {
+        if (result.value.isEmpty()) {
             sendMessage(chatId, "ℹ️ Немає доступних резервуарів для цього терміналу.");
             return;
         }
 
         // ✅ Формуємо повідомлення
-        QString responseText = "🛢 <b>Інформація про резервуари</b>\n";
-        for (const QJsonValue &val : reservoirs) {
-            QJsonObject obj = val.toObject();
-            responseText += QString("🔹 <b>Резервуар %1</b> – %2, %3:\n")
-                                .arg(obj["tank_id"].toInt())
-                                .arg(obj["name"].toString())
-                                .arg(obj["shortname"].toString());
-            responseText += QString("   🔽 <b>Min:</b> %1  |  🔼 <b>Max:</b> %2\n")
-                                .arg(obj["minvalue"].toInt())
-                                .arg(obj["maxvalue"].toInt());
-            responseText += QString("   📏 <b>Рівномір:</b> %1 - %2\n")
-                                .arg(obj["deadmin"].toInt())
-                                .arg(obj["deadmax"].toInt());
-            responseText += QString("   🏭 <b>Трубопровід:</b> %1\n\n")
-                                .arg(obj["tubeamount"].toInt());
-        }
+        QString responseText = staleNote(result) + Renderers::reservoirs(result.value);
 
         qDebug() << "📩 Відправляється повідомлення:\n" << responseText;
-        sendMessage(chatId, responseText);
+        views->show(chatId, responseText, terminalMenuMarkup());
     });
 }
 
@@ -796,81 +1695,19 @@ void Bot::handleReservoirInfo(qint64 chatId) {
 void Bot::handlePrkInfo(qint64 chatId) {
     qDebug() << "✅ Виконано handlePrkInfo() для чату" << chatId;
 
-    QUrl url(QString("http://localhost:8181/terminal_info?client_id=%1&terminal_id=%2")
-                 .arg(lastSelectedClientId).arg(lastSelectedTerminalId));
-
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
-    QNetworkReply *reply = networkManager->get(request);
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply, chatId]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "❌ Помилка отримання даних про ПРК:" << reply->errorString();
-            sendMessage(chatId, "❌ Не вдалося отримати інформацію про ПРК.");
-            reply->deleteLater();
-            return;
-        }
-
-        QByteArray responseData = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
-        reply->deleteLater();
-
-        if (!jsonDoc.isObject()) {
-            qWarning() << "❌ Отримано некоректний JSON!";
-            sendMessage(chatId, "❌ Сталася помилка при обробці відповіді сервера.");
+    const ActionToken::Ptr token = currentAction(chatId);
+    client->terminal(lastSelectedClientId, lastSelectedTerminalId, token)
+        .then(this, [this, chatId, token](const PalantirClient::TerminalResult &result) {
+        if (token && token->isCancelled()) {
             return;
         }
-
-        QJsonObject jsonObj = jsonDoc.object();
-
-        // 🔹 Перевіряємо, чи є помилка у відповіді
-        if (jsonObj.contains("error")) {
-            QString errorMessage = jsonObj["error"].toString();
-            qWarning() << "❌ Сервер повернув помилку:" << errorMessage;
-            sendMessage(chatId, "❌ " + errorMessage);
+        if (!checkPalantirResult(chatId, result, "❌ Не вдалося отримати інформацію про ПРК.")) {
             return;
         }
 
-        // ✅ Отримуємо `dispensers_info`
-        QJsonArray dispensers = jsonObj["dispensers_info"].toArray();
-        QString responseText = "<b>Конфігурація ПРК</b>\n";
-
-        if (dispensers.isEmpty()) {
-            responseText += "ℹ️ Дані про ПРК відсутні.";
-        } else {
-            for (const QJsonValue &dispenserVal : dispensers) {
-                QJsonObject dispenserObj = dispenserVal.toObject();
-                int dispenserId = dispenserObj["dispenser_id"].toInt();
-                QString protocol = dispenserObj["protocol"].toString();
-                int port = dispenserObj["port"].toInt();
-                int speed = dispenserObj["speed"].toInt();
-                int address = dispenserObj["address"].toInt();
-
-                responseText += QString("🔹 <b>ПРК %1:</b> %2, порт %3, швидкість %4, адреса %5\n")
-                                    .arg(dispenserId).arg(protocol).arg(port).arg(speed).arg(address);
-
-                if (dispenserObj.contains("pumps_info")) {
-                    QJsonArray pumps = dispenserObj["pumps_info"].toArray();
-                    for (int i = 0; i < pumps.size(); ++i) {
-                        QJsonObject pumpObj = pumps[i].toObject();
-                        int pumpId = pumpObj["pump_id"].toInt();
-                        int tankId = pumpObj["tank_id"].toInt();
-                        QString fuel = pumpObj["fuel_shortname"].toString();
-
-                        if (i == pumps.size() - 1) {
-                            responseText += QString("  └ 🛠 Пістолет %1 (резервуар %2) – %3\n")
-                                                .arg(pumpId).arg(tankId).arg(fuel);
-                        } else {
-                            responseText += QString("  ├ 🛠 Пістолет %1 (резервуар %2) – %3\n")
-                                                .arg(pumpId).arg(tankId).arg(fuel);
-                        }
-                    }
-                }
-            }
-        }
+        QString responseText = staleNote(result) + Renderers::prk(result.value.dispensers);
 
-        sendMessage(chatId, responseText);
+        views->show(chatId, responseText, terminalMenuMarkup());
     });
 }
 
@@ -941,79 +1778,31 @@ void Bot::handlePrkInfo(qint64 chatId) {
 void Bot::handleRroInfo(qint64 chatId) {
     qDebug() << "✅ Виконано handleRroInfo() для чату" << chatId;
 
-    QUrl url(QString("http://localhost:8181/posdatas?client_id=%1&terminal_id=%2")
-                 .arg(lastSelectedClientId).arg(lastSelectedTerminalId));
-
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
-    QNetworkReply *reply = networkManager->get(request);
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply, chatId]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "❌ Помилка отримання даних про РРО:" << reply->errorString();
-            sendMessage(chatId, "❌ Не вдалося отримати інформацію про РРО.");
-            reply->deleteLater();
-            return;
-        }
-
-        QByteArray responseData = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
-        reply->deleteLater();
-
-        if (!jsonDoc.isObject()) {
-            qWarning() << "❌ Отримано некоректний JSON!";
-            sendMessage(chatId, "❌ Сталася помилка при обробці відповіді сервера.");
+    const ActionToken::Ptr token = currentAction(chatId);
+    client->posdatas(lastSelectedClientId, lastSelectedTerminalId, token)
+        .then(this, [this, chatId, token](const PalantirClient::PosDatasResult &result) {
+        if (token && token->isCancelled()) {
             return;
         }
-
-        QJsonObject jsonObj = jsonDoc.object();
-
-        if (jsonObj.contains("error")) {
-            QString errorMessage = jsonObj["error"].toString();
-            qWarning() << "❌ Сервер повернув помилку:" << errorMessage;
-            sendMessage(chatId, "❌ " + errorMessage);
+        if (!checkPalantirResult(chatId, result, "❌ Не вдалося отримати інформацію про РРО.")) {
             return;
         }
 
-        QJsonArray posdatas = jsonObj["posdatas"].toArray();
-
-        if (posdatas.isEmpty()) {
+        if (result.value.isEmpty()) {
             sendMessage(chatId, "ℹ️ Немає інформації про каси для цього терміналу.");
             return;
         }
 
         // ✅ Формуємо повідомлення
-        QString responseText = "<b>💳 Інформація про каси</b>\n\n";
-        for (const QJsonValue &val : posdatas) {
-            QJsonObject obj = val.toObject();
-            responseText += QString("🧾 Каса №%1\n").arg(obj["pos_id"].toInt());
-            responseText += QString("• Виробник: %1\n").arg(obj["manufacturer"].toString());
-            responseText += QString("• Модель: %1\n").arg(obj["model"].toString());
-            responseText += QString("• Версія ПО РРО: %1\n").arg(obj["posversion"].toString());
-            responseText += QString("• Версія ПО МУК: %1\n").arg(obj["mukversion"].toString());
-            responseText += QString("• ЗН: %1\n").arg(obj["factorynumber"].toString());
-            responseText += QString("• ФН: %1\n").arg(obj["regnumber"].toString());
-            QString rawDate = obj["datreg"].toString();
-            QString dateOnly;
-            if (!rawDate.isEmpty()) {
-                QDateTime dt = QDateTime::fromString(rawDate, Qt::ISODate);
-                if (dt.isValid()) {
-                    dateOnly = dt.date().toString("yyyy-MM-dd");
-                } else {
-                    dateOnly = rawDate; // fallback, якщо не розпізналось
-                }
-            }
-            responseText += QString("• Дата реєстрації: %1\n\n").arg(dateOnly);
-
-        }
+        QString responseText = staleNote(result) + Renderers::rro(result.value);
 
-        sendMessage(chatId, responseText);
+        views->show(chatId, responseText, terminalMenuMarkup());
     });
 }
 
 
 
+
 /**
  * @brief Обробляє введений номер терміналу
  * @param chatId ID чату користувача
@@ -1031,8 +1820,195 @@ void Bot::processTerminalInput(qint64 chatId, const QString &cleanText) {
 
         // 🔹 Виконуємо запит у Palantír
         fetchTerminalInfo(chatId, lastSelectedClientId, lastSelectedTerminalId);
-    } else {
-        sendMessage(chatId, "❌ Будь ласка, введіть **числовий номер терміналу**.");
+        return;
+    }
+
+    // 🔹 Кілька номерів: "101, 105, 120-135"
+    QList<int> terminalIds;
+    QString error;
+    if (!parseTerminalList(cleanText, Config::current().lookupMaxTerminals, &terminalIds, &error)) {
+        sendMessage(chatId, "❌ " + error);
+        return;
+    }
+
+    waitingForTerminal = false;
+    if (terminalIds.size() == 1) {
+        lastSelectedTerminalId = terminalIds.first();
+        fetchTerminalInfo(chatId, lastSelectedClientId, lastSelectedTerminalId);
+        return;
+    }
+
+    handleTerminalBatch(chatId, terminalIds);
+}
+
+/**
+ * @brief Розбирає список номерів терміналів з діапазонами
+ * @param text Номери через кому або пробіл, діапазони через дефіс: "101, 105, 120-135"
+ * @param limit Найбільша кількість терміналів
+ * @return false і текст помилки в error, якщо список некоректний або задовгий
+ */
+bool Bot::parseTerminalList(const QString &text, int limit, QList<int> *terminalIds, QString *error) {
+    static const QRegularExpression separators("[,;\\s]+");
+    static const QRegularExpression range("^(\\d+)\\s*[-–]\\s*(\\d+)$");
+
+    // Пробіли навколо дефіса не повинні розривати діапазон
+    QString normalized = text;
+    normalized.replace(QRegularExpression("\\s*([-–])\\s*"), "\\1");
+
+    QSet<int> seen;
+    const QStringList tokens = normalized.split(separators, Qt::SkipEmptyParts);
+    for (const QString &token : tokens) {
+        int first = 0;
+        int last = 0;
+        bool ok = false;
+
+        const QRegularExpressionMatch match = range.match(token);
+        if (match.hasMatch()) {
+            first = match.captured(1).toInt(&ok);
+            last = ok ? match.captured(2).toInt(&ok) : 0;
+        } else {
+            first = last = token.toInt(&ok);
+        }
+
+        if (!ok || first <= 0 || last < first) {
+            *error = QString("Будь ласка, введіть <b>номер терміналу</b> або список, наприклад: 101, 105, 120-135. "
+                             "Незрозуміло: «%1».").arg(token.toHtmlEscaped());
+            return false;
+        }
+        if (qint64(last) - first + 1 > limit) {
+            *error = QString("Забагато терміналів: не більше %1 за раз.").arg(limit);
+            return false;
+        }
+
+        for (int id = first; id <= last; ++id) {
+            if (!seen.contains(id)) {
+                seen.insert(id);
+                terminalIds->append(id);
+            }
+        }
+        if (terminalIds->size() > limit) {
+            *error = QString("Забагато терміналів: не більше %1 за раз.").arg(limit);
+            return false;
+        }
+    }
+
+    if (terminalIds->isEmpty()) {
+        *error = "Будь ласка, введіть <b>числовий номер терміналу</b>.";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Текст помилки для розділу дашборду або терміналу пакета, що не отримав даних
+ */
+static QString dashboardError(const PalantirOutcome &outcome) {
+    switch (outcome.status) {
+    case PalantirStatus::Unavailable:
+        return "Palantír тимчасово недоступний";
+    case PalantirStatus::TimedOut:
+        return "Palantír не відповів вчасно";
+    case PalantirStatus::BadPayload:
+        return "некоректна відповідь сервера";
+    case PalantirStatus::ServerError:
+        return outcome.errorString;
+    default:
+        return "не вдалося отримати дані";
+    }
+}
+
+/**
+ * @brief Стан пакетного запиту кількох терміналів
+ */
+struct Bot::TerminalBatch {
+    qint64 chatId = 0;
+    qint64 clientId = 0;
+    QList<int> terminalIds;
+    QStringList lines;          // Рядок зведення для кожного терміналу, у порядку введення
+    QString staleNote;          // Перша позначка застарілих даних, якщо такі були
+    int next = 0;               // Наступний термінал у черзі
+    int inFlight = 0;
+    int done = 0;
+    int failed = 0;
+    QElapsedTimer timer;
+    ActionToken::Ptr token;     // Дія, що запустила пакет
+};
+
+/**
+ * @brief Запитує terminal_info для кількох терміналів паралельно, не більше lookup_concurrency одночасно
+ * @param terminalIds Номери терміналів обраного клієнта
+ */
+void Bot::handleTerminalBatch(qint64 chatId, const QList<int> &terminalIds) {
+    qInfo() << "📋 Пакетний запит" << terminalIds.size() << "терміналів клієнта" << lastSelectedClientId;
+
+    auto batch = std::make_shared<TerminalBatch>();
+    batch->chatId = chatId;
+    batch->clientId = lastSelectedClientId;
+    batch->terminalIds = terminalIds;
+    batch->lines.resize(terminalIds.size());
+    batch->timer.start();
+    batch->token = currentAction(chatId);
+
+    sendMessage(chatId, QString("⏳ Запитую %1 терміналів…").arg(terminalIds.size()));
+    pumpTerminalBatch(batch);
+}
+
+void Bot::pumpTerminalBatch(const std::shared_ptr<TerminalBatch> &batch) {
+    const int concurrency = qMax(1, Config::current().lookupConcurrency);
+
+    while (batch->inFlight < concurrency && batch->next < batch->terminalIds.size()) {
+        const int index = batch->next++;
+        ++batch->inFlight;
+
+        client->terminal(batch->clientId, batch->terminalIds[index], batch->token)
+            .then(this, [this, batch, index](const PalantirClient::TerminalResult &result) {
+            --batch->inFlight;
+            ++batch->done;
+            if (batch->token && batch->token->isCancelled()) {
+                return;   // Решту пакета не запитуємо і зведення не надсилаємо
+            }
+
+            // 🔹 Помилка одного терміналу лишається в його рядку і не зриває пакет
+            if (result.ok()) {
+                batch->lines[index] = Renderers::terminalBatchLine(result.value);
+                if (result.fromCache && batch->staleNote.isEmpty()) {
+                    batch->staleNote = staleNote(result);
+                }
+            } else {
+                ++batch->failed;
+                batch->lines[index] = Renderers::terminalBatchFailure(batch->terminalIds[index], dashboardError(result));
+            }
+
+            if (batch->done == batch->terminalIds.size()) {
+                finishTerminalBatch(*batch);
+            } else {
+                pumpTerminalBatch(batch);
+            }
+        });
+    }
+}
+
+/**
+ * @brief Зведення пакета частинами до messageLimit з інтервалом 700 мс між частинами
+ */
+void Bot::finishTerminalBatch(const TerminalBatch &batch) {
+    qInfo() << "📋 Пакет із" << batch.terminalIds.size() << "терміналів за" << batch.timer.elapsed()
+            << "мс, помилок:" << batch.failed;
+
+    QString header = batch.staleNote + QString("📋 <b>Термінали (%1)</b>").arg(batch.terminalIds.size());
+    if (batch.failed > 0) {
+        header += QString(", ❌ не отримано: %1").arg(batch.failed);
+    }
+    header += "\n\n";
+
+    const QStringList parts = Renderers::chunked(batch.lines, header, "📋 <b>Термінали (продовження)</b>\n\n",
+                                                 Config::current().messageLimit);
+    for (int i = 0; i < parts.size(); ++i) {
+        const qint64 chatId = batch.chatId;
+        const QString part = parts[i];
+        QTimer::singleShot(i * 700, this, [this, chatId, part]() {
+            sendMessage(chatId, part);
+        });
     }
 }
 
@@ -1044,91 +2020,233 @@ void Bot::processTerminalInput(qint64 chatId, const QString &cleanText) {
  * @param terminalId Номер терміналу
  **/
 void Bot::fetchTerminalInfo(qint64 chatId, qint64 clientId, int terminalId) {
-    QUrl url(QString("http://localhost:8181/terminal_info?client_id=%1&terminal_id=%2")
-                 .arg(clientId).arg(terminalId));
+    const ActionToken::Ptr token = currentAction(chatId);
+    client->terminal(clientId, terminalId, token)
+        .then(this, [this, chatId, token](const PalantirClient::TerminalResult &result) {
+        if (token && token->isCancelled()) {
+            return;
+        }
+        if (!checkPalantirResult(chatId, result, "❌ Не вдалося отримати інформацію про термінал.")) {
+            return;
+        }
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+        // 📌 Формуємо текстове повідомлення
+        QString responseText = staleNote(result) + Renderers::terminalCard(result.value);
 
-    QNetworkReply *reply = networkManager->get(request);
+        // 📌 Картка і кнопки — одним видом, що далі редагується на місці
+        views->show(chatId, responseText, terminalMenuMarkup());
+    });
+}
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply, chatId, clientId, terminalId]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "❌ Помилка отримання даних про термінал:" << reply->errorString();
-            sendMessage(chatId, "❌ Не вдалося отримати інформацію про термінал.");
-            reply->deleteLater();
-            return;
-        }
 
-        QByteArray responseData = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
-        reply->deleteLater();
 
-        if (!jsonDoc.isObject()) {
-            qWarning() << "❌ Отримано некоректний JSON!";
-            sendMessage(chatId, "❌ Сталася помилка при обробці відповіді сервера.");
+
+
+
+
+/**
+ * @brief Дашборд терміналу: паралельно запитує terminal_info, reservoirs_info і posdatas
+ *        та надсилає одну зведену відповідь, коли всі три запити завершаться
+ * @param chatId ID чату користувача
+ */
+void Bot::handleDashboard(qint64 chatId) {
+    if (lastSelectedClientId == 0 || lastSelectedTerminalId == 0) {
+        sendMessage(chatId, "ℹ️ Спочатку оберіть клієнта та термінал.");
+        return;
+    }
+
+    qDebug() << "📊 Дашборд для терміналу" << lastSelectedTerminalId;
+
+    qint64 terminalId = lastSelectedTerminalId;
+    const ActionToken::Ptr token = currentAction(chatId);
+    QFuture<PalantirClient::TerminalResult> terminal = client->terminal(lastSelectedClientId, terminalId, token);
+    QFuture<PalantirClient::ReservoirsResult> reservoirs = client->reservoirs(lastSelectedClientId, terminalId, token);
+    QFuture<PalantirClient::PosDatasResult> posdatas = client->posdatas(lastSelectedClientId, terminalId, token);
+
+    using Sections = QList<std::variant<QFuture<PalantirClient::TerminalResult>,
+                                        QFuture<PalantirClient::ReservoirsResult>,
+                                        QFuture<PalantirClient::PosDatasResult>>>;
+    QtFuture::whenAll(terminal, reservoirs, posdatas)
+        .then(this, [this, chatId, terminalId, terminal, reservoirs, posdatas, token](const Sections &) {
+        if (token && token->isCancelled()) {
             return;
         }
+        renderDashboard(chatId, terminalId, terminal.result(), reservoirs.result(), posdatas.result());
+    });
+}
 
-        QJsonObject jsonObj = jsonDoc.object();
+void Bot::renderDashboard(qint64 chatId, qint64 terminalId, const PalantirClient::TerminalResult &terminal,
+                          const PalantirClient::ReservoirsResult &reservoirs, const PalantirClient::PosDatasResult &posdatas) {
+    QString responseText;
 
-        // 🔹 Перевіряємо, чи є помилка у відповіді
-        if (jsonObj.contains("error")) {
-            QString errorMessage = jsonObj["error"].toString();
-            qWarning() << "❌ Сервер повернув помилку:" << errorMessage;
-            sendMessage(chatId, "❌ " + errorMessage);
-            return;
+    for (const PalantirOutcome *outcome : { static_cast<const PalantirOutcome *>(&terminal),
+                                            static_cast<const PalantirOutcome *>(&reservoirs),
+                                            static_cast<const PalantirOutcome *>(&posdatas) }) {
+        if (outcome->fromCache) {
+            responseText = staleNote(*outcome);
+            break;
         }
+    }
 
-        // ✅ Отримуємо основну інформацію
-        QString clientName = jsonObj["client_name"].toString();
-        QString address = jsonObj["adress"].toString();
-        QString phone = jsonObj["phone"].toString();
-        int terminalNumber = jsonObj["terminal_id"].toInt();
+    if (terminal.ok()) {
+        responseText += Renderers::terminalCard(terminal.value);
+        responseText += Renderers::prk(terminal.value.dispensers) + "\n";
+    } else {
+        responseText += QString("⛽ <b>Термінал %1:</b> ❌ %2\n\n").arg(terminalId).arg(dashboardError(terminal));
+    }
 
-        // 📌 Формуємо текстове повідомлення
-        QString responseText;
-        responseText += QString("🏪 <b>АЗС:</b> %1\n").arg(clientName);
-        responseText += QString("⛽ <b>Термінал:</b> %1\n").arg(terminalNumber);
-        responseText += QString("📍 <b>Адреса:</b> %1\n").arg(address);
-        responseText += QString("📞 <b>Телефон:</b> <code>%1</code>\n\n").arg(phone);
+    if (reservoirs.ok()) {
+        responseText += Renderers::reservoirs(reservoirs.value);
+    } else {
+        responseText += QString("🛢 <b>Резервуари:</b> ❌ %1\n\n").arg(dashboardError(reservoirs));
+    }
+
+    if (posdatas.ok()) {
+        responseText += Renderers::rro(posdatas.value);
+    } else {
+        responseText += QString("💳 <b>Каси:</b> ❌ %1\n").arg(dashboardError(posdatas));
+    }
 
+    // 🔹 Великий дашборд відправляємо одним документом замість кількох повідомлень
+    if (responseText.size() <= 4000) {
         sendMessage(chatId, responseText);
+        return;
+    }
+
+    QString html = "<html><head><meta charset=\"utf-8\"></head><body>\n"
+                   + QString(responseText).replace("\n", "<br>\n")
+                   + "</body></html>\n";
+    sendDocument(chatId, QString("terminal_%1.html").arg(terminalId), html.toUtf8(), "text/html",
+                 QString("📊 Дашборд терміналу %1").arg(terminalId));
+}
 
-        // 📌 Додаємо кнопки
-        QJsonObject keyboard;
-        QJsonArray keyboardArray;
 
-        QJsonArray row1;
-        row1.append("💳 РРО");
-        row1.append("🛢 Резервуари");
-        row1.append("⛽ ПРК");
+/**
+ * @brief Підписка / відписка від сповіщень про зміни конфігурації
+ * @param chatId ID чату користувача
+ * @param text Команда: /subscribe [client_id] [terminal_id]. Без аргументів — обраний клієнт і термінал
+ * @param subscribe true — підписатися, false — відписатися
+ */
+void Bot::handleSubscribeCommand(qint64 chatId, const QString &text, bool subscribe) {
+    QStringList parts = text.split(" ", Qt::SkipEmptyParts);
 
-        QJsonArray row2;
-        row2.append("📍 Показати на карті");  // ✅ Нова кнопка
-        row2.append("🔙 Головне меню");
+    qint64 clientId = parts.size() > 1 ? parts[1].toLongLong() : lastSelectedClientId;
+    int terminalId = parts.size() > 2 ? parts[2].toInt() : (parts.size() > 1 ? 0 : int(lastSelectedTerminalId));
 
-        keyboardArray.append(row1);
-        keyboardArray.append(row2);
+    if (clientId == 0) {
+        sendMessage(chatId, "❌ Невірний формат. Використовуйте: /subscribe <client_id> [terminal_id]");
+        return;
+    }
 
-        keyboard["keyboard"] = keyboardArray;
-        keyboard["resize_keyboard"] = true;
-        keyboard["one_time_keyboard"] = false;
+    QString target = terminalId == 0 ? QString("клієнта %1").arg(clientId)
+                                     : QString("терміналу %1 клієнта %2").arg(terminalId).arg(clientId);
 
-        QJsonObject payload;
-        payload["chat_id"] = chatId;
-        payload["text"] = "Оберіть опцію:";
-        payload["reply_markup"] = keyboard;
+    if (subscribe) {
+        fleetWatcher->subscribe(chatId, clientId, terminalId);
+        sendMessage(chatId, "🔔 Ви підписані на зміни " + target + ".");
+    } else if (fleetWatcher->unsubscribe(chatId, clientId, terminalId)) {
+        sendMessage(chatId, "🔕 Підписку на зміни " + target + " скасовано.");
+    } else {
+        sendMessage(chatId, "ℹ️ Підписки на " + target + " не знайдено.");
+    }
+}
 
-        sendMessageWithKeyboard(payload);
+void Bot::handleSubscriptionsCommand(qint64 chatId) {
+    const auto subscriptions = fleetWatcher->subscriptionsOf(chatId);
+    if (subscriptions.isEmpty()) {
+        sendMessage(chatId, "ℹ️ У вас немає підписок.");
+        return;
+    }
 
-    });
+    QString responseText = "🔔 <b>Ваші підписки</b>\n";
+    for (const auto &sub : subscriptions) {
+        responseText += sub.second == 0 ? QString("🔹 Клієнт %1 (усі термінали)\n").arg(sub.first)
+                                        : QString("🔹 Клієнт %1, термінал %2\n").arg(sub.first).arg(sub.second);
+    }
+    sendMessage(chatId, responseText);
 }
 
+/**
+ * @brief Підписка на зведення за розкладом ([Digest] time)
+ * @param text /digest azs|rro daily|weekly [client_id] — без client_id обраний клієнт
+ *             /digest off [azs|rro] [client_id] — без client_id усі клієнти
+ *             /digest run — сформувати всі зведення зараз (адмін)
+ */
+void Bot::handleDigestCommand(qint64 chatId, qint64 userId, const QString &text) {
+    const QStringList parts = text.split(" ", Qt::SkipEmptyParts);
+    const QString usage = "❌ Невірний формат. Використовуйте: /digest azs|rro daily|weekly [client_id] "
+                          "або /digest off [azs|rro] [client_id]";
+
+    if (parts.size() == 2 && parts[1] == "run") {
+        if (!isAdmin(userId)) {
+            sendMessage(chatId, "❌ У вас немає прав для використання цієї команди.");
+        } else if (digests->isRunning()) {
+            sendMessage(chatId, "ℹ️ Зведення вже формуються.");
+        } else {
+            digests->run(true);
+            sendMessage(chatId, "📰 Формуємо зведення для всіх підписників.");
+        }
+        return;
+    }
+
+    if (parts.size() > 1 && parts[1] == "off") {
+        QList<DigestScheduler::Kind> kinds = { DigestScheduler::Kind::AzsChanges, DigestScheduler::Kind::RroExpiry };
+        int next = 2;
+        DigestScheduler::Kind kind;
+        if (parts.size() > next && DigestScheduler::kindFromName(parts[next], &kind)) {
+            kinds = { kind };
+            ++next;
+        }
+        const qint64 clientId = parts.size() > next ? parts[next].toLongLong() : 0;
+
+        const int removed = digests->unsubscribe(chatId, clientId, kinds);
+        sendMessage(chatId, removed > 0 ? QString("🔕 Скасовано зведень: %1.").arg(removed)
+                                        : QString("ℹ️ Таких зведень не знайдено."));
+        return;
+    }
+
+    DigestScheduler::Kind kind;
+    DigestScheduler::Period period;
+    if (parts.size() < 3 || !DigestScheduler::kindFromName(parts[1], &kind)
+        || !DigestScheduler::periodFromName(parts[2], &period)) {
+        sendMessage(chatId, usage);
+        return;
+    }
 
+    const qint64 clientId = parts.size() > 3 ? parts[3].toLongLong() : lastSelectedClientId;
+    if (clientId == 0) {
+        sendMessage(chatId, "❌ Спочатку оберіть клієнта або вкажіть client_id.");
+        return;
+    }
 
+    digests->subscribe(chatId, clientId, kind, period);
+    const ConfigSnapshot &config = Config::current();
+    QString when = "о " + config.digestTime;
+    if (period == DigestScheduler::Period::Weekly) {
+        when = QLocale(QLocale::Ukrainian).dayName(config.digestWeekday) + " " + when;
+    }
+    sendMessage(chatId, QString("📰 Зведення «%1» клієнта %2: %3, %4.")
+                            .arg(DigestScheduler::kindTitle(kind))
+                            .arg(clientId)
+                            .arg(DigestScheduler::periodTitle(period), when));
+}
 
+void Bot::handleDigestsCommand(qint64 chatId) {
+    const QList<DigestScheduler::Subscription> subscriptions = digests->subscriptionsOf(chatId);
+    if (subscriptions.isEmpty()) {
+        sendMessage(chatId, "ℹ️ У вас немає зведень.");
+        return;
+    }
 
+    QString responseText = "📰 <b>Ваші зведення</b>\n";
+    for (const DigestScheduler::Subscription &sub : subscriptions) {
+        const QString name = fleetIndex.clientName(sub.clientId);
+        responseText += QString("🔹 %1: %2, %3\n")
+                            .arg(name.isEmpty() ? QString::number(sub.clientId) : name.toHtmlEscaped())
+                            .arg(DigestScheduler::kindTitle(sub.kind), DigestScheduler::periodTitle(sub.period));
+    }
+    sendMessage(chatId, responseText);
+}
 
 
 void Bot::handleStartCommand(qint64 chatId) {
@@ -1144,6 +2262,7 @@ void Bot::handleStartCommand(qint64 chatId) {
     row1.append("📜 Допомога");
 
     row2.append("🚀 Почати");
+    row2.append(QJsonObject{{"text", "📍 Найближчі АЗС"}, {"request_location", true}});
 
     keyboardArray.append(row1);
     keyboardArray.append(row2);
@@ -1167,7 +2286,16 @@ void Bot::handleHelpCommand(qint64 chatId) {
     QString helpText = "❓ Доступні команди:\n"
                        "/start - Почати взаємодію з ботом\n"
                        "/help - Показати список команд\n"
-                       "/clients - показати список клієнтів\n";
+                       "/clients - показати список клієнтів\n"
+                       "/dashboard - усі дані обраного терміналу одним повідомленням\n"
+                       "/subscribe [client_id] [terminal_id] - сповіщення про зміни конфігурації\n"
+                       "/unsubscribe [client_id] [terminal_id] - скасувати сповіщення\n"
+                       "/subscriptions - мої підписки\n"
+                       "/digest azs|rro daily|weekly [client_id] - зведення змін АЗС або закінчення реєстрації РРО\n"
+                       "/digest off [azs|rro] [client_id] - скасувати зведення\n"
+                       "/digests - мої зведення\n"
+                       "/export azs|prk [csv|xlsx] - список АЗС клієнта або ПРК терміналу файлом\n"
+                       "📍 Надішліть геопозицію — найближчі АЗС усіх клієнтів\n";
 
     sendMessage(chatId, helpText);
 }
@@ -1176,23 +2304,45 @@ void Bot::handleHelpCommand(qint64 chatId) {
 void Bot::handleClientsCommand(qint64 chatId) {
     qInfo() << "? Виконання команди /clients для користувача" << chatId;
 
+    // 🔹 Каталог уже в пам'яті — відповідаємо одразу, оновлюємо у фоні
+    if (!clientsCatalog.isEmpty()) {
+        processClientsList(chatId, clientsCatalog);
+        palantir->get("clients", QUrlQuery(), [this](const PalantirResponse &response) {
+            if (response.ok && !response.fromCache) {
+                cacheClients(response.body);
+            }
+        });
+        return;
+    }
+
     // Запит до API Palantir для отримання списку клієнтів
-    QUrl url("http://localhost:8181/clients");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    const ActionToken::Ptr token = currentAction(chatId);
+    palantir->get("clients", QUrlQuery(), [this, chatId, token](const PalantirResponse &response) {
+        if (token && token->isCancelled()) {
+            return;
+        }
+        if (checkPalantirResponse(chatId, response, "? Помилка отримання даних.")) {
+            cacheClients(response.body);
+            processClientsList(chatId, response.body);
+        }
+    }, token);
+}
 
-    QNetworkReply *reply = networkManager->get(request);
+/**
+ * @brief Запам'ятовує каталог клієнтів і відповідність "Назва клієнта" -> ID
+ */
+void Bot::cacheClients(const QByteArray &data) {
+    QJsonArray clientsArray = QJsonDocument::fromJson(data).object()["data"].toArray();
+    if (clientsArray.isEmpty()) {
+        return;
+    }
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply, chatId]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            QByteArray responseData = reply->readAll();
-            processClientsList(chatId, responseData);
-        } else {
-            qWarning() << "? Помилка отримання списку клієнтів:" << reply->errorString();
-            sendMessage(chatId, "? Помилка отримання даних.");
-        }
-        reply->deleteLater();
-    });
+    clientsCatalog = data;
+    clientIdMap.clear();
+    for (const QJsonValue &client : clientsArray) {
+        QJsonObject obj = client.toObject();
+        clientIdMap[obj["name"].toString()] = obj["id"].toInt();
+    }
 }
 
 void Bot::processClientsList(qint64 chatId, const QByteArray &data) {
@@ -1211,41 +2361,14 @@ void Bot::processClientsList(qint64 chatId, const QByteArray &data) {
     }
 
     QJsonArray clientsArray = jsonObj["data"].toArray();
-    QJsonArray keyboardArray;
-    QJsonArray row;
-    int count = 0;
-
     clientIdMap.clear();  // Очистити перед записом нових значень
 
     for (const QJsonValue &client : clientsArray) {
         QJsonObject obj = client.toObject();
-        QString clientName = obj["name"].toString();
-        qint64 clientId = obj["id"].toInt();
-
-        clientIdMap[clientName] = clientId;  // Зберігаємо ID клієнта
-
-        row.append(clientName);
-        count++;
-
-        if (count == 3) {
-            keyboardArray.append(row);
-            row = QJsonArray();
-            count = 0;
-        }
-    }
-
-    if (!row.isEmpty()) {
-        keyboardArray.append(row);
+        clientIdMap[obj["name"].toString()] = obj["id"].toInt();  // Зберігаємо ID клієнта
     }
 
-    QJsonArray backRow;
-    backRow.append("🔙 Головне меню");
-    keyboardArray.append(backRow);
-
-    QJsonObject keyboard;
-    keyboard["keyboard"] = keyboardArray;
-    keyboard["resize_keyboard"] = true;
-    keyboard["one_time_keyboard"] = false;
+    QJsonObject keyboard = Renderers::clientsKeyboard(clientsArray);
 
     QJsonObject payload;
     payload["chat_id"] = chatId;
@@ -1257,22 +2380,13 @@ void Bot::processClientsList(qint64 chatId, const QByteArray &data) {
 
 void Bot::fetchClientsList()
 {
-    QUrl url("http://localhost:8181/clients");  // Адреса API
-    QNetworkRequest request(url);
-
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
-    QNetworkReply *reply = networkManager->get(request);
-
     // Обробляємо відповідь
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            QByteArray responseData = reply->readAll();
-            processClientsResponse(responseData);
+    palantir->get("clients", QUrlQuery(), [this](const PalantirResponse &response) {
+        if (response.ok) {
+            processClientsResponse(response.body);
         } else {
-            qWarning() << "HTTP Error:" << reply->errorString();
+            qWarning() << "HTTP Error:" << response.errorString;
         }
-        reply->deleteLater();
     });
 }
 
@@ -1304,52 +2418,132 @@ void Bot::processClientsResponse(const QByteArray &data) {
     sendMessage(lastChatId, responseMessage);
 }
 
-void Bot::sendMessageWithKeyboard(const QJsonObject &payload) {
-    QString url = QString("https://api.telegram.org/bot%1/sendMessage").arg(botToken);
-
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+/**
+ * @brief Перевіряє відповідь Palantír і повідомляє користувача про невдачу
+ * @return true, якщо тіло відповіді можна обробляти
+ */
+bool Bot::checkPalantirResponse(qint64 chatId, const PalantirResponse &response, const QString &failText) {
+    if (response.ok) {
+        return true;
+    }
+    if (response.cancelled) {
+        qDebug() << "⏹ Запит до Palantír скасовано:" << response.errorString;
+        return false;
+    }
 
-    QNetworkReply *reply = networkManager->post(request, QJsonDocument(payload).toJson());
+    qWarning() << "❌ Запит до Palantír не вдався:" << response.errorString;
 
-    connect(reply, &QNetworkReply::finished, this, [reply]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "Помилка при відправці повідомлення:" << reply->errorString();
-        } else {
-            qInfo() << "✅ Меню команд успішно відправлено.";
-        }
-        reply->deleteLater();
-    });
+    if (response.timedOut) {
+        sendMessage(chatId, "⌛ Palantír не відповів вчасно, спробуйте ще раз.");
+    } else if (response.degraded) {
+        sendMessage(chatId, "⚠️ Palantír тимчасово недоступний, спробуйте пізніше.");
+    } else {
+        sendMessage(chatId, failText);
+    }
+    return false;
 }
 
+/**
+ * @brief Перевіряє типізований результат Palantír і повідомляє користувача про невдачу
+ * @return true, якщо result.value можна використовувати
+ */
+bool Bot::checkPalantirResult(qint64 chatId, const PalantirOutcome &outcome, const QString &failText) {
+    switch (outcome.status) {
+    case PalantirStatus::Ok:
+        return true;
+    case PalantirStatus::Unavailable:
+        qWarning() << "❌ Запит до Palantír не вдався:" << outcome.errorString;
+        sendMessage(chatId, "⚠️ Palantír тимчасово недоступний, спробуйте пізніше.");
+        break;
+    case PalantirStatus::RequestFailed:
+        qWarning() << "❌ Запит до Palantír не вдався:" << outcome.errorString;
+        sendMessage(chatId, failText);
+        break;
+    case PalantirStatus::TimedOut:
+        qWarning() << "⌛ Palantír не відповів до дедлайну дії:" << outcome.errorString;
+        sendMessage(chatId, "⌛ Palantír не відповів вчасно, спробуйте ще раз.");
+        break;
+    case PalantirStatus::BadPayload:
+        qWarning() << "❌ Отримано некоректний JSON!" << outcome.errorString;
+        sendMessage(chatId, "❌ Сталася помилка при обробці відповіді сервера.");
+        break;
+    case PalantirStatus::ServerError:
+        qWarning() << "❌ Сервер повернув помилку:" << outcome.errorString;
+        sendMessage(chatId, "❌ " + outcome.errorString);
+        break;
+    case PalantirStatus::Cancelled:
+        qDebug() << "⏹ Запит до Palantír скасовано:" << outcome.errorString;   // Дія вже нікому не потрібна
+        break;
+    }
+    return false;
+}
 
-void Bot::sendMessage(qint64 chatId, const QString &text, bool isHtml) {
-    QUrl url(QString("https://api.telegram.org/bot%1/sendMessage").arg(botToken));
-
-    QUrlQuery query;
-    query.addQueryItem("chat_id", QString::number(chatId));
-    query.addQueryItem("text", text);
+/**
+ * @brief Позначка для даних, що взяті з кешу через недоступність Palantír
+ */
+QString Bot::staleNote(const PalantirResponse &response) {
+    if (!response.fromCache) {
+        return QString();
+    }
+    return QString("⚠️ <i>Palantír недоступний, дані станом на %1</i>\n\n")
+        .arg(response.fetchedAt.toString("dd.MM HH:mm"));
+}
 
-    if (isHtml) {
-        query.addQueryItem("parse_mode", "HTML");  // Додаємо підтримку HTML
+QString Bot::staleNote(const PalantirOutcome &outcome) {
+    if (!outcome.fromCache) {
+        return QString();
     }
+    return QString("⚠️ <i>Palantír недоступний, дані станом на %1</i>\n\n")
+        .arg(outcome.fetchedAt.toString("dd.MM HH:mm"));
+}
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+void Bot::sendMessageWithKeyboard(const QJsonObject &payload) {
+    // 🔹 Клавіатура приєднується до тексту, що ще чекає у черзі чату
+    outbound->textWithMarkup(payload["chat_id"].toVariant().toLongLong(), payload["text"].toString(),
+                             payload["reply_markup"].toObject(), payload.contains("parse_mode"));
+}
 
-    QNetworkAccessManager *manager = new QNetworkAccessManager(this);
-    manager->post(request, query.toString(QUrl::FullyEncoded).toUtf8());
+
+void Bot::sendMessage(qint64 chatId, const QString &text, bool isHtml) {
+    // 🔹 Послідовні тексти одного чату в межах вікна злиття йдуть одним повідомленням
+    outbound->text(chatId, text, isHtml);
 }
 
-void Bot::requestAdminApproval(qint64 userId, qint64 chatId, const QString &firstName, const QString &lastName, const QString &username) {
-    QString adminsFilePath = QCoreApplication::applicationDirPath() + "/Config/admins.txt";
+/**
+ * @brief Надсилає файл як документ (multipart/form-data)
+ * @param chatId ID чату
+ * @param fileName Ім'я файлу, яке побачить користувач
+ * @param content Вміст файлу
+ * @param mimeType MIME-тип вмісту
+ * @param caption Підпис до документа (HTML)
+ */
+void Bot::sendDocument(qint64 chatId, const QString &fileName, const QByteArray &content,
+                       const QString &mimeType, const QString &caption) {
+    QBuffer *buffer = new QBuffer;
+    buffer->setData(content);
+    buffer->open(QIODevice::ReadOnly);
+    sendDocument(chatId, fileName, buffer, mimeType, caption);
+}
 
-    QFile file(adminsFilePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "❌ Не вдалося відкрити admins.txt за шляхом:" << adminsFilePath;
-        return;
-    }
+/**
+ * @brief Відправляє документ, вміст якого читається з пристрою під час завантаження
+ * @param device Відкритий для читання пристрій; переходить у власність вихідної черги
+ *
+ * QHttpMultiPart читає тіло частинами, тож файл з диска не копіюється в пам'ять.
+ * Документ іде через чергу чату, тож не випереджає тексти, що ще чекають на відправку.
+ */
+void Bot::sendDocument(qint64 chatId, const QString &fileName, QIODevice *device,
+                       const QString &mimeType, const QString &caption) {
+    outbound->document(chatId, fileName, device, mimeType, caption, [fileName](const TelegramResult &result) {
+        if (!result.ok) {
+            qWarning() << "❌ Помилка надсилання документа" << fileName << ":" << result.description;
+        } else {
+            qDebug() << "📎 Документ надіслано:" << fileName;
+        }
+    });
+}
 
+void Bot::requestAdminApproval(qint64 userId, qint64 chatId, const QString &firstName, const QString &lastName, const QString &username) {
     // 🔹 Зберігаємо дані користувача для подальшого запису у `users.txt`
     lastApprovalRequest[userId] = std::make_tuple(firstName, lastName, username);
 
@@ -1362,74 +2556,32 @@ void Bot::requestAdminApproval(qint64 userId, qint64 chatId, const QString &firs
 
     userInfo += QString("\nВикористовуйте \n/approve %1 для підтвердження або \n/reject %1 для відмови.").arg(userId);
 
-    QTextStream in(&file);
-    while (!in.atEnd()) {
-        QString adminId = in.readLine().trimmed();
-        if (!adminId.isEmpty()) {
-            sendMessage(adminId.toLongLong(), userInfo);
-        }
+    const QList<qint64> adminIds = acl.admins();
+    for (qint64 adminId : adminIds) {
+        sendMessage(adminId, userInfo);
     }
-
-    file.close();
 }
 
 
 
 bool Bot::isUserAuthorized(qint64 userId) {
-    QString usersFilePath = QCoreApplication::applicationDirPath() + "/Config/users.txt";
-    QString blacklistFilePath = QCoreApplication::applicationDirPath() + "/Config/blacklist.txt";
-
     // 🔹 Перевіряємо, чи userId у чорному списку
-    QFile blacklistFile(blacklistFilePath);
-    if (blacklistFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&blacklistFile);
-        while (!in.atEnd()) {
-            if (in.readLine().trimmed() == QString::number(userId)) {
-                qDebug() << "❌ Користувач " << userId << " у чорному списку!";
-                blacklistFile.close();
-                return false;
-            }
-        }
-        blacklistFile.close();
+    if (acl.isBlacklisted(userId)) {
+        qDebug() << "❌ Користувач " << userId << " у чорному списку!";
+        return false;
     }
 
     // 🔹 Адміністратор завжди має доступ
-    if (userId == Config::instance().getAdminID().toLongLong()) {
+    if (userId == Config::current().adminId.toLongLong()) {
         return true;
     }
 
-    // 🔹 Перевіряємо `users.txt`
-    QFile userFile(usersFilePath);
-    if (!userFile.exists()) {
-        qDebug() << "users.txt не існує, створюємо...";
-        return false;
-    }
-
-    if (!userFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "❌ Не вдалося відкрити users.txt";
-        return false;
-    }
-
-    QTextStream userIn(&userFile);
-    while (!userIn.atEnd()) {
-        QString line = userIn.readLine().trimmed();
-        QStringList parts = line.split("#");
-        QString storedUserId = parts[0].trimmed();  // 🔹 Видаляємо пробіли перед порівнянням
-
-        if (storedUserId == QString::number(userId)) {
-            userFile.close();
-            return true;
-        }
-    }
-
-    userFile.close();
-    return false;
+    // 🔹 Перевіряємо users.txt (у пам'яті)
+    return acl.isUser(userId);
 }
 
 
 void Bot::handleApproveCommand(qint64 chatId, qint64 userId, const QString &text) {
-    QString usersFilePath = QCoreApplication::applicationDirPath() + "/Config/users.txt";
-
     QStringList parts = text.split(" ");
     if (parts.size() < 2) {
         sendMessage(chatId, "❌ Невірний формат. Використовуйте: /approve <user_id>");
@@ -1443,15 +2595,6 @@ void Bot::handleApproveCommand(qint64 chatId, qint64 userId, const QString &text
         return;
     }
 
-    QFile file(usersFilePath);
-    if (!file.open(QIODevice::Append | QIODevice::Text)) {
-        sendMessage(chatId, "❌ Помилка: не вдалося оновити users.txt");
-        return;
-    }
-
-    QTextStream out(&file);
-    out << approvedUserId;
-
     // 🔹 Додаємо ім'я, прізвище та Telegram username
     QString userInfo;
     if (lastApprovalRequest.contains(approvedUserId)) {
@@ -1461,13 +2604,11 @@ void Bot::handleApproveCommand(qint64 chatId, qint64 userId, const QString &text
         if (!username.isEmpty()) userInfo += " (@" + username + ")";
     }
 
-    if (!userInfo.isEmpty()) {
-        out << " #" << userInfo.trimmed();
+    if (!acl.addUser(approvedUserId, userInfo.trimmed())) {
+        sendMessage(chatId, "❌ Помилка: не вдалося оновити users.txt");
+        return;
     }
 
-    out << "\n";
-    file.close();
-
     sendMessage(chatId, "✅ Користувач " + parts[1] + " успішно авторизований!");
     sendMessage(approvedUserId, "✅ Адміністратор надав вам доступ до бота.");
 }
@@ -1491,7 +2632,7 @@ void ensureAdminExists() {
 
     QTextStream in(&file);
     bool found = false;
-    QString adminID = Config::instance().getAdminID();
+    QString adminID = Config::current().adminId;
 
     while (!in.atEnd()) {
         if (in.readLine().trimmed() == adminID) {
@@ -1510,8 +2651,6 @@ void ensureAdminExists() {
 }
 
 void Bot::handleRejectCommand(qint64 chatId, qint64 userId, const QString &text) {
-    QString blacklistFilePath = QCoreApplication::applicationDirPath() + "/Config/blacklist.txt";
-
     QStringList parts = text.split(" ");
     if (parts.size() < 2) {
         sendMessage(chatId, "❌ Невірний формат. Використовуйте: /reject <user_id>");
@@ -1521,28 +2660,16 @@ void Bot::handleRejectCommand(qint64 chatId, qint64 userId, const QString &text)
     qint64 rejectedUserId = parts[1].toLongLong();
 
     // Перевіряємо, чи користувач уже в blacklist.txt
-    QFile file(blacklistFilePath);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        while (!in.atEnd()) {
-            if (in.readLine().trimmed() == QString::number(rejectedUserId)) {
-                sendMessage(chatId, "❌ Користувач " + parts[1] + " уже заблокований.");
-                file.close();
-                return;
-            }
-        }
-        file.close();
+    if (acl.isBlacklisted(rejectedUserId)) {
+        sendMessage(chatId, "❌ Користувач " + parts[1] + " уже заблокований.");
+        return;
     }
 
     // Додаємо userId у blacklist.txt
-    if (!file.open(QIODevice::Append | QIODevice::Text)) {
+    if (!acl.addBlacklisted(rejectedUserId)) {
         sendMessage(chatId, "❌ Помилка: не вдалося оновити blacklist.txt");
         return;
     }
 
-    QTextStream out(&file);
-    out << rejectedUserId << "\n";
-    file.close();
-
     sendMessage(chatId, "🚫 Користувач " + parts[1] + " заблокований.");
 }
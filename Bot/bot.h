@@ -5,22 +5,65 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
+#include <QPointer>
+#include <QElapsedTimer>
 #include <tuple>
+#include <memory>
 #include <QMap>
+#include "palantirgateway.h"
+#include "palantirclient.h"
+#include "telegramapi.h"
+#include "outboundqueue.h"
+#include "broadcastjob.h"
+#include "chatviews.h"
+#include "fleetwatcher.h"
+#include "digestscheduler.h"
+#include "fleetindex.h"
+#include "geoindex.h"
+#include "accesslist.h"
+#include "startupsequence.h"
+#include "admissioncontroller.h"
+#include "trafficrecorder.h"
+#include "catalogsnapshot.h"
+#include "loopmonitor.h"
+#include "handoff.h"
+#include "tableexport.h"
+#include "actiontoken.h"
 
 class Bot : public QObject {
     Q_OBJECT
 public:
-    explicit Bot(QObject *parent = nullptr);
+    // networkManager — інший транспорт (відтворення трафіку): тоді фонові задачі,
+    // що змінюють стан на диску (розсилка, обхід парку), не запускаються
+    explicit Bot(QNetworkAccessManager *networkManager = nullptr, QObject *parent = nullptr);
     void startPolling();  // Почати отримання повідомлень
+    void restoreState(const QJsonObject &state);        // 🔁 Стан, переданий старим процесом
+    void processUpdate(const QJsonObject &update);      // Обробка одного оновлення Telegram
+    void setRecorder(TrafficRecorder *recorder);        // ⏺ Запис вхідного трафіку
+    void allowUsers(const QSet<qint64> &userIds);       // Доступ для записаних користувачів (replay)
     void sendMessage(qint64 chatId, const QString &text, bool isHtml = true); // Відправити повідомлення
+    void sendDocument(qint64 chatId, const QString &fileName, const QByteArray &content,
+                      const QString &mimeType, const QString &caption = QString()); // Відправити файл
+    void sendDocument(qint64 chatId, const QString &fileName, QIODevice *device,
+                      const QString &mimeType, const QString &caption = QString()); // Файл потоком з пристрою
 
     static void initLogging();  // 🔹 Метод ініціалізації логування
+    // 🔹 Розбір відповіді getUpdates: оновлення по порядку, найбільший update_id — у lastUpdateId
+    static bool parseUpdates(const QByteArray &body, QList<QJsonObject> &updates, qint64 &lastUpdateId);
 
 private slots:
     void getUpdates();  // Отримати нові повідомлення
+    void checkPolling();  // 🐕 Сторож: long poll не завис і не загубився
 
 private:
+    void schedulePoll(int delayMs);                                      // Наступний getUpdates через delayMs
+    void abortPoll();
+    void stopPolling();
+    void startBackgroundJobs();                                          // Розсилка, обхід парку, запис знімка
+    void beginHandoff(HandoffServer::Ready ready);                       // 🔁 Зупинитись і віддати стан
+    void finishHandoff();                                                // Дочистити черги і вийти
+    void resumeAfterHandoff();
+    QJsonObject exportState() const;
     void loadBotToken();                                                 // Завантажує токен бота з `config.ini`
     void handleStartCommand(qint64 chatId);  // 🔹 Метод для обробки команди `/start`
     void handleHelpCommand(qint64 chatId);   // 🔹 Обробка `/help`
@@ -31,8 +74,12 @@ private:
     void sendMessageWithKeyboard(const QJsonObject &payload);
     bool isUserAuthorized(qint64 chatId);           // Перевірка авторізації
     void processClientsList(qint64 chatId, const QByteArray &data);
+    void cacheClients(const QByteArray &data);       // Каталог клієнтів у пам'яті
     bool authorizeUser(qint64 chatId);               // авторизація користувача
     void processMessage(qint64 chatId, qint64 userId, const QString &text, const QString &firstName, const QString &lastName, const QString &username); //обробка команд і кнопок
+    ActionToken::Ptr beginAction(qint64 chatId, const QString &action);  // nullptr — повторне натискання, поки перше в польоті
+    void cancelAction(qint64 chatId, const QString &reason);            // ⏹ Обриває запити поточної дії чату
+    ActionToken::Ptr currentAction(qint64 chatId) const;
     void requestAdminApproval(qint64 userId, qint64 chatId, const QString &firstName, const QString &lastName, const QString &username);
     void handleApproveCommand(qint64 chatId, qint64 userId, const QString &text);
     void handleRejectCommand(qint64 chatId, qint64 userId, const QString &text);
@@ -43,30 +90,88 @@ private:
     void handleReservoirInfo(qint64 chatId);
     void handleBroadcastCommand(qint64 chatId, qint64 userId);
     void startBroadcast(qint64 chatId, const QString &message);
+    void handleBroadcastCancel(qint64 chatId, qint64 userId);  // ⏹ Скасування розсилки
     void handleLocationRequest(qint64 chatId);
     void sendLocation(qint64 chatId, double latitude, double longitude);
+    void sendVenue(qint64 chatId, double latitude, double longitude, const QString &title, const QString &address); // Карта з підписом одним повідомленням
+    void handleNearestCommand(qint64 chatId, const QString &text);  // 📍 Найближчі АЗС до геопозиції
+    void handleDashboard(qint64 chatId);  // 📊 Паралельний запит усіх даних терміналу
+    void handleSubscribeCommand(qint64 chatId, const QString &text, bool subscribe); // 🔔 /subscribe, /unsubscribe
+    void handleSubscriptionsCommand(qint64 chatId);
+    void handleDigestCommand(qint64 chatId, qint64 userId, const QString &text);  // 📰 /digest — зведення за розкладом
+    void handleDigestsCommand(qint64 chatId);
+    void handleStatsCommand(qint64 chatId, qint64 userId);  // 📈 Лічильники для адміна
+    void handleQueryCommand(qint64 chatId, qint64 userId, const QString &text);  // 🔎 /q — запити по парку
+    void handleExportCommand(qint64 chatId, const QString &text);  // 📥 /export — таблиця файлом
+    void exportAzsList(qint64 chatId, TableExport::Format format);
+    void exportPrk(qint64 chatId, TableExport::Format format);
+    void sendExport(qint64 chatId, TableExport &table, const QString &baseName, const QString &caption);
+    void renderDashboard(qint64 chatId, qint64 terminalId, const PalantirClient::TerminalResult &terminal,
+                         const PalantirClient::ReservoirsResult &reservoirs, const PalantirClient::PosDatasResult &posdatas);
 
     bool isAdmin(qint64 userId);
     void processClientSelection(qint64 chatId, const QString &clientName); //обробка вибору клієнта
+    void handleCallbackQuery(const QJsonObject &callbackQuery);             // 🔘 Натискання inline-кнопки
+    static QJsonObject clientMenuMarkup();                                  // Inline-меню клієнта
+    static QJsonObject terminalMenuMarkup();                                // Inline-меню терміналу
     void processTerminalInput(qint64 chatId, const QString &cleanText);     //обробка номера терміналу
+    static bool parseTerminalList(const QString &text, int limit, QList<int> *terminalIds, QString *error); // "101, 105, 120-135"
+    struct TerminalBatch;
+    void handleTerminalBatch(qint64 chatId, const QList<int> &terminalIds);   // 📋 Кілька терміналів одним зведенням
+    void pumpTerminalBatch(const std::shared_ptr<TerminalBatch> &batch);
+    void finishTerminalBatch(const TerminalBatch &batch);
     void fetchTerminalInfo(qint64 chatId, qint64 clientId, int terminalId); // * @brief Виконує запит у Palantír для отримання інформації про термінал
     void processTerminalInfo(qint64 chatId, const QByteArray &data);        //@brief Обробляє відповідь Palantír із інформацією про термінал
+    bool checkPalantirResponse(qint64 chatId, const PalantirResponse &response, const QString &failText); // Перевірка відповіді Palantír
+    bool checkPalantirResult(qint64 chatId, const PalantirOutcome &outcome, const QString &failText);     // Те саме для PalantirClient
+    static QString staleNote(const PalantirResponse &response);             // Позначка застарілих даних з кешу
+    static QString staleNote(const PalantirOutcome &outcome);
 
     static void rotateOldLogs();  // Архівує старі .log у .7z
 
 private:
     QNetworkAccessManager *networkManager;
+    PalantirGateway *palantir;  // Запити до Palantír з дедлайнами та запобіжником
+    PalantirClient *client;     // Типізовані запити до Palantír (QFuture)
+    PalantirGateway *backgroundPalantir;  // Обхід парку і зведення: власні кеш і запобіжник
+    PalantirClient *backgroundClient;
+    TelegramApi *telegram;      // Виклики Telegram API з результатом
+    OutboundQueue *outbound;    // Вихідні повідомлення по чатах зі злиттям
+    BroadcastJob *broadcastJob; // Фонова розсилка з відновленням
+    ChatViews *views;           // Поточний вид кожного чату (редагується на місці)
+    FleetWatcher *fleetWatcher; // Виявлення змін конфігурації парку
+    DigestScheduler *digests;   // Щоденні та щотижневі зведення по клієнтах
+    FleetIndex fleetIndex;      // Колонковий індекс парку для /q
+    GeoIndex stations;          // k-d дерево координат АЗС з fleetIndex
+    StartupSequence *startup;   // Паралельний старт і готовність
+    LoopMonitor *loopMonitor;   // Затримка циклу подій і зависання
+    QTimer *pollTimer;          // Пауза між long poll
+    QTimer *pollWatchdog;
+    QPointer<QNetworkReply> pollReply;  // Поточний getUpdates
+    QElapsedTimer pollActivity; // Від останнього запуску або планування long poll
+    quint64 pollRestarts = 0;
+    HandoffServer *handoffServer = nullptr;
+    bool handingOff = false;    // Стан передається новому процесу
+    bool replaying = false;     // Інший транспорт (відтворення, бенчмарки): без фонових задач і передачі стану
+    TrafficRecorder *recorder = nullptr;
+    CatalogSnapshot *snapshot = nullptr;  // Каталог Palantír на диску (немає в режимі replay)
+    AccessList acl;             // admins/users/blacklist у пам'яті
+    AdmissionController admission; // Ліміти вхідних повідомлень
+    QByteArray clientsCatalog;  // Остання відповідь GET /clients
     QString botToken;
     qint64 lastUpdateId;  // Останній отриманий update_id
     qint64 lastChatId = 0;  // Зберігаємо останній Chat ID для відповідей
     QMap<QString, qint64> clientIdMap;  // Збереження відповідності "Назва клієнта" -> ID
     qint64 lastSelectedClientId = 0;  // ID вибраного клієнта
-    qint64 lastSelectedTerminalId;  // ✅ Додаємо збереження вибраного терміналу
+    qint64 lastSelectedTerminalId = 0;  // ✅ Додаємо збереження вибраного терміналу
     bool waitingForTerminal = false;  // Чи очікуємо введення номера терміналу?
     bool waitingForBroadcastMessage = false;
 
     QMap<qint64, std::tuple<QString, QString, QString>> lastApprovalRequest;
     QMap<qint64, QDateTime> lastActivity;  // Час останньої активності для кожного користувача
+    QHash<qint64, ActionToken::Ptr> actions;  // Поточна дія кожного чату: дедлайн і скасування запитів
+    quint64 duplicateTaps = 0;                // Повторні натискання, проігноровані під час дії
+    quint64 supersededActions = 0;            // Дії, скасовані новою командою, меню чи бездіяльністю
 
 };
 
@@ -0,0 +1,360 @@
+#include "broadcastjob.h"
+#include "config.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QHash>
+#include <QDebug>
+
+static const int kMaxInFlight = 10;
+static const int kMaxAttempts = 3;
+static const int kStatusUpdateMs = 3000;     // Як часто оновлювати статус для адміна
+
+/**
+ * @brief Чи означає помилка, що саме цей отримувач недоступний (а не що зламане повідомлення)
+ */
+static bool isRecipientGone(const TelegramResult &result) {
+    if (result.errorCode == 403) {
+        return true;  // Бот заблокований користувачем
+    }
+    if (result.errorCode != 400) {
+        return false;
+    }
+    const QString description = result.description.toLower();
+    return description.contains("chat not found") || description.contains("user is deactivated");
+}
+
+BroadcastJob::BroadcastJob(TelegramApi *telegram, const QString &stateDir, QObject *parent)
+    : QObject(parent), telegram(telegram) {
+    statePath = stateDir + "/broadcast.json";
+    logPath = stateDir + "/broadcast_log.txt";
+
+    connect(&sendTimer, &QTimer::timeout, this, &BroadcastJob::tick);
+}
+
+/**
+ * @brief Починає нову розсилку
+ * @param chatId Чат адміна, де показується прогрес
+ * @param text Текст повідомлення (HTML)
+ * @param recipientIds Отримувачі
+ */
+void BroadcastJob::start(qint64 chatId, const QString &text, const QList<qint64> &recipientIds) {
+    adminChatId = chatId;
+    message = text;
+    recipients = recipientIds;
+    deliveries = QList<Delivery>(recipients.size(), Delivery::Pending);
+    attempts = QList<int>(recipients.size(), 0);
+    statusMessageId = 0;
+    cancelled = false;
+    abortReason.clear();
+    sentCount = failedCount = blockedCount = 0;
+
+    QFile::remove(logPath);
+    saveState();
+
+    queue.clear();
+    for (int i = 0; i < recipients.size(); ++i) {
+        queue.enqueue(i);
+    }
+
+    running = true;
+    qInfo() << "📢 Розсилка стартувала для" << recipients.size() << "користувачів.";
+
+    // 🔹 Статусне повідомлення, яке далі лише редагується
+    QJsonObject payload;
+    payload["chat_id"] = adminChatId;
+    payload["text"] = statusText();
+    telegram->call("sendMessage", payload, [this](const TelegramResult &result) {
+        if (result.ok) {
+            statusMessageId = result.result.toObject()["message_id"].toVariant().toLongLong();
+            saveState();
+        }
+    });
+
+    sinceStatusUpdate.start();
+    sendTimer.start(sendInterval());
+}
+
+/**
+ * @brief Відновлює розсилку зі збереженого стану
+ * @return true, якщо знайдено незавершену розсилку
+ */
+bool BroadcastJob::resume() {
+    QFile stateFile(statePath);
+    if (running || !stateFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonObject state = QJsonDocument::fromJson(stateFile.readAll()).object();
+    stateFile.close();
+
+    if (state["finished"].toBool() || state["cancelled"].toBool()) {
+        return false;
+    }
+
+    adminChatId = state["admin_chat_id"].toVariant().toLongLong();
+    statusMessageId = state["status_message_id"].toVariant().toLongLong();
+    message = state["message"].toString();
+    recipients.clear();
+    for (const QJsonValue &id : state["recipients"].toArray()) {
+        recipients.append(id.toVariant().toLongLong());
+    }
+    deliveries = QList<Delivery>(recipients.size(), Delivery::Pending);
+    attempts = QList<int>(recipients.size(), 0);
+    sentCount = failedCount = blockedCount = 0;
+    cancelled = false;
+    suspended = false;
+    abortReason.clear();
+
+    // 🔹 Курсор = журнал доставки: все, що вже має результат, пропускаємо
+    QHash<qint64, Delivery> delivered;
+    QFile logFile(logPath);
+    if (logFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream in(&logFile);
+        while (!in.atEnd()) {
+            QStringList parts = in.readLine().split(' ');
+            if (parts.size() < 2) {
+                continue;
+            }
+            Delivery delivery = parts[1] == "sent" ? Delivery::Sent
+                              : parts[1] == "blocked" ? Delivery::Blocked : Delivery::Failed;
+            delivered.insert(parts[0].toLongLong(), delivery);
+        }
+    }
+
+    queue.clear();
+    for (int i = 0; i < recipients.size(); ++i) {
+        if (delivered.contains(recipients[i])) {
+            deliveries[i] = delivered.value(recipients[i]);
+            if (deliveries[i] == Delivery::Sent) ++sentCount;
+            else if (deliveries[i] == Delivery::Blocked) ++blockedCount;
+            else ++failedCount;
+        } else {
+            queue.enqueue(i);
+        }
+    }
+
+    qInfo() << "📢 Відновлено розсилку: залишилось" << queue.size() << "з" << recipients.size();
+
+    running = true;
+    sinceStatusUpdate.start();
+    updateStatus(true);
+    sendTimer.start(sendInterval());
+    return true;
+}
+
+/**
+ * @brief Інтервал між повідомленнями за лімітом із конфігурації
+ *        (Telegram дозволяє близько 30 повідомлень/с на бота)
+ */
+int BroadcastJob::sendInterval() {
+    return 1000 / qBound(1, Config::current().broadcastRatePerSec, 30);
+}
+
+void BroadcastJob::cancel() {
+    if (!running) {
+        return;
+    }
+    qInfo() << "⏹ Розсилку скасовано.";
+    cancelled = true;
+    queue.clear();
+    saveState();
+    if (inFlight == 0) {
+        finish();
+    }
+}
+
+/**
+ * @brief Зупиняє розсилку без завершення: журнал доставки лишається на диску,
+ *        і resume() (у цьому або новому процесі) продовжить з того ж місця
+ */
+void BroadcastJob::suspend() {
+    if (!running) {
+        return;
+    }
+    qInfo() << "⏸ Розсилку призупинено: у черзі" << queue.size() << ", у польоті" << inFlight;
+    running = false;
+    suspended = true;
+    sendTimer.stop();
+    queue.clear();
+}
+
+/**
+ * @brief Аварійно зупиняє розсилку через помилку в самому повідомленні
+ * @param reason Опис помилки від Telegram (показується адміну в статусі)
+ */
+void BroadcastJob::abort(const QString &reason) {
+    if (!running || cancelled) {
+        return;
+    }
+    qWarning() << "⛔ Розсилку зупинено через помилку повідомлення:" << reason;
+    abortReason = reason;
+    cancelled = true;
+    queue.clear();
+    saveState();
+}
+
+void BroadcastJob::tick() {
+    if (!pausedUntil.hasExpired()) {
+        return;  // Чекаємо після 429
+    }
+
+    updateStatus();
+
+    if (queue.isEmpty()) {
+        if (inFlight == 0 && scheduledRetries == 0) {
+            finish();
+        }
+        return;
+    }
+
+    if (inFlight >= kMaxInFlight) {
+        return;
+    }
+
+    int index = queue.dequeue();
+    ++attempts[index];
+    ++inFlight;
+
+    QJsonObject payload;
+    payload["chat_id"] = recipients[index];
+    payload["text"] = message;
+    payload["parse_mode"] = "HTML";  // ✅ Щоб підтримувались перенос рядків
+
+    telegram->call("sendMessage", payload, [this, index](const TelegramResult &result) {
+        onDelivered(index, result);
+    });
+}
+
+void BroadcastJob::onDelivered(int index, const TelegramResult &result) {
+    --inFlight;
+
+    if (result.ok) {
+        record(index, Delivery::Sent);
+    } else if (isRecipientGone(result)) {
+        record(index, Delivery::Blocked);  // Бот заблокований або чат не існує — не повторюємо
+    } else if (result.errorCode == 400) {
+        // 🔹 Помилка в самому повідомленні (напр. "can't parse entities") — інші отримувачі
+        //    отримають ту саму, тож зупиняємо розсилку, а не позначаємо їх заблокованими
+        abort(result.description);
+    } else if (cancelled) {
+        record(index, Delivery::Failed);
+    } else if (suspended) {
+        // Без запису в журнал: resume() відправить ще раз
+    } else if (result.errorCode == 429) {
+        // 🔹 Telegram просить пригальмувати — ставимо всю розсилку на паузу
+        pausedUntil.setRemainingTime(qMax(1, result.retryAfter) * 1000);
+        queue.prepend(index);
+        --attempts[index];
+    } else if (attempts[index] < kMaxAttempts) {
+        ++scheduledRetries;
+        int backoffMs = 2000 * attempts[index];
+        QTimer::singleShot(backoffMs, this, [this, index]() {
+            --scheduledRetries;
+            if (!cancelled && !suspended) {
+                queue.enqueue(index);
+            }
+        });
+    } else {
+        record(index, Delivery::Failed);
+    }
+
+    if (cancelled && inFlight == 0) {
+        finish();
+    }
+}
+
+void BroadcastJob::record(int index, Delivery delivery) {
+    deliveries[index] = delivery;
+    if (delivery == Delivery::Sent) ++sentCount;
+    else if (delivery == Delivery::Blocked) ++blockedCount;
+    else ++failedCount;
+
+    QFile logFile(logPath);
+    if (logFile.open(QIODevice::Append | QIODevice::Text)) {
+        QTextStream out(&logFile);
+        out << recipients[index] << " "
+            << (delivery == Delivery::Sent ? "sent" : delivery == Delivery::Blocked ? "blocked" : "failed") << "\n";
+    }
+}
+
+void BroadcastJob::finish() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    sendTimer.stop();
+
+    QFile stateFile(statePath);
+    if (stateFile.open(QIODevice::ReadOnly)) {
+        QJsonObject state = QJsonDocument::fromJson(stateFile.readAll()).object();
+        stateFile.close();
+        state["finished"] = true;
+        QSaveFile out(statePath);
+        if (out.open(QIODevice::WriteOnly)) {
+            out.write(QJsonDocument(state).toJson());
+            out.commit();
+        }
+    }
+
+    qInfo() << "✅ Розсилку завершено. Надіслано:" << sentCount << "Помилки:" << failedCount << "Заблоковано:" << blockedCount;
+    updateStatus(true);
+    emit finished(sentCount, failedCount, blockedCount);
+}
+
+void BroadcastJob::saveState() const {
+    QJsonObject state;
+    state["admin_chat_id"] = adminChatId;
+    state["status_message_id"] = statusMessageId;
+    state["message"] = message;
+    state["cancelled"] = cancelled;
+    state["finished"] = false;
+
+    QJsonArray ids;
+    for (qint64 id : recipients) {
+        ids.append(id);
+    }
+    state["recipients"] = ids;
+
+    QSaveFile file(statePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "❌ Не вдалося зберегти стан розсилки:" << statePath;
+        return;
+    }
+    file.write(QJsonDocument(state).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+QString BroadcastJob::statusText() const {
+    int done = sentCount + failedCount + blockedCount;
+    QString text = QString("📢 Розсилка: %1/%2\n✅ Надіслано: %3\n❌ Помилки: %4\n🚫 Заблоковано: %5")
+                       .arg(done).arg(recipients.size()).arg(sentCount).arg(failedCount).arg(blockedCount);
+    if (!running) {
+        if (!abortReason.isEmpty()) {
+            text += "\n⛔ Зупинено через помилку повідомлення: " + abortReason;
+        } else {
+            text += cancelled ? "\n⏹ Скасовано." : "\n🏁 Завершено.";
+        }
+    } else {
+        text += "\nСкасувати: /broadcast_cancel";
+    }
+    return text;
+}
+
+/**
+ * @brief Редагує статусне повідомлення адміна (не частіше ніж раз на kStatusUpdateMs)
+ */
+void BroadcastJob::updateStatus(bool force) {
+    if (statusMessageId == 0 || (!force && sinceStatusUpdate.elapsed() < kStatusUpdateMs)) {
+        return;
+    }
+    sinceStatusUpdate.restart();
+
+    QJsonObject payload;
+    payload["chat_id"] = adminChatId;
+    payload["message_id"] = statusMessageId;
+    payload["text"] = statusText();
+    telegram->call("editMessageText", payload);
+}
@@ -0,0 +1,74 @@
+#ifndef BROADCASTJOB_H
+#define BROADCASTJOB_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QDeadlineTimer>
+#include <QQueue>
+#include <QList>
+#include "telegramapi.h"
+
+/**
+ * @brief Фонова розсилка повідомлення всім користувачам.
+ *
+ * Надсилає з максимально дозволеною швидкістю без блокування event loop,
+ * зберігає курсор і результати доставки на диск (можна продовжити після
+ * перезапуску), автоматично повторює тимчасові збої і показує прогрес
+ * адміну, редагуючи одне статусне повідомлення.
+ */
+class BroadcastJob : public QObject {
+    Q_OBJECT
+public:
+    explicit BroadcastJob(TelegramApi *telegram, const QString &stateDir, QObject *parent = nullptr);
+
+    bool isRunning() const { return running; }
+    void start(qint64 adminChatId, const QString &message, const QList<qint64> &recipients);
+    bool resume();   // Продовжує незавершену розсилку після перезапуску
+    void cancel();
+    void suspend();  // Зупиняє відправку, стан лишається для resume() (передача стану)
+    bool isIdle() const { return inFlight == 0; }   // Немає відправок у польоті
+
+signals:
+    void finished(int sent, int failed, int blocked);
+
+private:
+    enum class Delivery { Pending, Sent, Failed, Blocked };
+
+    void tick();
+    void onDelivered(int index, const TelegramResult &result);
+    void record(int index, Delivery delivery);
+    void abort(const QString &reason);
+    void finish();
+    void saveState() const;
+    void updateStatus(bool force = false);
+    QString statusText() const;
+    static int sendInterval();
+
+    TelegramApi *telegram;
+    QString statePath;    // Заголовок розсилки (текст, адмін, статусне повідомлення)
+    QString logPath;      // Append-only журнал доставки: "<user_id> <sent|failed|blocked>"
+
+    QTimer sendTimer;
+    QElapsedTimer sinceStatusUpdate;
+    QDeadlineTimer pausedUntil;   // Пауза після 429 Too Many Requests
+
+    bool running = false;
+    bool cancelled = false;
+    bool suspended = false;
+    QString abortReason;          // Помилка Telegram, через яку розсилку зупинено
+    qint64 adminChatId = 0;
+    qint64 statusMessageId = 0;
+    QString message;
+    QList<qint64> recipients;
+    QList<Delivery> deliveries;
+    QList<int> attempts;
+    QQueue<int> queue;            // Індекси отримувачів, що чекають на відправку
+    int inFlight = 0;
+    int scheduledRetries = 0;
+    int sentCount = 0;
+    int failedCount = 0;
+    int blockedCount = 0;
+};
+
+#endif // BROADCASTJOB_H
@@ -0,0 +1,287 @@
+#include "catalogsnapshot.h"
+#include "loopmonitor.h"
+#include <QSaveFile>
+#include <QCoreApplication>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+static const char kMagic[8] = { 'S', 'F', 'X', 'C', 'A', 'T', 'L', 'G' };
+static const quint32 kVersion = 1;
+static const qint64 kHeaderSize = 8 + 4 + 4 + 8;
+static const qint64 kEntrySize = 8 + 4 + 4 + 4 + 4;
+
+namespace {
+
+struct Record {
+    QString key;
+    QByteArray body;
+    qint64 fetchedAtMs;
+};
+
+void appendLE32(QByteArray &out, quint32 value) {
+    char bytes[4];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 4);
+}
+
+void appendLE64(QByteArray &out, quint64 value) {
+    char bytes[8];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 8);
+}
+
+/**
+ * @brief Пише знімок у файл (викликається з фонового потоку)
+ */
+bool writeSnapshot(const QString &path, const QList<Record> &records) {
+    QList<QByteArray> keys;
+    keys.reserve(records.size());
+    qint64 keysSize = 0;
+    for (const Record &record : records) {
+        keys.append(record.key.toUtf8());
+        keysSize += keys.last().size();
+    }
+
+    QByteArray head;
+    head.reserve(kHeaderSize + records.size() * kEntrySize);
+    head.append(kMagic, sizeof(kMagic));
+    appendLE32(head, kVersion);
+    appendLE32(head, quint32(records.size()));
+    appendLE64(head, quint64(QDateTime::currentMSecsSinceEpoch()));
+
+    qint64 keyOffset = kHeaderSize + records.size() * kEntrySize;
+    qint64 bodyOffset = keyOffset + keysSize;
+    for (int i = 0; i < records.size(); ++i) {
+        if (bodyOffset + records[i].body.size() > qint64(std::numeric_limits<quint32>::max())) {
+            qWarning() << "❌ Знімок каталогу перевищує 4 ГБ, запис скасовано.";
+            return false;
+        }
+        appendLE64(head, quint64(records[i].fetchedAtMs));
+        appendLE32(head, quint32(keyOffset));
+        appendLE32(head, quint32(keys[i].size()));
+        appendLE32(head, quint32(bodyOffset));
+        appendLE32(head, quint32(records[i].body.size()));
+        keyOffset += keys[i].size();
+        bodyOffset += records[i].body.size();
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(head);
+    for (const QByteArray &key : keys) {
+        file.write(key);
+    }
+    for (const Record &record : records) {
+        file.write(record.body);
+    }
+    return file.commit();
+}
+
+}
+
+CatalogSnapshot::CatalogSnapshot(const QString &path, QObject *parent)
+    : QObject(parent), path(path), file(path) {
+    writer.setMaxThreadCount(1);
+    open();
+    connect(&flushTimer, &QTimer::timeout, this, &CatalogSnapshot::flush);
+}
+
+CatalogSnapshot::~CatalogSnapshot() {
+    // 🔹 Відповіді, що ще чекали таймера, — найсвіжіші дані каталогу
+    if (!stopped) {
+        flushSync();
+    }
+    writer.waitForDone();
+    close();
+}
+
+void CatalogSnapshot::start(int flushIntervalMs) {
+    stopped = false;
+    flushTimer.start(flushIntervalMs);
+}
+
+void CatalogSnapshot::stop() {
+    flushTimer.stop();
+    flushSync();
+    stopped = true;
+}
+
+/**
+ * @brief Відображає файл у пам'ять і читає таблицю записів
+ * @return false, якщо файлу немає, він пошкоджений або іншої версії
+ */
+bool CatalogSnapshot::open() {
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = file.size();
+    uchar *map = size >= kHeaderSize ? file.map(0, size) : nullptr;
+    if (!map || memcmp(map, kMagic, sizeof(kMagic)) != 0
+        || qFromLittleEndian<quint32>(map + 8) != kVersion) {
+        qWarning() << "⚠️ Знімок каталогу пошкоджений або застарілого формату, ігноруємо:" << path;
+        if (map) {
+            file.unmap(map);
+        }
+        file.close();
+        return false;
+    }
+
+    const quint32 count = qFromLittleEndian<quint32>(map + 12);
+    if (kHeaderSize + qint64(count) * kEntrySize > size) {
+        qWarning() << "⚠️ Знімок каталогу обрізаний, ігноруємо:" << path;
+        file.unmap(map);
+        file.close();
+        return false;
+    }
+
+    m_map = map;
+    m_entries.reserve(count);
+
+    const uchar *entry = map + kHeaderSize;
+    for (quint32 i = 0; i < count; ++i, entry += kEntrySize) {
+        Entry parsed;
+        parsed.fetchedAtMs = qFromLittleEndian<qint64>(entry);
+        const quint32 keyOffset = qFromLittleEndian<quint32>(entry + 8);
+        const quint32 keyLength = qFromLittleEndian<quint32>(entry + 12);
+        parsed.bodyOffset = qFromLittleEndian<quint32>(entry + 16);
+        parsed.bodyLength = qFromLittleEndian<quint32>(entry + 20);
+
+        if (qint64(keyOffset) + keyLength > size || qint64(parsed.bodyOffset) + parsed.bodyLength > size) {
+            continue;  // Пошкоджений запис пропускаємо, решта придатна
+        }
+        m_entries.insert(QString::fromUtf8(reinterpret_cast<const char *>(map + keyOffset), keyLength), parsed);
+    }
+
+    qInfo() << "🗂 Знімок каталогу відкрито:" << m_entries.size() << "записів," << size / 1024 << "КБ";
+    return true;
+}
+
+void CatalogSnapshot::close() {
+    if (m_map) {
+        file.unmap(m_map);
+        m_map = nullptr;
+    }
+    file.close();
+    m_entries.clear();
+}
+
+void CatalogSnapshot::store(const QString &key, const QByteArray &body, const QDateTime &fetchedAt) {
+    if (stopped) {
+        return;   // Файл уже пише новий процес — не перезаписуємо його своїм знімком
+    }
+    m_pending.insert(key, Pending{body, fetchedAt});
+}
+
+bool CatalogSnapshot::lookup(const QString &key, QByteArray *body, QDateTime *fetchedAt) const {
+    auto pending = m_pending.constFind(key);
+    if (pending != m_pending.cend()) {
+        *body = pending.value().body;
+        *fetchedAt = pending.value().fetchedAt;
+        return true;
+    }
+
+    auto entry = m_entries.constFind(key);
+    if (entry == m_entries.cend()) {
+        return false;
+    }
+    // Копія: відображення перевідкривається після кожного запису
+    *body = QByteArray(reinterpret_cast<const char *>(m_map + entry.value().bodyOffset), entry.value().bodyLength);
+    *fetchedAt = QDateTime::fromMSecsSinceEpoch(entry.value().fetchedAtMs);
+    return true;
+}
+
+/**
+ * @brief Зливає відображений файл і нові відповіді в новий знімок у фоновому потоці
+ */
+void CatalogSnapshot::flush() {
+    if (flushing) {
+        return;
+    }
+    write(true);
+}
+
+/**
+ * @brief Те саме, що flush(), але в поточному потоці; фоновий запис, що триває, спершу завершується
+ */
+void CatalogSnapshot::flushSync() {
+    if (flushing) {
+        writer.waitForDone();
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);   // install() фонового запису
+    }
+    write(false);
+}
+
+void CatalogSnapshot::write(bool background) {
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    QList<Record> records;
+    records.reserve(m_entries.size() + m_pending.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        if (!m_pending.contains(it.key())) {
+            records.append(Record{ it.key(),
+                                   QByteArray(reinterpret_cast<const char *>(m_map + it.value().bodyOffset), it.value().bodyLength),
+                                   it.value().fetchedAtMs });
+        }
+    }
+
+    QHash<QString, qint64> written;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        qint64 fetchedAtMs = it.value().fetchedAt.toMSecsSinceEpoch();
+        records.append(Record{ it.key(), it.value().body, fetchedAtMs });
+        written.insert(it.key(), fetchedAtMs);
+    }
+
+    QString writtenPath = path + ".new";
+    if (!background) {
+        if (writeSnapshot(writtenPath, records)) {
+            install(writtenPath, written);
+        } else {
+            qWarning() << "❌ Не вдалося записати знімок каталогу:" << writtenPath;
+        }
+        return;
+    }
+
+    flushing = true;
+    writer.start([this, writtenPath, records = std::move(records), written]() {
+        bool ok = writeSnapshot(writtenPath, records);
+        QMetaObject::invokeMethod(this, [this, ok, writtenPath, written]() {
+            flushing = false;
+            if (ok) {
+                install(writtenPath, written);
+            } else {
+                qWarning() << "❌ Не вдалося записати знімок каталогу:" << writtenPath;
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Підміняє файл знімка записаним і відображає його знову
+ *
+ * Відображення знімається до перейменування — на Windows відображений файл
+ * не можна замінити.
+ */
+void CatalogSnapshot::install(const QString &writtenPath, const QHash<QString, qint64> &written) {
+    LoopMonitor::Activity activity("CatalogSnapshot::install");
+    close();
+    QFile::remove(path);
+    if (!QFile::rename(writtenPath, path)) {
+        qWarning() << "❌ Не вдалося замінити знімок каталогу:" << path;
+    }
+    open();
+
+    // 🔹 Записані відповіді тепер у файлі; новіші за них лишаються в пам'яті
+    for (auto it = written.cbegin(); it != written.cend(); ++it) {
+        auto pending = m_pending.find(it.key());
+        if (pending != m_pending.end() && pending.value().fetchedAt.toMSecsSinceEpoch() <= it.value()) {
+            m_pending.erase(pending);
+        }
+    }
+}
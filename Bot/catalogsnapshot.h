@@ -0,0 +1,70 @@
+#ifndef CATALOGSNAPSHOT_H
+#define CATALOGSNAPSHOT_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QDateTime>
+#include <QTimer>
+#include <QThreadPool>
+
+/**
+ * @brief Знімок каталогу Palantír на диску (clients, azs_list, дані терміналів).
+ *
+ * Бінарний версіонований файл відображається в пам'ять (QFile::map): після
+ * перезапуску читається лише таблиця записів, тіла відповідей беруться прямо
+ * з відображення за потреби. Свіжі відповіді накопичуються в пам'яті і
+ * періодично переписуються у файл у фоновому потоці.
+ *
+ * Формат (little-endian):
+ *   Header  { "SFXCATLG", u32 version, u32 count, u64 createdMs }
+ *   Entry[count] { u64 fetchedAtMs, u32 keyOffset, u32 keyLength, u32 bodyOffset, u32 bodyLength }
+ *   ключі (UTF-8), потім тіла; зміщення — від початку файлу
+ */
+class CatalogSnapshot : public QObject {
+    Q_OBJECT
+public:
+    explicit CatalogSnapshot(const QString &path, QObject *parent = nullptr);
+    ~CatalogSnapshot() override;
+
+    void start(int flushIntervalMs);    // Періодичний запис накопичених відповідей
+    void stop();                        // Дописує накопичене; далі файл пише інший процес (передача стану)
+
+    // @param key "endpoint?query"
+    void store(const QString &key, const QByteArray &body, const QDateTime &fetchedAt);
+    bool lookup(const QString &key, QByteArray *body, QDateTime *fetchedAt) const;
+
+    void flush();                       // Записати зараз (у фоновому потоці)
+    void flushSync();                   // Записати зараз і дочекатися (зупинка, завершення процесу)
+    int entryCount() const { return int(m_entries.size()); }
+    bool isMapped() const { return m_map != nullptr; }
+
+private:
+    struct Entry {
+        qint64 fetchedAtMs = 0;
+        quint32 bodyOffset = 0;
+        quint32 bodyLength = 0;
+    };
+
+    struct Pending {
+        QByteArray body;
+        QDateTime fetchedAt;
+    };
+
+    bool open();
+    void close();
+    void write(bool background);
+    void install(const QString &writtenPath, const QHash<QString, qint64> &written);
+
+    QString path;
+    QFile file;
+    uchar *m_map = nullptr;
+    QHash<QString, Entry> m_entries;    // Таблиця записів відображеного файлу
+    QHash<QString, Pending> m_pending;  // Ще не записані відповіді
+    QTimer flushTimer;
+    QThreadPool writer;                 // Один фоновий запис за раз; flushSync чекає лише на нього
+    bool flushing = false;
+    bool stopped = false;               // Після передачі стану файл належить новому процесу
+};
+
+#endif // CATALOGSNAPSHOT_H
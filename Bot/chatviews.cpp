@@ -0,0 +1,131 @@
+#include "chatviews.h"
+#include <QJsonDocument>
+#include <QDebug>
+
+ChatViews::ChatViews(TelegramApi *telegram, OutboundQueue *outbound, QObject *parent)
+    : QObject(parent), telegram(telegram), outbound(outbound) {}
+
+size_t ChatViews::markupHashOf(const QJsonObject &markup) {
+    return markup.isEmpty() ? 0 : qHash(QJsonDocument(markup).toJson(QJsonDocument::Compact));
+}
+
+/**
+ * @brief Показує вміст у поточному повідомленні чату
+ * @param chatId ID чату
+ * @param text HTML-текст виду
+ * @param inlineMarkup InlineKeyboardMarkup (може бути порожнім)
+ */
+void ChatViews::show(qint64 chatId, const QString &text, const QJsonObject &inlineMarkup) {
+    View &view = views[chatId];
+
+    if (view.sending) {
+        // 🔹 Чекаємо message_id першого повідомлення, зберігаємо лише найновіший вміст
+        view.hasQueued = true;
+        view.queuedText = text;
+        view.queuedMarkup = inlineMarkup;
+        return;
+    }
+
+    if (view.messageId == 0) {
+        sendNew(chatId, text, inlineMarkup);
+        return;
+    }
+
+    size_t textHash = qHash(text);
+    size_t markupHash = markupHashOf(inlineMarkup);
+
+    if (textHash == view.textHash && markupHash == view.markupHash) {
+        ++m_skipped;
+        qDebug() << "♻️ Вид чату" << chatId << "не змінився, не надсилаємо.";
+        return;
+    }
+
+    QJsonObject payload;
+    payload["chat_id"] = chatId;
+    payload["message_id"] = view.messageId;
+    if (!inlineMarkup.isEmpty()) {
+        payload["reply_markup"] = inlineMarkup;
+    }
+
+    QString method;
+    if (textHash == view.textHash) {
+        method = "editMessageReplyMarkup";  // Змінилась лише клавіатура
+    } else {
+        method = "editMessageText";
+        payload["text"] = text;
+        payload["parse_mode"] = "HTML";
+    }
+
+    view.textHash = textHash;
+    view.markupHash = markupHash;
+    qint64 messageId = view.messageId;
+
+    telegram->call(method, payload, [this, chatId, messageId, text, inlineMarkup](const TelegramResult &result) {
+        if (result.ok || result.description.contains("message is not modified")) {
+            return;
+        }
+        // 🔹 Повідомлення видалене або застаре для редагування — надсилаємо нове
+        View &current = views[chatId];
+        if (current.messageId == messageId) {
+            current.messageId = 0;
+            sendNew(chatId, text, inlineMarkup);
+        }
+    });
+}
+
+void ChatViews::sendNew(qint64 chatId, const QString &text, const QJsonObject &markup) {
+    View &view = views[chatId];
+    view.sending = true;
+    view.textHash = qHash(text);
+    view.markupHash = markupHashOf(markup);
+
+    QJsonObject payload;
+    payload["chat_id"] = chatId;
+    payload["text"] = text;
+    payload["parse_mode"] = "HTML";
+    if (!markup.isEmpty()) {
+        payload["reply_markup"] = markup;
+    }
+
+    outbound->call(chatId, "sendMessage", payload, [this, chatId](const TelegramResult &result) {
+        View &current = views[chatId];
+        current.sending = false;
+        current.messageId = result.ok ? result.result.toObject()["message_id"].toVariant().toLongLong() : 0;
+
+        if (current.hasQueued) {
+            current.hasQueued = false;
+            QString queuedText = current.queuedText;
+            QJsonObject queuedMarkup = current.queuedMarkup;
+            show(chatId, queuedText, queuedMarkup);
+        }
+    });
+}
+
+QHash<qint64, qint64> ChatViews::messageIds() const {
+    QHash<qint64, qint64> ids;
+    for (auto it = views.cbegin(); it != views.cend(); ++it) {
+        if (it->messageId != 0) {
+            ids.insert(it.key(), it->messageId);
+        }
+    }
+    return ids;
+}
+
+void ChatViews::detach(qint64 chatId) {
+    auto it = views.find(chatId);
+    if (it != views.end() && !it->sending) {
+        views.erase(it);
+    }
+}
+
+/**
+ * @brief Робить повідомлення поточним видом чату (користувач натиснув кнопку під ним)
+ */
+void ChatViews::attach(qint64 chatId, qint64 messageId) {
+    View &view = views[chatId];
+    if (view.sending || view.messageId == messageId) {
+        return;
+    }
+    view = View();
+    view.messageId = messageId;  // Вміст невідомий — наступний show() його відредагує
+}
@@ -0,0 +1,52 @@
+#ifndef CHATVIEWS_H
+#define CHATVIEWS_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include "telegramapi.h"
+#include "outboundqueue.h"
+
+/**
+ * @brief «Поточний вид» кожного чату — одне повідомлення з inline-клавіатурою,
+ *        яке редагується на місці (editMessageText / editMessageReplyMarkup).
+ *
+ * Незмінений вміст повторно не надсилається.
+ */
+class ChatViews : public QObject {
+    Q_OBJECT
+public:
+    // Нові повідомлення видів ідуть через outbound — у порядку з рештою повідомлень чату
+    ChatViews(TelegramApi *telegram, OutboundQueue *outbound, QObject *parent = nullptr);
+
+    // Показує вид: редагує поточне повідомлення чату або надсилає нове
+    void show(qint64 chatId, const QString &text, const QJsonObject &inlineMarkup = QJsonObject());
+    // Відв'язує поточне повідомлення — наступний show() надішле нове
+    void detach(qint64 chatId);
+    // Робить вказане повідомлення поточним видом чату
+    void attach(qint64 chatId, qint64 messageId);
+
+    quint64 skippedUpdates() const { return m_skipped; }
+    QHash<qint64, qint64> messageIds() const;   // Чат -> повідомлення поточного виду (передача стану)
+
+private:
+    struct View {
+        qint64 messageId = 0;
+        size_t textHash = 0;
+        size_t markupHash = 0;
+        bool sending = false;        // sendMessage ще не повернув message_id
+        bool hasQueued = false;      // Новіший вміст, що чекає на message_id
+        QString queuedText;
+        QJsonObject queuedMarkup;
+    };
+
+    void sendNew(qint64 chatId, const QString &text, const QJsonObject &markup);
+    static size_t markupHashOf(const QJsonObject &markup);
+
+    TelegramApi *telegram;
+    OutboundQueue *outbound;
+    QHash<qint64, View> views;
+    quint64 m_skipped = 0;
+};
+
+#endif // CHATVIEWS_H
@@ -1,7 +1,27 @@
 #include "config.h"
+#include "loopmonitor.h"
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
+#include <QCoreApplication>
+#include <QFileSystemWatcher>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int hupSocket[2] = { -1, -1 };
+
+static void hupSignalHandler(int) {
+    char a = 1;
+    ssize_t written = ::write(hupSocket[0], &a, sizeof(a));  // Безпечно в обробнику сигналу
+    Q_UNUSED(written);
+}
+#endif
 
 Config::Config() {
     loadConfig();
@@ -12,26 +32,172 @@ Config& Config::instance() {
     return instance;
 }
 
-void Config::loadConfig() {
-    QSettings settings("config.ini", QSettings::IniFormat);
+QString Config::configPath() {
+    return QCoreApplication::applicationDirPath() + "/config/config.ini";
+}
+
+/**
+ * @brief Розбирає config.ini у новий знімок
+ */
+std::unique_ptr<ConfigSnapshot> ConfigSnapshot::fromFile(const QString &path) {
+    auto snapshot = std::make_unique<ConfigSnapshot>();
+    QSettings settings(path, QSettings::IniFormat);
+
+    settings.beginGroup("Telegram");
+    snapshot->botToken = settings.value("bot_token", "").toString();
+    snapshot->telegramApiUrl = settings.value("api_url", snapshot->telegramApiUrl).toString();
+    snapshot->pollTimeoutSec = settings.value("poll_timeout_sec", snapshot->pollTimeoutSec).toInt();
+    settings.endGroup();
 
     settings.beginGroup("Authorization");
-    m_useAuth = settings.value("use_auth", true).toBool();
+    snapshot->useAuth = settings.value("use_auth", true).toBool();
+    snapshot->adminId = settings.value("admin_id", snapshot->adminId).toString();
     settings.endGroup();
 
-    m_adminID = "722142144";  // Твій ID
+    // 🔹 Palantír: адреса та дедлайни запитів (мс)
+    settings.beginGroup("Palantir");
+    snapshot->palantirBaseUrl = settings.value("base_url", snapshot->palantirBaseUrl).toString();
+    snapshot->palantirSocket = settings.value("socket", snapshot->palantirSocket).toString();
+    snapshot->palantirSocketConnections = qMax(1, settings.value("socket_connections", snapshot->palantirSocketConnections).toInt());
+    snapshot->palantirSocketPipeline = qMax(1, settings.value("socket_pipeline", snapshot->palantirSocketPipeline).toInt());
+    snapshot->defaultTimeoutMs = settings.value("timeout_ms", snapshot->defaultTimeoutMs).toInt();
+    snapshot->endpointTimeoutsMs["clients"] = settings.value("timeout_clients_ms", snapshot->defaultTimeoutMs).toInt();
+    snapshot->endpointTimeoutsMs["azs_list"] = settings.value("timeout_azs_list_ms", 10000).toInt();
+    snapshot->endpointTimeoutsMs["terminal_info"] = settings.value("timeout_terminal_info_ms", snapshot->defaultTimeoutMs).toInt();
+    snapshot->endpointTimeoutsMs["reservoirs_info"] = settings.value("timeout_reservoirs_info_ms", snapshot->defaultTimeoutMs).toInt();
+    snapshot->endpointTimeoutsMs["posdatas"] = settings.value("timeout_posdatas_ms", snapshot->defaultTimeoutMs).toInt();
+    snapshot->hedging = settings.value("hedging", false).toBool();
+    snapshot->compression = settings.value("compression", snapshot->compression).toBool();
+    snapshot->breakerFailureThreshold = settings.value("breaker_failures", snapshot->breakerFailureThreshold).toInt();
+    snapshot->breakerOpenMs = settings.value("breaker_open_ms", snapshot->breakerOpenMs).toInt();
+    settings.endGroup();
 
-    qDebug() << "Authorization enabled:" << m_useAuth;
+    settings.beginGroup("Cache");
+    snapshot->cacheEntries = settings.value("entries", snapshot->cacheEntries).toInt();
+    snapshot->staleCacheTtlSec = settings.value("stale_ttl_sec", snapshot->staleCacheTtlSec).toInt();
+    snapshot->snapshotMaxAgeSec = settings.value("snapshot_max_age_sec", snapshot->snapshotMaxAgeSec).toInt();
+    snapshot->snapshotFlushSec = qMax(10, settings.value("snapshot_flush_sec", snapshot->snapshotFlushSec).toInt());
+    settings.endGroup();
+
+    settings.beginGroup("Limits");
+    snapshot->messageLimit = settings.value("message_limit", snapshot->messageLimit).toInt();
+    snapshot->broadcastRatePerSec = settings.value("broadcast_rate_per_sec", snapshot->broadcastRatePerSec).toInt();
+    snapshot->outboundCoalesceMs = settings.value("outbound_coalesce_ms", snapshot->outboundCoalesceMs).toInt();
+    snapshot->actionDeadlineSec = qMax(1, settings.value("action_deadline_sec", snapshot->actionDeadlineSec).toInt());
+    settings.endGroup();
+
+    settings.beginGroup("Admission");
+    snapshot->userRatePerMin = settings.value("user_rate_per_min", snapshot->userRatePerMin).toDouble();
+    snapshot->userBurst = settings.value("user_burst", snapshot->userBurst).toInt();
+    snapshot->chatRatePerMin = settings.value("chat_rate_per_min", snapshot->chatRatePerMin).toDouble();
+    snapshot->chatBurst = settings.value("chat_burst", snapshot->chatBurst).toInt();
+    snapshot->approvalCooldownSec = settings.value("approval_cooldown_sec", snapshot->approvalCooldownSec).toInt();
+    snapshot->maxBackendInFlight = settings.value("max_backend_in_flight", snapshot->maxBackendInFlight).toInt();
+    settings.endGroup();
+
+    settings.beginGroup("Pools");
+    snapshot->sweepConcurrency = settings.value("sweep_concurrency", snapshot->sweepConcurrency).toInt();
+    snapshot->sweepIntervalMin = settings.value("sweep_interval_min", snapshot->sweepIntervalMin).toInt();
+    snapshot->lookupConcurrency = settings.value("lookup_concurrency", snapshot->lookupConcurrency).toInt();
+    snapshot->lookupMaxTerminals = settings.value("lookup_max_terminals", snapshot->lookupMaxTerminals).toInt();
+    settings.endGroup();
+
+    settings.beginGroup("Batching");
+    snapshot->batchWindowMs = qMax(0, settings.value("window_ms", snapshot->batchWindowMs).toInt());
+    snapshot->batchMaxSize = qMax(1, settings.value("max_size", snapshot->batchMaxSize).toInt());
+    snapshot->batchEndpoints = settings.value("endpoints", snapshot->batchEndpoints).toStringList();
+    snapshot->batchBulk = settings.value("bulk", snapshot->batchBulk).toBool();
+    settings.endGroup();
+
+    settings.beginGroup("Monitor");
+    snapshot->lagProbeMs = settings.value("lag_probe_ms", snapshot->lagProbeMs).toInt();
+    snapshot->stallThresholdMs = settings.value("stall_threshold_ms", snapshot->stallThresholdMs).toInt();
+    snapshot->pollWatchdogSec = settings.value("poll_watchdog_sec", snapshot->pollWatchdogSec).toInt();
+    settings.endGroup();
+
+    settings.beginGroup("Handoff");
+    snapshot->handoffSocket = settings.value("socket_name", snapshot->handoffSocket).toString();
+    snapshot->handoffDrainSec = settings.value("drain_sec", snapshot->handoffDrainSec).toInt();
+    settings.endGroup();
+
+    settings.beginGroup("Digest");
+    snapshot->digestTime = settings.value("time", snapshot->digestTime).toString();
+    snapshot->digestWeekday = settings.value("weekly_day", snapshot->digestWeekday).toInt();
+    snapshot->rroValidDays = settings.value("rro_valid_days", snapshot->rroValidDays).toInt();
+    snapshot->rroWarnDays = settings.value("rro_warn_days", snapshot->rroWarnDays).toInt();
+    settings.endGroup();
+
+    settings.beginGroup("Logging");
+    snapshot->sevenZipPath = settings.value("seven_zip_path", "").toString();
+    snapshot->logRetentionDays = settings.value("log_retention_days", snapshot->logRetentionDays).toInt();
+    settings.endGroup();
+
+    return snapshot;
+}
+
+void Config::loadConfig() {
+    LoopMonitor::Activity activity("Config::loadConfig");
+    std::unique_ptr<const ConfigSnapshot> snapshot = ConfigSnapshot::fromFile(configPath());
+    const ConfigSnapshot *published = snapshot.get();
+
+    m_generations.push_back(std::move(snapshot));
+    m_current.store(published, std::memory_order_release);
+
+    qDebug() << "Authorization enabled:" << published->useAuth;
+}
+
+/**
+ * @brief Стежить за config.ini і SIGHUP, публікує новий знімок без перезапуску
+ */
+void Config::startWatching() {
+    if (m_watcher) {
+        return;
+    }
+
+    m_watcher = new QFileSystemWatcher(this);
+    m_watcher->addPath(configPath());
+
+    // 🔹 Редактори часто замінюють файл — тоді його треба додати у watcher знову
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &path) {
+        QTimer::singleShot(200, this, [this, path]() {
+            if (!m_watcher->files().contains(path) && QFileInfo::exists(path)) {
+                m_watcher->addPath(path);
+            }
+            qInfo() << "🔄 config.ini змінено, перечитуємо конфігурацію.";
+            loadConfig();
+            emit reloaded();
+        });
+    });
+
+#ifdef Q_OS_UNIX
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, hupSocket) == 0) {
+        m_hupNotifier = new QSocketNotifier(hupSocket[1], QSocketNotifier::Read, this);
+        connect(m_hupNotifier, &QSocketNotifier::activated, this, [this]() {
+            char a;
+            ssize_t received = ::read(hupSocket[1], &a, sizeof(a));
+            Q_UNUSED(received);
+            qInfo() << "🔄 SIGHUP: перечитуємо конфігурацію.";
+            loadConfig();
+            emit reloaded();
+        });
+
+        struct sigaction hup = {};
+        hup.sa_handler = hupSignalHandler;
+        sigemptyset(&hup.sa_mask);
+        hup.sa_flags = SA_RESTART;
+        ::sigaction(SIGHUP, &hup, nullptr);
+    } else {
+        qWarning() << "❌ Не вдалося створити socketpair для SIGHUP.";
+    }
+#endif
 }
 
 // Метод для отримання статусу авторизації
 bool Config::useAuth() const {
-    return m_useAuth;
+    return snapshot().useAuth;
 }
 
 // Метод для отримання ID адміна
 QString Config::getAdminID() const {
-    return m_adminID;
+    return snapshot().adminId;
 }
-
-
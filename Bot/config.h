@@ -1,30 +1,137 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QSettings>
+#include <QHash>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QFileSystemWatcher;
+class QSocketNotifier;
 
 void ensureAdminExists();
 
-class Config {
+/**
+ * @brief Незмінний типізований знімок конфігурації.
+ *
+ * Розбирається один раз із config/config.ini; при зміні файлу або SIGHUP
+ * створюється новий знімок, а старий лишається валідним для тих, хто його читає.
+ */
+struct ConfigSnapshot {
+    // [Telegram]
+    QString botToken;
+    QString telegramApiUrl = "https://api.telegram.org";
+    int pollTimeoutSec = 30;
+
+    // [Authorization]
+    bool useAuth = true;
+    QString adminId = "722142144";
+
+    // [Palantir]
+    QString palantirBaseUrl = "http://localhost:8181";
+    QString palantirSocket;                   // Unix domain socket Palantír на тому ж хості (порожньо — TCP)
+    int palantirSocketConnections = 4;        // Пул з'єднань через сокет
+    int palantirSocketPipeline = 4;           // Скільки pipelined-запитів може чекати на одному з'єднанні
+    int defaultTimeoutMs = 5000;
+    QHash<QString, int> endpointTimeoutsMs;   // Дедлайни окремих endpoint'ів
+    bool hedging = false;
+    bool compression = true;                  // Accept-Encoding gzip/deflate/zstd з власним розпакуванням
+    int breakerFailureThreshold = 5;
+    int breakerOpenMs = 30000;
+
+    // [Cache]
+    int cacheEntries = 500;                   // Скільки відповідей Palantír тримати для деградованого режиму
+    int staleCacheTtlSec = 24 * 60 * 60;      // Наскільки застарілі дані ще можна показувати
+    int snapshotMaxAgeSec = 7 * 24 * 60 * 60; // Найстаріші дані зі знімка на диску, які ще показуємо
+    int snapshotFlushSec = 300;               // Як часто дописувати знімок каталогу
+
+    // [Limits]
+    int messageLimit = 3500;                  // Довжина частини довгого повідомлення
+    int broadcastRatePerSec = 25;
+    int outboundCoalesceMs = 40;              // Вікно злиття вихідних повідомлень чату (0 — без затримки)
+    int actionDeadlineSec = 20;               // Скільки дія користувача може чекати на Palantír
+
+    // [Admission]
+    double userRatePerMin = 20;               // Поповнення token bucket користувача
+    int userBurst = 10;
+    double chatRatePerMin = 30;
+    int chatBurst = 15;
+    int approvalCooldownSec = 600;            // Як часто невідомий користувач може просити доступ
+    int maxBackendInFlight = 64;              // Вище — скидаємо навантаження (0 — без обмеження)
+
+    // [Pools]
+    int sweepConcurrency = 4;
+    int sweepIntervalMin = 15;
+    int lookupConcurrency = 4;                // Паралельні запити пакетного пошуку терміналів
+    int lookupMaxTerminals = 50;              // Найбільше терміналів в одному пакеті
+
+    // [Batching]
+    int batchWindowMs = 5;                    // Вікно збору запитів в один пакет (0 — без пакетування)
+    int batchMaxSize = 50;                    // Найбільше терміналів в одному пакеті
+    QStringList batchEndpoints = { "terminal_info" };   // Endpoint'и, запити до яких збираються в пакети
+    bool batchBulk = true;                    // Бекенд має <endpoint>_batch; інакше — конвеєр окремих запитів
+
+    // [Monitor]
+    int lagProbeMs = 10;                      // Інтервал проби затримки циклу подій
+    int stallThresholdMs = 250;               // Затримка, яка вважається зависанням
+    int pollWatchdogSec = 60;                 // Запас понад poll_timeout, після якого long poll перезапускається
+
+    // [Handoff]
+    QString handoffSocket = "shadowfax-handoff";   // Ім'я локального сокета передачі стану
+    int handoffDrainSec = 20;                 // Скільки старий процес дочищає черги після передачі
+
+    // [Digest]
+    QString digestTime = "08:00";             // Коли надсилати зведення (HH:mm, місцевий час)
+    int digestWeekday = 1;                    // День щотижневих зведень (1 — понеділок)
+    int rroValidDays = 365;                   // Скільки діє реєстрація РРО від datreg
+    int rroWarnDays = 30;                     // За скільки днів до закінчення попереджати
+
+    // [Logging]
+    QString sevenZipPath;
+    int logRetentionDays = 7;
+
+    int backendTimeoutMs(const QString &endpoint) const {
+        return endpointTimeoutsMs.value(endpoint, defaultTimeoutMs);
+    }
+
+    static std::unique_ptr<ConfigSnapshot> fromFile(const QString &path);
+};
+
+class Config : public QObject {
+    Q_OBJECT
 public:
     static Config& instance();  // Синглтон
-    void loadConfig();          // Завантаження конфігурації
+    void loadConfig();          // Завантаження конфігурації (новий знімок)
+    void startWatching();       // Перезавантаження при зміні файлу або SIGHUP
+
+    // 🔹 Поточний знімок: читається без блокувань
+    const ConfigSnapshot &snapshot() const { return *m_current.load(std::memory_order_acquire); }
+    static const ConfigSnapshot &current() { return instance().snapshot(); }
+    static QString configPath();
 
     bool useAuth() const;       // Чи включена авторизація
     QString getAdminID() const; // ID адміністратора за замовчуванням
 
+signals:
+    void reloaded();            // Опубліковано новий знімок
+
 private:
     Config();  // Приватний конструктор для синглтона
     ~Config() = default;
 
     bool isUserAuthorized(const QString& userId);
 
+    std::atomic<const ConfigSnapshot *> m_current{nullptr};
+    // Усі опубліковані знімки живуть до кінця процесу: перезавантаження рідкісні,
+    // а читач може тримати посилання на старий знімок без лічильників посилань
+    std::vector<std::unique_ptr<const ConfigSnapshot>> m_generations;
 
-    bool m_useAuth;   // Флаг авторизації
-    QString m_adminID; // ID адміна за замовчуванням
-
-
+    QFileSystemWatcher *m_watcher = nullptr;
+    QSocketNotifier *m_hupNotifier = nullptr;
 };
 
 #endif // CONFIG_H
@@ -0,0 +1,215 @@
+#include "contentdecoder.h"
+#include <QByteArrayList>
+
+#ifdef SHADOWFAX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SHADOWFAX_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static const int kOutChunk = 64 * 1024;
+
+struct ContentDecoder::Streams {
+#ifdef SHADOWFAX_HAVE_ZLIB
+    z_stream zlib = {};
+    bool zlibReady = false;
+    bool zlibRawTried = false;   // Деякі сервери шлють «deflate» без zlib-заголовка
+    QByteArray zlibConsumed;     // Початок потоку для повтору в raw-режимі
+#endif
+#ifdef SHADOWFAX_HAVE_ZSTD
+    ZSTD_DStream *zstd = nullptr;
+    size_t zstdHint = 0;         // 0 — кадр zstd завершено
+#endif
+};
+
+ContentDecoder::ContentDecoder(const QByteArray &contentEncoding)
+    : m_streams(std::make_unique<Streams>()) {
+    QByteArray encoding = contentEncoding.trimmed().toLower();
+
+    if (encoding.isEmpty() || encoding == "identity") {
+        m_encoding = Encoding::Identity;
+    } else if (encoding == "gzip" || encoding == "x-gzip" || encoding == "deflate") {
+        m_encoding = Encoding::Unsupported;
+#ifdef SHADOWFAX_HAVE_ZLIB
+        // 15 + 32: автоматичне визначення заголовка gzip або zlib
+        if (inflateInit2(&m_streams->zlib, 15 + 32) == Z_OK) {
+            m_streams->zlibReady = true;
+            m_encoding = Encoding::Zlib;
+        }
+#endif
+    } else if (encoding == "zstd") {
+        m_encoding = Encoding::Unsupported;
+#ifdef SHADOWFAX_HAVE_ZSTD
+        m_streams->zstd = ZSTD_createDStream();
+        if (m_streams->zstd) {
+            ZSTD_initDStream(m_streams->zstd);
+            m_encoding = Encoding::Zstd;
+        }
+#endif
+    } else {
+        m_encoding = Encoding::Unsupported;
+    }
+
+    if (m_encoding == Encoding::Unsupported) {
+        m_error = "Unsupported Content-Encoding: " + QString::fromLatin1(encoding);
+    }
+}
+
+ContentDecoder::~ContentDecoder() {
+#ifdef SHADOWFAX_HAVE_ZLIB
+    if (m_streams->zlibReady) {
+        inflateEnd(&m_streams->zlib);
+    }
+#endif
+#ifdef SHADOWFAX_HAVE_ZSTD
+    if (m_streams->zstd) {
+        ZSTD_freeDStream(m_streams->zstd);
+    }
+#endif
+}
+
+bool ContentDecoder::isAvailable() {
+#if defined(SHADOWFAX_HAVE_ZLIB) || defined(SHADOWFAX_HAVE_ZSTD)
+    return true;
+#else
+    return false;
+#endif
+}
+
+QByteArray ContentDecoder::acceptEncoding() {
+    QByteArrayList encodings;
+#ifdef SHADOWFAX_HAVE_ZSTD
+    encodings << "zstd";
+#endif
+#ifdef SHADOWFAX_HAVE_ZLIB
+    encodings << "gzip" << "deflate";
+#endif
+    encodings << "identity";
+    return encodings.join(", ");
+}
+
+bool ContentDecoder::isSupported() const {
+    return m_encoding != Encoding::Unsupported;
+}
+
+/**
+ * @brief Розпаковує чергову частину потоку
+ * @param chunk Стиснені байти з мережі
+ * @param out Буфер, у кінець якого дописуються розпаковані дані
+ * @return false у разі пошкодженого потоку або непідтримуваного кодування
+ */
+bool ContentDecoder::decode(const QByteArray &chunk, QByteArray &out) {
+    if (!m_error.isEmpty()) {
+        return false;
+    }
+    m_encodedBytes += chunk.size();
+    const qsizetype before = out.size();
+
+    switch (m_encoding) {
+    case Encoding::Identity:
+        out += chunk;
+        break;
+
+    case Encoding::Zlib: {
+#ifdef SHADOWFAX_HAVE_ZLIB
+        z_stream &zs = m_streams->zlib;
+        if (!m_streams->zlibRawTried && zs.total_out == 0) {
+            m_streams->zlibConsumed += chunk;
+        }
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(chunk.constData()));
+        zs.avail_in = uInt(chunk.size());
+
+        while (zs.avail_in > 0 && !m_finished) {
+            qsizetype offset = out.size();
+            out.resize(offset + kOutChunk);
+            zs.next_out = reinterpret_cast<Bytef *>(out.data() + offset);
+            zs.avail_out = kOutChunk;
+
+            int rc = inflate(&zs, Z_NO_FLUSH);
+            out.resize(offset + (kOutChunk - qsizetype(zs.avail_out)));
+
+            if (rc == Z_STREAM_END) {
+                m_finished = true;
+            } else if (rc == Z_DATA_ERROR && !m_streams->zlibRawTried && zs.total_out == 0) {
+                // 🔹 «deflate» без заголовка: починаємо спочатку в raw-режимі
+                m_streams->zlibRawTried = true;
+                QByteArray replay = m_streams->zlibConsumed;
+                m_streams->zlibConsumed.clear();
+                inflateEnd(&zs);
+                zs = z_stream();
+                if (inflateInit2(&zs, -15) != Z_OK) {
+                    m_streams->zlibReady = false;
+                    m_error = "inflateInit2 failed";
+                    return false;
+                }
+                m_encodedBytes -= replay.size();  // Байти буде пораховано повторно
+                out.resize(before);
+                return decode(replay, out);
+            } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                m_error = QString("inflate error %1: %2").arg(rc).arg(zs.msg ? zs.msg : "");
+                return false;
+            }
+        }
+        if (zs.total_out > 0) {
+            m_streams->zlibConsumed.clear();  // Формат підтверджено — повтор більше не потрібен
+        }
+#endif
+        break;
+    }
+
+    case Encoding::Zstd: {
+#ifdef SHADOWFAX_HAVE_ZSTD
+        ZSTD_inBuffer input = { chunk.constData(), size_t(chunk.size()), 0 };
+        while (input.pos < input.size) {
+            qsizetype offset = out.size();
+            out.resize(offset + kOutChunk);
+            ZSTD_outBuffer output = { out.data() + offset, size_t(kOutChunk), 0 };
+
+            size_t rc = ZSTD_decompressStream(m_streams->zstd, &output, &input);
+            out.resize(offset + qsizetype(output.pos));
+
+            if (ZSTD_isError(rc)) {
+                m_error = QString("zstd error: %1").arg(ZSTD_getErrorName(rc));
+                return false;
+            }
+            m_streams->zstdHint = rc;
+        }
+#endif
+        break;
+    }
+
+    case Encoding::Unsupported:
+        return false;
+    }
+
+    m_decodedBytes += out.size() - before;
+    return true;
+}
+
+bool ContentDecoder::finish() {
+    if (!m_error.isEmpty()) {
+        return false;
+    }
+
+    switch (m_encoding) {
+    case Encoding::Zlib:
+        if (!m_finished && m_encodedBytes > 0) {
+            m_error = "Truncated deflate stream";
+            return false;
+        }
+        break;
+    case Encoding::Zstd:
+#ifdef SHADOWFAX_HAVE_ZSTD
+        if (m_streams->zstdHint != 0) {
+            m_error = "Truncated zstd frame";
+            return false;
+        }
+#endif
+        break;
+    case Encoding::Identity:
+    case Encoding::Unsupported:
+        break;
+    }
+    return true;
+}
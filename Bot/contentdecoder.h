@@ -0,0 +1,43 @@
+#ifndef CONTENTDECODER_H
+#define CONTENTDECODER_H
+
+#include <QByteArray>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief Потокове розпакування тіла HTTP-відповіді (Content-Encoding).
+ *
+ * Підтримує gzip і deflate (zlib) та zstd, якщо бібліотеки доступні під час
+ * збирання. Дані подаються частинами з readyRead — весь стиснений документ
+ * у пам'яті не тримається.
+ */
+class ContentDecoder {
+public:
+    explicit ContentDecoder(const QByteArray &contentEncoding);
+    ~ContentDecoder();
+
+    static bool isAvailable();              // Чи зібрано хоча б один декодер
+    static QByteArray acceptEncoding();     // Значення заголовка Accept-Encoding для цієї збірки
+
+    bool isSupported() const;               // Чи вміємо розпакувати вказане кодування
+    bool decode(const QByteArray &chunk, QByteArray &out);  // Дописує розпаковане в out
+    bool finish();                          // Потік закінчився: перевіряє цілісність
+    QString errorString() const { return m_error; }
+
+    qint64 encodedBytes() const { return m_encodedBytes; }
+    qint64 decodedBytes() const { return m_decodedBytes; }
+
+private:
+    enum class Encoding { Identity, Zlib, Zstd, Unsupported };
+    struct Streams;
+
+    Encoding m_encoding = Encoding::Identity;
+    std::unique_ptr<Streams> m_streams;
+    bool m_finished = false;
+    QString m_error;
+    qint64 m_encodedBytes = 0;
+    qint64 m_decodedBytes = 0;
+};
+
+#endif // CONTENTDECODER_H
@@ -0,0 +1,494 @@
+#include "digestscheduler.h"
+#include "config.h"
+#include "loopmonitor.h"
+#include "renderers.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QFile>
+#include <QDateTime>
+#include <QUrlQuery>
+#include <QDebug>
+
+static QString kindName(DigestScheduler::Kind kind) {
+    return kind == DigestScheduler::Kind::AzsChanges ? "azs" : "rro";
+}
+
+static QString periodName(DigestScheduler::Period period) {
+    return period == DigestScheduler::Period::Daily ? "daily" : "weekly";
+}
+
+static QString stationsKey(qint64 clientId, DigestScheduler::Period period) {
+    return QString("%1:%2").arg(clientId).arg(periodName(period));
+}
+
+DigestScheduler::DigestScheduler(PalantirGateway *palantir, PalantirClient *client, const QString &stateDir, QObject *parent)
+    : QObject(parent), palantir(palantir), client(client) {
+    statePath = stateDir + "/digest_state.json";
+    subscriptionsPath = stateDir + "/digests.json";
+
+    loadState();
+    loadSubscriptions();
+
+    runTimer.setSingleShot(true);
+    runTimer.setTimerType(Qt::PreciseTimer);   // Грубий таймер може спрацювати раніше і запланувати той самий запуск ще раз
+    connect(&runTimer, &QTimer::timeout, this, [this]() {
+        run();
+        schedule();
+    });
+    connect(&sendTimer, &QTimer::timeout, this, &DigestScheduler::sendNext);
+}
+
+void DigestScheduler::start() {
+    schedule();
+}
+
+void DigestScheduler::stop() {
+    runTimer.stop();
+}
+
+/**
+ * @brief Ставить таймер на найближчий [Digest] time (сьогодні або завтра)
+ */
+void DigestScheduler::schedule() {
+    QTime at = QTime::fromString(Config::current().digestTime, "HH:mm");
+    if (!at.isValid()) {
+        qWarning() << "❌ Некоректний [Digest] time:" << Config::current().digestTime << "— використовуємо 08:00";
+        at = QTime(8, 0);
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    QDateTime next(now.date(), at);
+    if (next <= now) {
+        next = next.addDays(1);
+    }
+
+    runTimer.start(int(now.msecsTo(next)));
+    qDebug() << "📰 Наступні зведення:" << next.toString("dd.MM.yyyy HH:mm");
+}
+
+bool DigestScheduler::isDue(const Subscription &sub, bool all) const {
+    return sub.period == Period::Daily || all
+        || QDate::currentDate().dayOfWeek() == Config::current().digestWeekday;
+}
+
+/**
+ * @brief Один запуск: дані кожного клієнта запитуються один раз для всіх його підписників
+ * @param all true — сформувати і щотижневі зведення, навіть якщо сьогодні не їхній день
+ */
+void DigestScheduler::run(bool all) {
+    if (running) {
+        return;
+    }
+
+    due.clear();
+    clients.clear();
+    for (const Subscription &sub : subscriptions) {
+        if (!isDue(sub, all)) {
+            continue;
+        }
+        due.append(sub);
+
+        ClientRun &clientRun = clients[sub.clientId];
+        if (sub.kind == Kind::AzsChanges) {
+            clientRun.azs[int(sub.period)] = true;
+        } else {
+            clientRun.rro = true;
+        }
+    }
+
+    if (due.isEmpty()) {
+        qDebug() << "📰 Зведень на сьогодні немає.";
+        return;
+    }
+
+    running = true;
+    concurrency = qMax(1, Config::current().sweepConcurrency);
+    qInfo() << "📰 Формуємо" << due.size() << "зведень для" << clients.size() << "клієнтів.";
+
+    // 🔹 Лічильник — до першого запиту: шлюз може відповісти синхронно (запобіжник відкритий),
+    //    і finishIfIdle() не повинен завершити запуск, поки не запитано всіх клієнтів
+    const QList<qint64> clientIds = clients.keys();
+    pendingLists = int(clientIds.size());
+    for (qint64 clientId : clientIds) {
+        fetchClient(clientId);
+    }
+}
+
+void DigestScheduler::fetchClient(qint64 clientId) {
+    QUrlQuery query;
+    query.addQueryItem("client_id", QString::number(clientId));
+
+    ++m_fetchedClients;
+    palantir->get("azs_list", query, [this, clientId](const PalantirResponse &response) {
+        --pendingLists;
+        onStations(clientId, response);
+        pump();
+        finishIfIdle();
+    });
+}
+
+void DigestScheduler::onStations(qint64 clientId, const PalantirResponse &response) {
+    LoopMonitor::Activity activity("DigestScheduler::onStations");
+    ClientRun &clientRun = clients[clientId];
+    const QString unavailable = QString("📰 <b>%1</b>\n⚠️ Список АЗС зараз недоступний, зведення пропущено.")
+                                    .arg(clientTitle(clientId));
+
+    if (!response.ok) {
+        for (int period = 0; period < 2; ++period) {
+            if (clientRun.azs[period]) {
+                clientRun.azsParts[period] = QStringList{ unavailable };
+            }
+        }
+        if (clientRun.rro) {
+            clientRun.rroParts = QStringList{ unavailable };
+        }
+        return;
+    }
+
+    const QJsonArray azsList = QJsonDocument::fromJson(response.body).object()["azs_list"].toArray();
+    for (const QJsonValue &azs : azsList) {
+        const QJsonObject obj = azs.toObject();
+        clientRun.stations.insert(obj["terminal_id"].toInt(), obj["name"].toString());
+    }
+
+    // 🔹 Застарілий список з кешу не порівнюємо: він дав би хибні зміни
+    for (int period = 0; period < 2; ++period) {
+        if (!clientRun.azs[period]) {
+            continue;
+        }
+        if (response.fromCache) {
+            clientRun.azsParts[period] = QStringList{ unavailable };
+        } else {
+            renderAzs(clientId, Period(period), clientRun);
+        }
+    }
+
+    if (clientRun.rro) {
+        for (auto it = clientRun.stations.cbegin(); it != clientRun.stations.cend(); ++it) {
+            posdatasQueue.enqueue(qMakePair(clientId, it.key()));
+        }
+        clientRun.pendingPosdatas = clientRun.stations.size();
+        if (clientRun.pendingPosdatas == 0) {
+            renderRro(clientId, clientRun);
+        }
+    }
+}
+
+/**
+ * @brief Запускає наступні запити posdatas у межах бюджету паралельності
+ */
+void DigestScheduler::pump() {
+    while (inFlight < concurrency && !posdatasQueue.isEmpty()) {
+        const QPair<qint64, int> task = posdatasQueue.dequeue();
+        ++inFlight;
+
+        client->posdatas(task.first, task.second)
+            .then(this, [this, task](const PalantirClient::PosDatasResult &result) {
+            --inFlight;
+            onPosdatas(task.first, task.second, result);
+            pump();
+            finishIfIdle();
+        });
+    }
+}
+
+void DigestScheduler::onPosdatas(qint64 clientId, int terminalId, const PalantirClient::PosDatasResult &result) {
+    ClientRun &clientRun = clients[clientId];
+    const ConfigSnapshot &config = Config::current();
+    const QDate today = QDate::currentDate();
+
+    if (result.ok()) {
+        for (const Palantir::PosData &pos : result.value) {
+            const QDate registeredAt = parseRegistrationDate(pos.registeredAt);
+            if (!registeredAt.isValid()) {
+                continue;
+            }
+
+            const QDate expiresAt = registeredAt.addDays(config.rroValidDays);
+            const qint64 daysLeft = today.daysTo(expiresAt);
+            if (daysLeft > config.rroWarnDays) {
+                continue;
+            }
+
+            const QString left = daysLeft < 0 ? QString("⚠️ прострочено %1 дн. тому").arg(-daysLeft)
+                                              : QString("залишилось %1 дн.").arg(daysLeft);
+            clientRun.expiring.insert(daysLeft, QString("🔹 <b>%1</b> %2 · каса №%3 (ЗН %4): до %5, %6\n")
+                                                    .arg(terminalId)
+                                                    .arg(clientRun.stations.value(terminalId).toHtmlEscaped())
+                                                    .arg(pos.posId)
+                                                    .arg(pos.factoryNumber.toHtmlEscaped())
+                                                    .arg(expiresAt.toString("dd.MM.yyyy"), left));
+        }
+    } else {
+        ++clientRun.failedTerminals;
+    }
+
+    if (--clientRun.pendingPosdatas == 0) {
+        renderRro(clientId, clientRun);
+    }
+}
+
+/**
+ * @brief Зміни списку АЗС відносно попереднього зведення того ж періоду
+ */
+void DigestScheduler::renderAzs(qint64 clientId, Period period, ClientRun &clientRun) {
+    const QString key = stationsKey(clientId, period);
+    const QMap<int, QString> &current = clientRun.stations;
+    QStringList lines;
+
+    if (!lastStations.contains(key)) {
+        lines.append(QString("ℹ️ Збережено поточний список: %1 АЗС. Зміни — з наступного зведення.\n")
+                         .arg(current.size()));
+    } else {
+        const QMap<int, QString> previous = lastStations.value(key);
+        for (auto it = current.cbegin(); it != current.cend(); ++it) {
+            if (!previous.contains(it.key())) {
+                lines.append(QString("➕ <b>%1</b> %2\n").arg(it.key()).arg(it.value().toHtmlEscaped()));
+            } else if (previous.value(it.key()) != it.value()) {
+                lines.append(QString("✏️ <b>%1</b> %2 → %3\n").arg(it.key())
+                                 .arg(previous.value(it.key()).toHtmlEscaped(), it.value().toHtmlEscaped()));
+            }
+        }
+        for (auto it = previous.cbegin(); it != previous.cend(); ++it) {
+            if (!current.contains(it.key())) {
+                lines.append(QString("➖ <b>%1</b> %2\n").arg(it.key()).arg(it.value().toHtmlEscaped()));
+            }
+        }
+        if (lines.isEmpty()) {
+            lines.append(QString("✅ Без змін, %1 АЗС.\n").arg(current.size()));
+        }
+    }
+
+    lastStations.insert(key, current);
+    stateDirty = true;
+
+    const QString title = QString("📰 <b>Зміни списку АЗС · %1</b> (%2)\n\n").arg(clientTitle(clientId), periodTitle(period));
+    clientRun.azsParts[int(period)] = Renderers::chunked(lines, title, "📰 <b>Зміни списку АЗС (продовження)</b>\n\n",
+                                                         Config::current().messageLimit);
+}
+
+/**
+ * @brief Каси, реєстрація яких закінчується протягом rro_warn_days або вже закінчилась
+ */
+void DigestScheduler::renderRro(qint64 clientId, ClientRun &clientRun) {
+    QStringList lines = clientRun.expiring.values();
+    if (lines.isEmpty()) {
+        lines.append(QString("✅ Протягом %1 дн. реєстрація жодної каси не закінчується.\n")
+                         .arg(Config::current().rroWarnDays));
+    }
+    if (clientRun.failedTerminals > 0) {
+        lines.append(QString("\n❌ Не вдалося отримати каси %1 терміналів.\n").arg(clientRun.failedTerminals));
+    }
+
+    const QString title = QString("📰 <b>Реєстрація РРО · %1</b>\n\n").arg(clientTitle(clientId));
+    clientRun.rroParts = Renderers::chunked(lines, title, "📰 <b>Реєстрація РРО (продовження)</b>\n\n",
+                                            Config::current().messageLimit);
+}
+
+/**
+ * @brief Коли всі дані отримано — розкладає готові тексти по підписниках у чергу відправки
+ */
+void DigestScheduler::finishIfIdle() {
+    if (!running || pendingLists > 0 || inFlight > 0 || !posdatasQueue.isEmpty()) {
+        return;
+    }
+
+    for (const Subscription &sub : std::as_const(due)) {
+        const ClientRun &clientRun = clients[sub.clientId];
+        const QStringList &parts = sub.kind == Kind::AzsChanges ? clientRun.azsParts[int(sub.period)]
+                                                                : clientRun.rroParts;
+        for (const QString &part : parts) {
+            outbox.enqueue(Delivery{sub.chatId, part});
+        }
+    }
+
+    if (stateDirty) {
+        saveState();
+        stateDirty = false;
+    }
+
+    const int clientCount = clients.size();
+    const int recipients = due.size();
+    running = false;
+    clients.clear();
+    due.clear();
+    qInfo() << "📰 Зведення сформовано:" << clientCount << "клієнтів," << outbox.size() << "повідомлень у черзі.";
+    emit runFinished(clientCount, recipients);
+
+    if (!outbox.isEmpty() && !sendTimer.isActive()) {
+        sendTimer.start(qMax(1, 1000 / qMax(1, Config::current().broadcastRatePerSec)));
+    }
+}
+
+/**
+ * @brief Одне повідомлення за тік — не частіше broadcast_rate_per_sec
+ */
+void DigestScheduler::sendNext() {
+    if (outbox.isEmpty()) {
+        sendTimer.stop();
+        return;
+    }
+
+    const Delivery delivery = outbox.dequeue();
+    ++m_delivered;
+    emit deliver(delivery.chatId, delivery.text);
+}
+
+QString DigestScheduler::clientTitle(qint64 clientId) const {
+    const QString name = index ? index->clientName(clientId) : QString();
+    return name.isEmpty() ? QString("Клієнт %1").arg(clientId) : name.toHtmlEscaped();
+}
+
+void DigestScheduler::subscribe(qint64 chatId, qint64 clientId, Kind kind, Period period) {
+    for (Subscription &sub : subscriptions) {
+        if (sub.chatId == chatId && sub.clientId == clientId && sub.kind == kind) {
+            if (sub.period != period) {
+                sub.period = period;
+                saveSubscriptions();
+            }
+            return;
+        }
+    }
+    subscriptions.append(Subscription{chatId, clientId, kind, period});
+    saveSubscriptions();
+}
+
+/**
+ * @param clientId 0 — підписки на всіх клієнтів
+ */
+int DigestScheduler::unsubscribe(qint64 chatId, qint64 clientId, const QList<Kind> &kinds) {
+    const int removed = subscriptions.removeIf([&](const Subscription &sub) {
+        return sub.chatId == chatId && (clientId == 0 || sub.clientId == clientId) && kinds.contains(sub.kind);
+    });
+    if (removed > 0) {
+        saveSubscriptions();
+    }
+    return removed;
+}
+
+QList<DigestScheduler::Subscription> DigestScheduler::subscriptionsOf(qint64 chatId) const {
+    QList<Subscription> result;
+    for (const Subscription &sub : subscriptions) {
+        if (sub.chatId == chatId) {
+            result.append(sub);
+        }
+    }
+    return result;
+}
+
+bool DigestScheduler::kindFromName(const QString &name, Kind *kind) {
+    if (name == "azs") {
+        *kind = Kind::AzsChanges;
+    } else if (name == "rro") {
+        *kind = Kind::RroExpiry;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool DigestScheduler::periodFromName(const QString &name, Period *period) {
+    if (name == "daily") {
+        *period = Period::Daily;
+    } else if (name == "weekly") {
+        *period = Period::Weekly;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString DigestScheduler::kindTitle(Kind kind) {
+    return kind == Kind::AzsChanges ? "зміни списку АЗС" : "закінчення реєстрації РРО";
+}
+
+QString DigestScheduler::periodTitle(Period period) {
+    return period == Period::Daily ? "щодня" : "щотижня";
+}
+
+QDate DigestScheduler::parseRegistrationDate(const QString &text) {
+    const QString date = text.trimmed().left(10);
+    QDate parsed = QDate::fromString(date, Qt::ISODate);
+    if (!parsed.isValid()) {
+        parsed = QDate::fromString(date, "dd.MM.yyyy");
+    }
+    return parsed;
+}
+
+void DigestScheduler::loadState() {
+    QFile file(statePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const QJsonObject state = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = state.constBegin(); it != state.constEnd(); ++it) {
+        QMap<int, QString> stations;
+        const QJsonObject obj = it.value().toObject();
+        for (auto s = obj.constBegin(); s != obj.constEnd(); ++s) {
+            stations.insert(s.key().toInt(), s.value().toString());
+        }
+        lastStations.insert(it.key(), stations);
+    }
+}
+
+void DigestScheduler::saveState() const {
+    QJsonObject state;
+    for (auto it = lastStations.cbegin(); it != lastStations.cend(); ++it) {
+        QJsonObject obj;
+        for (auto s = it.value().cbegin(); s != it.value().cend(); ++s) {
+            obj[QString::number(s.key())] = s.value();
+        }
+        state[it.key()] = obj;
+    }
+
+    QSaveFile file(statePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "❌ Не вдалося зберегти стан зведень:" << statePath;
+        return;
+    }
+    file.write(QJsonDocument(state).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+void DigestScheduler::loadSubscriptions() {
+    QFile file(subscriptionsPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    for (const QJsonValue &val : QJsonDocument::fromJson(file.readAll()).array()) {
+        const QJsonObject obj = val.toObject();
+        Kind kind;
+        Period period;
+        if (!kindFromName(obj["kind"].toString(), &kind) || !periodFromName(obj["period"].toString(), &period)) {
+            continue;
+        }
+        subscriptions.append(Subscription{
+            obj["chat_id"].toVariant().toLongLong(),
+            obj["client_id"].toVariant().toLongLong(),
+            kind,
+            period
+        });
+    }
+}
+
+void DigestScheduler::saveSubscriptions() const {
+    QJsonArray array;
+    for (const Subscription &sub : subscriptions) {
+        array.append(QJsonObject{
+            {"chat_id", sub.chatId},
+            {"client_id", sub.clientId},
+            {"kind", kindName(sub.kind)},
+            {"period", periodName(sub.period)}
+        });
+    }
+
+    QSaveFile file(subscriptionsPath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(array).toJson());
+        file.commit();
+    }
+}
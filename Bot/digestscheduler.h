@@ -0,0 +1,123 @@
+#ifndef DIGESTSCHEDULER_H
+#define DIGESTSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QQueue>
+#include <QHash>
+#include <QMap>
+#include <QDate>
+#include <QPair>
+#include "palantirgateway.h"
+#include "palantirclient.h"
+#include "fleetindex.h"
+
+/**
+ * @brief Щоденні та щотижневі зведення по клієнтах у заданий час.
+ *
+ * Під час запуску підписки групуються за клієнтом: azs_list і posdatas
+ * кожного клієнта запитуються один раз, текст зведення формується один раз
+ * і розходиться всім його підписникам. Відправка — через чергу з темпом
+ * broadcast_rate_per_sec, а не окремим запитом і відправкою на кожного.
+ */
+class DigestScheduler : public QObject {
+    Q_OBJECT
+public:
+    enum class Kind { AzsChanges, RroExpiry };   // Зміни списку АЗС; закінчення реєстрації РРО
+    enum class Period { Daily, Weekly };
+
+    struct Subscription {
+        qint64 chatId;
+        qint64 clientId;
+        Kind kind;
+        Period period;
+    };
+
+    DigestScheduler(PalantirGateway *palantir, PalantirClient *client, const QString &stateDir, QObject *parent = nullptr);
+
+    void start();                     // Планує наступний запуск на [Digest] time
+    void stop();                      // Поточний запуск і відправка завершаться, нових не буде
+    void run(bool all = false);       // Один запуск; all — і щотижневі підписки поза їхнім днем
+    bool isRunning() const { return running; }
+    bool isIdle() const { return !running && outbox.isEmpty(); }   // Усе сформовано і передано на відправку
+
+    void subscribe(qint64 chatId, qint64 clientId, Kind kind, Period period);   // Замінює період наявної підписки
+    int unsubscribe(qint64 chatId, qint64 clientId, const QList<Kind> &kinds);  // Скільки підписок знято
+    QList<Subscription> subscriptionsOf(qint64 chatId) const;
+
+    void setIndex(FleetIndex *fleetIndex) { index = fleetIndex; }   // Назви клієнтів для заголовків
+
+    quint64 fetchedClients() const { return m_fetchedClients; }     // Клієнтів, дані яких запитано
+    quint64 deliveredDigests() const { return m_delivered; }
+
+    static bool kindFromName(const QString &name, Kind *kind);       // azs | rro
+    static bool periodFromName(const QString &name, Period *period); // daily | weekly
+    static QString kindTitle(Kind kind);
+    static QString periodTitle(Period period);
+    static QDate parseRegistrationDate(const QString &text);        // datreg: ISO або dd.MM.yyyy
+
+signals:
+    void deliver(qint64 chatId, const QString &text);
+    void runFinished(int clients, int recipients);
+
+private:
+    // 🔹 Дані одного клієнта в межах запуску — спільні для всіх його підписників
+    struct ClientRun {
+        bool azs[2] = { false, false };    // Потрібне зведення змін АЗС (за Period)
+        bool rro = false;                  // Потрібне зведення РРО
+        QMap<int, QString> stations;       // terminal_id -> назва з azs_list
+        int pendingPosdatas = 0;
+        int failedTerminals = 0;
+        QMultiMap<qint64, QString> expiring;   // Днів до закінчення -> рядок зведення РРО
+        QStringList azsParts[2];           // Готовий текст частинами до messageLimit (за Period)
+        QStringList rroParts;
+    };
+
+    struct Delivery {
+        qint64 chatId;
+        QString text;
+    };
+
+    void schedule();
+    void fetchClient(qint64 clientId);
+    void onStations(qint64 clientId, const PalantirResponse &response);
+    void pump();
+    void onPosdatas(qint64 clientId, int terminalId, const PalantirClient::PosDatasResult &result);
+    void renderAzs(qint64 clientId, Period period, ClientRun &clientRun);
+    void renderRro(qint64 clientId, ClientRun &clientRun);
+    void finishIfIdle();
+    void sendNext();
+    QString clientTitle(qint64 clientId) const;
+    bool isDue(const Subscription &sub, bool all) const;
+
+    void loadState();
+    void saveState() const;
+    void loadSubscriptions();
+    void saveSubscriptions() const;
+
+    PalantirGateway *palantir;
+    PalantirClient *client;
+    FleetIndex *index = nullptr;
+    QString statePath;                 // Попередній azs_list клієнтів для обчислення змін
+    QString subscriptionsPath;
+    QTimer runTimer;
+    QTimer sendTimer;
+
+    QList<Subscription> subscriptions;
+    QHash<QString, QMap<int, QString>> lastStations;   // "client:period" -> azs_list на момент останнього зведення
+    bool stateDirty = false;
+
+    bool running = false;
+    QList<Subscription> due;                     // Підписки поточного запуску
+    QHash<qint64, ClientRun> clients;
+    QQueue<QPair<qint64, int>> posdatasQueue;   // (клієнт, термінал)
+    int concurrency = 4;
+    int inFlight = 0;
+    int pendingLists = 0;
+    QQueue<Delivery> outbox;
+
+    quint64 m_fetchedClients = 0;
+    quint64 m_delivered = 0;
+};
+
+#endif // DIGESTSCHEDULER_H
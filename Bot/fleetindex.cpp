@@ -0,0 +1,392 @@
+#include "fleetindex.h"
+#include <QElapsedTimer>
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+static const int kCompactMinDead = 1024;   // Менше мертвих рядків не варто переписувати
+
+// 🔹 Колонка -> таблиця і номер рядкової колонки в ній
+static const struct {
+    const char *name;
+    int section;
+    int slot;
+    const char *title;
+} kColumns[] = {
+    { "rro",      0, 0, "Версія ПО РРО" },
+    { "muk",      0, 1, "Версія ПО МУК" },
+    { "model",    0, 2, "Модель каси" },
+    { "protocol", 1, 0, "Протокол ПРК" },
+    { "fuel",     2, 0, "Пальне пістолета" },
+    { "tank",     3, 0, "Пальне резервуару" },
+};
+
+void FleetIndex::setClientName(qint64 clientId, const QString &name) {
+    clientNames.insert(clientId, name);
+}
+
+quint32 FleetIndex::intern(const QString &value) {
+    auto it = stringIds.constFind(value);
+    if (it != stringIds.cend()) {
+        return it.value();
+    }
+    quint32 id = quint32(strings.size());
+    strings.append(value);
+    stringIds.insert(value, id);
+    return id;
+}
+
+quint32 FleetIndex::terminalRow(qint64 clientId, int terminalId) {
+    quint64 key = terminalKey(clientId, terminalId);
+    auto it = terminalRows.constFind(key);
+    if (it != terminalRows.cend()) {
+        quint32 row = it.value();
+        if (!terminalLive[row]) {
+            terminalLive[row] = 1;
+            ++m_liveTerminals;
+            m_locationRevision += terminalHasLocation[row];
+        }
+        return row;
+    }
+
+    quint32 row = quint32(terminalClient.size());
+    terminalRows.insert(key, row);
+    terminalClient.append(clientId);
+    terminalNumber.append(terminalId);
+    terminalSeen.append(m_generation);
+    terminalLive.append(1);
+    terminalLatitude.append(0.0);
+    terminalLongitude.append(0.0);
+    terminalHasLocation.append(0);
+    terminalAddress.append(QString());
+    ++m_liveTerminals;
+    return row;
+}
+
+/**
+ * @brief Позначає рядки терміналу в таблиці як замінені
+ */
+void FleetIndex::retire(Table &table, quint32 terminal) {
+    auto it = table.ranges.find(terminal);
+    if (it == table.ranges.end()) {
+        return;
+    }
+    const int first = it.value().first;
+    const int count = it.value().second;
+    for (int i = first; i < first + count; ++i) {
+        table.alive[i] = 0;
+    }
+    table.dead += count;
+    table.ranges.erase(it);
+}
+
+/**
+ * @brief Переписує таблицю без мертвих рядків, коли їх стає більше, ніж живих
+ */
+void FleetIndex::compactIfNeeded(Table &table) {
+    if (table.dead < kCompactMinDead || table.dead * 2 < table.size()) {
+        return;
+    }
+
+    Table compacted;
+    const int live = table.size() - table.dead;
+    compacted.terminal.reserve(live);
+    compacted.item.reserve(live);
+    compacted.subItem.reserve(live);
+    for (QList<quint32> &values : compacted.values) {
+        values.reserve(live);
+    }
+    compacted.alive.reserve(live);
+
+    for (int i = 0; i < table.size(); ++i) {
+        if (!table.alive[i]) {
+            continue;
+        }
+        const int row = compacted.size();
+        compacted.terminal.append(table.terminal[i]);
+        compacted.item.append(table.item[i]);
+        compacted.subItem.append(table.subItem[i]);
+        for (int slot = 0; slot < 3; ++slot) {
+            compacted.values[slot].append(table.values[slot][i]);
+        }
+        compacted.alive.append(1);
+
+        // Живі рядки терміналу й далі лежать поспіль
+        auto range = compacted.ranges.find(table.terminal[i]);
+        if (range == compacted.ranges.end()) {
+            compacted.ranges.insert(table.terminal[i], qMakePair(row, 1));
+        } else {
+            ++range.value().second;
+        }
+    }
+
+    table = std::move(compacted);
+}
+
+void FleetIndex::updateTerminal(qint64 clientId, int terminalId, const Palantir::Terminal &info) {
+    const quint32 terminal = terminalRow(clientId, terminalId);
+    const QList<Palantir::Dispenser> &dispensers = info.dispensers;
+
+    // 🔹 Координати 0,0 у Palantír означають "не задано"
+    const quint8 hasLocation = info.hasCoordinates && !(info.latitude == 0.0 && info.longitude == 0.0);
+    if (hasLocation != terminalHasLocation[terminal] || terminalLatitude[terminal] != info.latitude
+        || terminalLongitude[terminal] != info.longitude) {
+        terminalHasLocation[terminal] = hasLocation;
+        terminalLatitude[terminal] = info.latitude;
+        terminalLongitude[terminal] = info.longitude;
+        ++m_locationRevision;
+    }
+    terminalAddress[terminal] = info.address;
+    Table &prk = tables[Dispensers];
+    Table &pumps = tables[Pumps];
+    retire(prk, terminal);
+    retire(pumps, terminal);
+
+    const int firstPrk = prk.size();
+    const int firstPump = pumps.size();
+    for (const Palantir::Dispenser &dispenser : dispensers) {
+        prk.terminal.append(terminal);
+        prk.item.append(dispenser.dispenserId);
+        prk.subItem.append(0);
+        prk.values[0].append(intern(dispenser.protocol));
+        prk.values[1].append(0);
+        prk.values[2].append(0);
+        prk.alive.append(1);
+
+        for (const Palantir::Pump &pump : dispenser.pumps) {
+            pumps.terminal.append(terminal);
+            pumps.item.append(dispenser.dispenserId);
+            pumps.subItem.append(pump.pumpId);
+            pumps.values[0].append(intern(pump.fuelShortName));
+            pumps.values[1].append(0);
+            pumps.values[2].append(0);
+            pumps.alive.append(1);
+        }
+    }
+    prk.ranges.insert(terminal, qMakePair(firstPrk, prk.size() - firstPrk));
+    pumps.ranges.insert(terminal, qMakePair(firstPump, pumps.size() - firstPump));
+
+    compactIfNeeded(prk);
+    compactIfNeeded(pumps);
+}
+
+void FleetIndex::updatePosdatas(qint64 clientId, int terminalId, const QList<Palantir::PosData> &posdatas) {
+    const quint32 terminal = terminalRow(clientId, terminalId);
+    Table &table = tables[Posdatas];
+    retire(table, terminal);
+
+    const int first = table.size();
+    for (const Palantir::PosData &pos : posdatas) {
+        table.terminal.append(terminal);
+        table.item.append(pos.posId);
+        table.subItem.append(0);
+        table.values[0].append(intern(pos.posVersion));
+        table.values[1].append(intern(pos.mukVersion));
+        table.values[2].append(intern(QString("%1 %2").arg(pos.manufacturer, pos.model).trimmed()));
+        table.alive.append(1);
+    }
+    table.ranges.insert(terminal, qMakePair(first, table.size() - first));
+
+    compactIfNeeded(table);
+}
+
+void FleetIndex::updateReservoirs(qint64 clientId, int terminalId, const QList<Palantir::Reservoir> &reservoirs) {
+    const quint32 terminal = terminalRow(clientId, terminalId);
+    Table &table = tables[Tanks];
+    retire(table, terminal);
+
+    const int first = table.size();
+    for (const Palantir::Reservoir &reservoir : reservoirs) {
+        table.terminal.append(terminal);
+        table.item.append(reservoir.tankId);
+        table.subItem.append(0);
+        table.values[0].append(intern(reservoir.shortName));
+        table.values[1].append(0);
+        table.values[2].append(0);
+        table.alive.append(1);
+    }
+    table.ranges.insert(terminal, qMakePair(first, table.size() - first));
+
+    compactIfNeeded(table);
+}
+
+void FleetIndex::beginSync() {
+    ++m_generation;
+}
+
+void FleetIndex::touchTerminal(qint64 clientId, int terminalId) {
+    terminalSeen[terminalRow(clientId, terminalId)] = m_generation;
+}
+
+void FleetIndex::touchClient(qint64 clientId) {
+    for (int row = 0; row < terminalClient.size(); ++row) {
+        if (terminalClient[row] == clientId) {
+            terminalSeen[row] = m_generation;
+        }
+    }
+}
+
+/**
+ * @brief Завершує обхід: термінали, яких у ньому не було, зникають з індексу
+ */
+void FleetIndex::endSync() {
+    for (int row = 0; row < terminalClient.size(); ++row) {
+        if (!terminalLive[row] || terminalSeen[row] == m_generation) {
+            continue;
+        }
+        for (Table &table : tables) {
+            retire(table, quint32(row));
+        }
+        terminalLive[row] = 0;
+        --m_liveTerminals;
+        m_locationRevision += terminalHasLocation[row];
+    }
+    for (Table &table : tables) {
+        compactIfNeeded(table);
+    }
+    m_syncedAt = QDateTime::currentDateTime();
+}
+
+QList<FleetIndex::Location> FleetIndex::locations() const {
+    QList<Location> result;
+    for (int row = 0; row < terminalClient.size(); ++row) {
+        if (terminalLive[row] && terminalHasLocation[row]) {
+            result.append(Location{ terminalClient[row], terminalNumber[row],
+                                    terminalLatitude[row], terminalLongitude[row], terminalAddress[row] });
+        }
+    }
+    return result;
+}
+
+QString FleetIndex::describe(Section section, const Table &table, int row) const {
+    switch (section) {
+    case Posdatas:
+        return QString("Каса №%1").arg(table.item[row]);
+    case Dispensers:
+        return QString("ПРК %1").arg(table.item[row]);
+    case Pumps:
+        return QString("ПРК %1, пістолет %2").arg(table.item[row]).arg(table.subItem[row]);
+    default:
+        return QString("Резервуар %1").arg(table.item[row]);
+    }
+}
+
+/**
+ * @brief Рядки, значення яких у колонці задовольняє шаблон
+ * @param limit Скільки рядків повернути у matches (лічильники рахуються по всіх)
+ */
+FleetIndex::Selection FleetIndex::select(Column column, const QString &pattern, int limit) const {
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto &descriptor = kColumns[int(column)];
+    const Section section = Section(descriptor.section);
+    const Table &table = tables[section];
+
+    // 🔹 Умова обчислюється один раз на унікальне значення, а не на рядок
+    QString needle = pattern.trimmed();
+    const bool negate = needle.startsWith('!');
+    if (negate) {
+        needle.remove(0, 1);
+    }
+    const bool prefix = needle.endsWith('*');
+    if (prefix) {
+        needle.chop(1);
+    }
+
+    std::vector<quint8> wanted(size_t(strings.size()));
+    for (qsizetype id = 0; id < strings.size(); ++id) {
+        const QString &value = strings.at(id);
+        bool match = prefix ? value.startsWith(needle, Qt::CaseInsensitive)
+                            : value.compare(needle, Qt::CaseInsensitive) == 0;
+        wanted[size_t(id)] = quint8(match != negate);
+    }
+
+    // 🔹 Прохід по суцільних колонках без розгалужень
+    const int rows = table.size();
+    const quint32 *values = table.values[descriptor.slot].constData();
+    const quint8 *alive = table.alive.constData();
+    const quint8 *lookup = wanted.data();
+    std::vector<quint8> hits(size_t(rows));
+    int hitCount = 0;
+    for (int i = 0; i < rows; ++i) {
+        const quint8 hit = alive[i] & lookup[values[i]];
+        hits[size_t(i)] = hit;
+        hitCount += hit;
+    }
+
+    Selection selection;
+    selection.rows = hitCount;
+
+    QSet<quint32> terminals;
+    for (int i = 0; i < rows; ++i) {
+        if (!hits[size_t(i)]) {
+            continue;
+        }
+        const quint32 terminal = table.terminal[i];
+        terminals.insert(terminal);
+        if (selection.matches.size() < limit) {
+            selection.matches.append(Match{ terminalClient[terminal], terminalNumber[terminal],
+                                            describe(section, table, i), strings.at(values[i]) });
+        }
+    }
+    selection.terminals = int(terminals.size());
+
+    std::sort(selection.matches.begin(), selection.matches.end(), [](const Match &a, const Match &b) {
+        return a.clientId != b.clientId ? a.clientId < b.clientId : a.terminalId < b.terminalId;
+    });
+
+    selection.elapsedUs = timer.nsecsElapsed() / 1000;
+    return selection;
+}
+
+QList<QPair<QString, int>> FleetIndex::histogram(Column column) const {
+    const auto &descriptor = kColumns[int(column)];
+    const Table &table = tables[descriptor.section];
+
+    std::vector<int> counts(size_t(strings.size()));
+    const quint32 *values = table.values[descriptor.slot].constData();
+    const quint8 *alive = table.alive.constData();
+    for (int i = 0; i < table.size(); ++i) {
+        counts[values[i]] += alive[i];
+    }
+
+    QList<QPair<QString, int>> result;
+    for (size_t id = 0; id < counts.size(); ++id) {
+        if (counts[id] > 0) {
+            result.append(qMakePair(strings.at(qsizetype(id)), counts[id]));
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const QPair<QString, int> &a, const QPair<QString, int> &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    return result;
+}
+
+int FleetIndex::rowCount(Column column) const {
+    const Table &table = tables[kColumns[int(column)].section];
+    return table.size() - table.dead;
+}
+
+bool FleetIndex::columnFromName(const QString &name, Column *column) {
+    for (int i = 0; i < int(std::size(kColumns)); ++i) {
+        if (name.compare(QLatin1String(kColumns[i].name), Qt::CaseInsensitive) == 0) {
+            *column = Column(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+QString FleetIndex::columnTitle(Column column) {
+    return QString::fromUtf8(kColumns[int(column)].title);
+}
+
+QStringList FleetIndex::columnNames() {
+    QStringList names;
+    for (const auto &descriptor : kColumns) {
+        names.append(QLatin1String(descriptor.name));
+    }
+    return names;
+}
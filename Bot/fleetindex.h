@@ -0,0 +1,126 @@
+#ifndef FLEETINDEX_H
+#define FLEETINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QDateTime>
+#include "palantirtypes.h"
+
+/**
+ * @brief Колонковий індекс конфігурації всього парку в пам'яті.
+ *
+ * Каси, ПРК, пістолети і резервуари зберігаються окремими таблицями з
+ * суцільних цілочисельних колонок; рядкові значення (версії ПО, протоколи,
+ * пальне) інтерновані і в колонках лежать їхні номери. Умова запиту
+ * обчислюється один раз на кожне унікальне значення, далі скан — це прохід
+ * по масивах без розгалужень. Заповнюється FleetWatcher під час обходу.
+ */
+class FleetIndex {
+public:
+    // 🔹 Колонки, за якими можна шукати (/q <колонка> <значення>)
+    enum class Column { RroVersion, MukVersion, PosModel, Protocol, PumpFuel, TankFuel };
+
+    struct Match {
+        qint64 clientId;
+        int terminalId;
+        QString detail;     // "Каса №2", "ПРК 3, пістолет 1", ...
+        QString value;
+    };
+
+    struct Selection {
+        int rows = 0;            // Скільки рядків задовольнили умову
+        int terminals = 0;       // Скільки різних терміналів
+        QList<Match> matches;    // Перші limit рядків
+        qint64 elapsedUs = 0;
+    };
+
+    void setClientName(qint64 clientId, const QString &name);
+    QString clientName(qint64 clientId) const { return clientNames.value(clientId); }
+
+    // 🔹 Координати терміналу для пошуку найближчих АЗС
+    struct Location {
+        qint64 clientId;
+        int terminalId;
+        double latitude;
+        double longitude;
+        QString address;
+    };
+
+    // 🔹 Розділ терміналу повністю замінює попередні рядки цього терміналу
+    void updateTerminal(qint64 clientId, int terminalId, const Palantir::Terminal &info);   // ПРК, пістолети, координати
+    void updatePosdatas(qint64 clientId, int terminalId, const QList<Palantir::PosData> &posdatas);
+    void updateReservoirs(qint64 clientId, int terminalId, const QList<Palantir::Reservoir> &reservoirs);
+
+    // 🔹 Синхронізація з обходом: термінали, яких не було в обході, видаляються
+    void beginSync();
+    void touchTerminal(qint64 clientId, int terminalId);
+    void touchClient(qint64 clientId);        // azs_list клієнта недоступний — нічого не видаляємо
+    void endSync();
+
+    // @param pattern Значення без урахування регістру; "abc*" — префікс, "!abc" — заперечення
+    Selection select(Column column, const QString &pattern, int limit) const;
+    QList<QPair<QString, int>> histogram(Column column) const;   // Значення -> рядків, за спаданням
+
+    QList<Location> locations() const;                // Живі термінали із заданими координатами
+    quint64 locationRevision() const { return m_locationRevision; }   // Змінюється разом із locations()
+
+    int terminalCount() const { return m_liveTerminals; }
+    int rowCount(Column column) const;
+    int distinctValues() const { return int(strings.size()); }
+    QDateTime syncedAt() const { return m_syncedAt; }
+
+    static bool columnFromName(const QString &name, Column *column);
+    static QString columnTitle(Column column);
+    static QStringList columnNames();
+
+private:
+    enum Section { Posdatas, Dispensers, Pumps, Tanks, SectionCount };
+
+    // 🔹 Таблиця розділу: рядки одного терміналу лежать поспіль
+    struct Table {
+        QList<quint32> terminal;        // Номер рядка терміналу
+        QList<qint32> item;             // pos_id / dispenser_id / tank_id
+        QList<qint32> subItem;          // pump_id (лише пістолети)
+        QList<quint32> values[3];       // Інтерновані рядкові колонки
+        QList<quint8> alive;            // 0 — рядок замінено новішими даними
+        QHash<quint32, QPair<int, int>> ranges;   // Термінал -> [перший рядок, кількість]
+        int dead = 0;
+
+        int size() const { return int(alive.size()); }
+    };
+
+    quint32 intern(const QString &value);
+    quint32 terminalRow(qint64 clientId, int terminalId);
+    void retire(Table &table, quint32 terminal);
+    void compactIfNeeded(Table &table);
+    QString describe(Section section, const Table &table, int row) const;
+
+    static quint64 terminalKey(qint64 clientId, int terminalId) { return (quint64(clientId) << 32) | quint32(terminalId); }
+
+    // 🔹 Інтернування рядків
+    QHash<QString, quint32> stringIds;
+    QStringList strings;
+
+    // 🔹 Термінали
+    QHash<quint64, quint32> terminalRows;
+    QList<qint64> terminalClient;
+    QList<qint32> terminalNumber;
+    QList<quint32> terminalSeen;        // Покоління обходу, в якому термінал бачили
+    QList<quint8> terminalLive;
+    QList<double> terminalLatitude;
+    QList<double> terminalLongitude;
+    QList<quint8> terminalHasLocation;
+    QStringList terminalAddress;        // Не інтернуються: адреси унікальні
+    quint64 m_locationRevision = 0;
+    int m_liveTerminals = 0;
+
+    QHash<qint64, QString> clientNames;
+    Table tables[SectionCount];
+    quint32 m_generation = 0;
+    QDateTime m_syncedAt;
+};
+
+#endif // FLEETINDEX_H
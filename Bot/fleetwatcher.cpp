@@ -0,0 +1,389 @@
+#include "fleetwatcher.h"
+#include "config.h"
+#include "loopmonitor.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include <QFile>
+#include <QSet>
+#include <QUrlQuery>
+#include <QDebug>
+
+static const char *const kSectionNames[][2] = {
+    { "terminal_info", "⛽ ПРК" },
+    { "posdatas", "💳 РРО" },
+    { "reservoirs_info", "🛢 Резервуари" },
+};
+
+static QString sectionTitle(const QString &endpoint) {
+    for (const auto &names : kSectionNames) {
+        if (endpoint == names[0]) {
+            return QString::fromUtf8(names[1]);
+        }
+    }
+    return endpoint;
+}
+
+static QString sectionKey(qint64 clientId, int terminalId, const QString &endpoint) {
+    return QString("%1:%2:%3").arg(clientId).arg(terminalId).arg(endpoint);
+}
+
+FleetWatcher::FleetWatcher(PalantirGateway *palantir, const QString &stateDir, QObject *parent)
+    : QObject(parent), palantir(palantir) {
+    statePath = stateDir + "/fleet_state.json";
+    subscriptionsPath = stateDir + "/subscriptions.json";
+
+    loadState();
+    loadSubscriptions();
+
+    connect(&sweepTimer, &QTimer::timeout, this, &FleetWatcher::sweep);
+}
+
+void FleetWatcher::start(int intervalMs) {
+    sweepTimer.start(intervalMs);
+}
+
+// 🔹 Плоскі поля розділів, зміни яких цікаві підписникам
+
+FleetWatcher::Fields FleetWatcher::rroFields(const QList<Palantir::PosData> &posdatas) {
+    Fields fields;
+    for (const Palantir::PosData &pos : posdatas) {
+        QString prefix = QString("Каса №%1 • ").arg(pos.posId);
+        fields[prefix + "Версія ПО РРО"] = pos.posVersion;
+        fields[prefix + "Версія ПО МУК"] = pos.mukVersion;
+        fields[prefix + "ФН"] = pos.regNumber;
+    }
+    return fields;
+}
+
+FleetWatcher::Fields FleetWatcher::prkFields(const QList<Palantir::Dispenser> &dispensers) {
+    Fields fields;
+    for (const Palantir::Dispenser &dispenser : dispensers) {
+        QString prefix = QString("ПРК %1 • ").arg(dispenser.dispenserId);
+        fields[prefix + "протокол"] = dispenser.protocol;
+        fields[prefix + "порт"] = QString::number(dispenser.port);
+        fields[prefix + "швидкість"] = QString::number(dispenser.speed);
+        fields[prefix + "адреса"] = QString::number(dispenser.address);
+    }
+    return fields;
+}
+
+FleetWatcher::Fields FleetWatcher::reservoirFields(const QList<Palantir::Reservoir> &reservoirs) {
+    Fields fields;
+    for (const Palantir::Reservoir &reservoir : reservoirs) {
+        QString prefix = QString("Резервуар %1 • ").arg(reservoir.tankId);
+        fields[prefix + "Min"] = QString::number(reservoir.minValue);
+        fields[prefix + "Max"] = QString::number(reservoir.maxValue);
+        fields[prefix + "Рівномір"] = QString("%1 - %2").arg(reservoir.deadMin).arg(reservoir.deadMax);
+    }
+    return fields;
+}
+
+/**
+ * @brief Один обхід усього парку: clients → azs_list → розділи кожного терміналу
+ */
+void FleetWatcher::sweep() {
+    if (sweeping) {
+        qDebug() << "🔭 Попередній обхід ще триває, пропускаємо.";
+        return;
+    }
+
+    sweeping = true;
+    concurrency = qMax(1, Config::current().sweepConcurrency);
+    sweptSections = 0;
+    changedSections = 0;
+    if (index) {
+        index->beginSync();
+    }
+    qInfo() << "🔭 Починаємо обхід терміналів для виявлення змін.";
+
+    palantir->get("clients", QUrlQuery(), [this](const PalantirResponse &response) {
+        if (!response.ok || response.fromCache) {
+            qWarning() << "🔭 Обхід скасовано: список клієнтів недоступний.";
+            sweeping = false;
+            return;
+        }
+
+        QJsonArray clients = QJsonDocument::fromJson(response.body).object()["data"].toArray();
+        for (const QJsonValue &client : clients) {
+            qint64 clientId = client.toObject()["id"].toInt();
+            if (index) {
+                index->setClientName(clientId, client.toObject()["name"].toString());
+            }
+
+            QUrlQuery query;
+            query.addQueryItem("client_id", QString::number(clientId));
+
+            ++pendingLists;
+            palantir->get("azs_list", query, [this, clientId](const PalantirResponse &listResponse) {
+                --pendingLists;
+                if (listResponse.ok && !listResponse.fromCache) {
+                    QJsonArray azsList = QJsonDocument::fromJson(listResponse.body).object()["azs_list"].toArray();
+                    for (const QJsonValue &azs : azsList) {
+                        int terminalId = azs.toObject()["terminal_id"].toInt();
+                        if (index) {
+                            index->touchTerminal(clientId, terminalId);
+                        }
+                        for (const auto &names : kSectionNames) {
+                            queue.enqueue(Task{clientId, terminalId, QString::fromLatin1(names[0])});
+                        }
+                    }
+                } else if (index) {
+                    index->touchClient(clientId);  // Список недоступний — не вважаємо термінали зниклими
+                }
+                pump();
+                finishIfIdle();
+            });
+        }
+
+        finishIfIdle();
+    });
+}
+
+/**
+ * @brief Запускає наступні запити в межах бюджету паралельності
+ */
+void FleetWatcher::pump() {
+    while (inFlight < concurrency && !queue.isEmpty()) {
+        Task task = queue.dequeue();
+        ++inFlight;
+
+        QUrlQuery query;
+        query.addQueryItem("client_id", QString::number(task.clientId));
+        query.addQueryItem("terminal_id", QString::number(task.terminalId));
+
+        palantir->get(task.endpoint, query, [this, task](const PalantirResponse &response) {
+            --inFlight;
+            onSection(task, response);
+            pump();
+            finishIfIdle();
+        });
+    }
+}
+
+void FleetWatcher::onSection(const Task &task, const PalantirResponse &response) {
+    LoopMonitor::Activity activity("FleetWatcher::onSection");
+    if (!response.ok || response.fromCache) {
+        return;  // Застарілі дані не порівнюємо
+    }
+
+    QJsonObject jsonObj = QJsonDocument::fromJson(response.body).object();
+    if (jsonObj.isEmpty() || jsonObj.contains("error")) {
+        return;
+    }
+
+    // 🔹 Розбираємо розділ один раз: і для порівняння, і для індексу
+    Fields fields;
+    if (task.endpoint == "terminal_info") {
+        Palantir::Terminal terminal = Palantir::terminalFromJson(jsonObj);
+        fields = prkFields(terminal.dispensers);
+        if (index) {
+            index->updateTerminal(task.clientId, task.terminalId, terminal);
+        }
+    } else if (task.endpoint == "posdatas") {
+        QList<Palantir::PosData> posdatas = Palantir::posdatasFromJson(jsonObj);
+        fields = rroFields(posdatas);
+        if (index) {
+            index->updatePosdatas(task.clientId, task.terminalId, posdatas);
+        }
+    } else {
+        QList<Palantir::Reservoir> reservoirs = Palantir::reservoirsFromJson(jsonObj);
+        fields = reservoirFields(reservoirs);
+        if (index) {
+            index->updateReservoirs(task.clientId, task.terminalId, reservoirs);
+        }
+    }
+
+    ++sweptSections;
+    compare(task.clientId, task.terminalId, task.endpoint, fields);
+}
+
+/**
+ * @brief Порівнює хеш розділу з попереднім; різницю рахує лише при зміні хешу
+ */
+void FleetWatcher::compare(qint64 clientId, int terminalId, const QString &section, const Fields &fields) {
+    QCryptographicHash hasher(QCryptographicHash::Sha1);
+    for (auto it = fields.cbegin(); it != fields.cend(); ++it) {
+        hasher.addData(it.key().toUtf8());
+        hasher.addData(QByteArrayView("\x1f", 1));
+        hasher.addData(it.value().toUtf8());
+        hasher.addData(QByteArrayView("\x1e", 1));
+    }
+    QByteArray hash = hasher.result();
+
+    QString key = sectionKey(clientId, terminalId, section);
+    auto known = hashes.constFind(key);
+    if (known != hashes.cend() && known.value() == hash) {
+        return;  // Нічого не змінилось — найдешевший шлях
+    }
+
+    bool firstSeen = known == hashes.cend();
+    Fields previous = snapshots.value(key);
+
+    hashes.insert(key, hash);
+    snapshots.insert(key, fields);
+    stateDirty = true;
+
+    if (firstSeen) {
+        return;  // Перше знайомство з терміналом — це не зміна
+    }
+
+    ++changedSections;
+
+    QStringList changes;
+    for (auto it = fields.cbegin(); it != fields.cend(); ++it) {
+        auto old = previous.constFind(it.key());
+        if (old == previous.cend()) {
+            changes.append(QString("➕ %1: %2").arg(it.key(), it.value()));
+        } else if (old.value() != it.value()) {
+            changes.append(QString("🔄 %1: %2 → %3").arg(it.key(), old.value(), it.value()));
+        }
+    }
+    for (auto it = previous.cbegin(); it != previous.cend(); ++it) {
+        if (!fields.contains(it.key())) {
+            changes.append(QString("➖ %1: %2").arg(it.key(), it.value()));
+        }
+    }
+
+    if (!changes.isEmpty()) {
+        notify(clientId, terminalId, section, changes);
+    }
+}
+
+void FleetWatcher::notify(qint64 clientId, int terminalId, const QString &section, const QStringList &changes) {
+    QString text = QString("🔔 <b>Зміни конфігурації</b>\nКлієнт %1, термінал %2 — %3\n\n%4")
+                       .arg(clientId).arg(terminalId).arg(sectionTitle(section), changes.join("\n"));
+
+    qInfo() << "🔔 Зміна" << section << "для" << clientId << terminalId << ":" << changes;
+
+    QSet<qint64> notified;
+    for (const Subscription &sub : subscriptions) {
+        if (sub.clientId == clientId && (sub.terminalId == 0 || sub.terminalId == terminalId)
+            && !notified.contains(sub.chatId)) {
+            notified.insert(sub.chatId);
+            emit changeDetected(sub.chatId, text);
+        }
+    }
+}
+
+void FleetWatcher::finishIfIdle() {
+    if (!sweeping || pendingLists > 0 || inFlight > 0 || !queue.isEmpty()) {
+        return;
+    }
+
+    sweeping = false;
+    if (index) {
+        index->endSync();
+    }
+    if (stateDirty) {
+        saveState();
+        stateDirty = false;
+    }
+
+    qInfo() << "🔭 Обхід завершено. Розділів:" << sweptSections << "змінено:" << changedSections;
+    emit sweepFinished(sweptSections, changedSections);
+}
+
+void FleetWatcher::subscribe(qint64 chatId, qint64 clientId, int terminalId) {
+    Subscription sub{chatId, clientId, terminalId};
+    if (!subscriptions.contains(sub)) {
+        subscriptions.append(sub);
+        saveSubscriptions();
+    }
+}
+
+bool FleetWatcher::unsubscribe(qint64 chatId, qint64 clientId, int terminalId) {
+    bool removed = subscriptions.removeAll(Subscription{chatId, clientId, terminalId}) > 0;
+    if (removed) {
+        saveSubscriptions();
+    }
+    return removed;
+}
+
+QList<QPair<qint64, int>> FleetWatcher::subscriptionsOf(qint64 chatId) const {
+    QList<QPair<qint64, int>> result;
+    for (const Subscription &sub : subscriptions) {
+        if (sub.chatId == chatId) {
+            result.append(qMakePair(sub.clientId, sub.terminalId));
+        }
+    }
+    return result;
+}
+
+void FleetWatcher::loadState() {
+    QFile file(statePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonObject state = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = state.constBegin(); it != state.constEnd(); ++it) {
+        QJsonObject entry = it.value().toObject();
+        hashes.insert(it.key(), QByteArray::fromBase64(entry["hash"].toString().toLatin1()));
+
+        Fields fields;
+        QJsonObject fieldsObj = entry["fields"].toObject();
+        for (auto f = fieldsObj.constBegin(); f != fieldsObj.constEnd(); ++f) {
+            fields.insert(f.key(), f.value().toString());
+        }
+        snapshots.insert(it.key(), fields);
+    }
+    qDebug() << "🔭 Завантажено стан" << hashes.size() << "розділів терміналів.";
+}
+
+void FleetWatcher::saveState() const {
+    QJsonObject state;
+    for (auto it = hashes.cbegin(); it != hashes.cend(); ++it) {
+        QJsonObject fieldsObj;
+        const Fields fields = snapshots.value(it.key());
+        for (auto f = fields.cbegin(); f != fields.cend(); ++f) {
+            fieldsObj[f.key()] = f.value();
+        }
+        state[it.key()] = QJsonObject{
+            {"hash", QString::fromLatin1(it.value().toBase64())},
+            {"fields", fieldsObj}
+        };
+    }
+
+    QSaveFile file(statePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "❌ Не вдалося зберегти стан парку:" << statePath;
+        return;
+    }
+    file.write(QJsonDocument(state).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+void FleetWatcher::loadSubscriptions() {
+    QFile file(subscriptionsPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    for (const QJsonValue &val : QJsonDocument::fromJson(file.readAll()).array()) {
+        QJsonObject obj = val.toObject();
+        subscriptions.append(Subscription{
+            obj["chat_id"].toVariant().toLongLong(),
+            obj["client_id"].toVariant().toLongLong(),
+            obj["terminal_id"].toInt()
+        });
+    }
+}
+
+void FleetWatcher::saveSubscriptions() const {
+    QJsonArray array;
+    for (const Subscription &sub : subscriptions) {
+        array.append(QJsonObject{
+            {"chat_id", sub.chatId},
+            {"client_id", sub.clientId},
+            {"terminal_id", sub.terminalId}
+        });
+    }
+
+    QSaveFile file(subscriptionsPath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(array).toJson());
+        file.commit();
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef FLEETWATCHER_H
+#define FLEETWATCHER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QQueue>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QJsonObject>
+#include <QJsonArray>
+#include "palantirgateway.h"
+#include "palantirtypes.h"
+#include "fleetindex.h"
+
+/**
+ * @brief Фоновий обхід усіх терміналів для виявлення змін конфігурації.
+ *
+ * Для кожного розділу терміналу (РРО, ПРК, резервуари) зберігається хеш
+ * вмісту; різниця рахується лише там, де хеш змінився, і надсилається
+ * користувачам, підписаним на клієнта або термінал.
+ */
+class FleetWatcher : public QObject {
+    Q_OBJECT
+public:
+    using Fields = QMap<QString, QString>;  // Плоскі поля розділу: "Каса №1 • Версія ПО РРО" -> "2.1.3"
+
+    explicit FleetWatcher(PalantirGateway *palantir, const QString &stateDir, QObject *parent = nullptr);
+
+    void start(int intervalMs);       // Періодичний обхід
+    void stop() { sweepTimer.stop(); }  // Поточний обхід завершиться, нових не буде
+    void sweep();                     // Один обхід усього парку
+    bool isSweeping() const { return sweeping; }
+
+    // 🔔 Підписки: terminalId == 0 означає весь клієнт
+    void subscribe(qint64 chatId, qint64 clientId, int terminalId);
+    bool unsubscribe(qint64 chatId, qint64 clientId, int terminalId);
+    QList<QPair<qint64, int>> subscriptionsOf(qint64 chatId) const;
+
+    void setIndex(FleetIndex *fleetIndex) { index = fleetIndex; }   // Колонковий індекс, що поповнюється обходом
+
+    static Fields rroFields(const QList<Palantir::PosData> &posdatas);
+    static Fields prkFields(const QList<Palantir::Dispenser> &dispensers);
+    static Fields reservoirFields(const QList<Palantir::Reservoir> &reservoirs);
+
+signals:
+    void changeDetected(qint64 chatId, const QString &text);
+    void sweepFinished(int sections, int changed);
+
+private:
+    struct Task {
+        qint64 clientId;
+        int terminalId;
+        QString endpoint;  // terminal_info, posdatas або reservoirs_info
+    };
+
+    struct Subscription {
+        qint64 chatId;
+        qint64 clientId;
+        int terminalId;
+        bool operator==(const Subscription &other) const {
+            return chatId == other.chatId && clientId == other.clientId && terminalId == other.terminalId;
+        }
+    };
+
+    void pump();
+    void onSection(const Task &task, const PalantirResponse &response);
+    void compare(qint64 clientId, int terminalId, const QString &section, const Fields &fields);
+    void notify(qint64 clientId, int terminalId, const QString &section, const QStringList &changes);
+    void finishIfIdle();
+
+    void loadState();
+    void saveState() const;
+    void loadSubscriptions();
+    void saveSubscriptions() const;
+
+    PalantirGateway *palantir;
+    FleetIndex *index = nullptr;
+    QString statePath;
+    QString subscriptionsPath;
+    QTimer sweepTimer;
+
+    QHash<QString, QByteArray> hashes;   // "client:terminal:section" -> хеш вмісту
+    QHash<QString, Fields> snapshots;    // Останні поля (для обчислення різниці)
+    QList<Subscription> subscriptions;
+
+    QQueue<Task> queue;
+    int concurrency = 4;
+    int inFlight = 0;
+    int pendingLists = 0;                // Запити azs_list, що ще тривають
+    bool sweeping = false;
+    bool stateDirty = false;
+    int sweptSections = 0;
+    int changedSections = 0;
+};
+
+#endif // FLEETWATCHER_H
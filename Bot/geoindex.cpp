@@ -0,0 +1,99 @@
+#include "geoindex.h"
+#include <algorithm>
+#include <cmath>
+
+static const double kEarthRadiusKm = 6371.0;
+static const double kDegToRad = 3.14159265358979323846 / 180.0;
+
+void GeoIndex::toUnitVector(double latitude, double longitude, double xyz[3]) {
+    const double lat = latitude * kDegToRad;
+    const double lon = longitude * kDegToRad;
+    xyz[0] = std::cos(lat) * std::cos(lon);
+    xyz[1] = std::cos(lat) * std::sin(lon);
+    xyz[2] = std::sin(lat);
+}
+
+void GeoIndex::build(const QList<Station> &stations, quint64 revision) {
+    m_stations = stations;
+    m_revision = revision;
+    m_nodes.resize(size_t(m_stations.size()));
+    for (int i = 0; i < m_stations.size(); ++i) {
+        toUnitVector(m_stations[i].latitude, m_stations[i].longitude, m_nodes[size_t(i)].xyz);
+        m_nodes[size_t(i)].station = i;
+    }
+    buildRange(0, int(m_nodes.size()), 0);
+}
+
+/**
+ * @brief Медіана за віссю depth % 3 стає коренем піддерева [begin, end)
+ */
+void GeoIndex::buildRange(int begin, int end, int depth) {
+    if (end - begin <= 1) {
+        return;
+    }
+    const int axis = depth % 3;
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(m_nodes.begin() + begin, m_nodes.begin() + mid, m_nodes.begin() + end,
+                     [axis](const Node &a, const Node &b) { return a.xyz[axis] < b.xyz[axis]; });
+    buildRange(begin, mid, depth + 1);
+    buildRange(mid + 1, end, depth + 1);
+}
+
+void GeoIndex::search(int begin, int end, int depth, const double query[3], size_t k,
+                      std::vector<Candidate> &heap) const {
+    if (begin >= end) {
+        return;
+    }
+
+    const int axis = depth % 3;
+    const int mid = begin + (end - begin) / 2;
+    const Node &node = m_nodes[size_t(mid)];
+
+    const double dx = node.xyz[0] - query[0];
+    const double dy = node.xyz[1] - query[1];
+    const double dz = node.xyz[2] - query[2];
+    const double distance = dx * dx + dy * dy + dz * dz;
+
+    // 🔹 Max-heap з k кращих кандидатів: вершина — найдальший з них
+    if (heap.size() < k) {
+        heap.emplace_back(distance, mid);
+        std::push_heap(heap.begin(), heap.end());
+    } else if (distance < heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = Candidate(distance, mid);
+        std::push_heap(heap.begin(), heap.end());
+    }
+
+    const double diff = query[axis] - node.xyz[axis];
+    const bool leftFirst = diff < 0;
+    search(leftFirst ? begin : mid + 1, leftFirst ? mid : end, depth + 1, query, k, heap);
+
+    // Друга половина — лише якщо площина розрізу ближча за найгіршого кандидата
+    if (heap.size() < k || diff * diff < heap.front().first) {
+        search(leftFirst ? mid + 1 : begin, leftFirst ? end : mid, depth + 1, query, k, heap);
+    }
+}
+
+QList<GeoIndex::Hit> GeoIndex::nearest(double latitude, double longitude, int k) const {
+    QList<Hit> hits;
+    if (k <= 0 || m_nodes.empty()) {
+        return hits;
+    }
+
+    double query[3];
+    toUnitVector(latitude, longitude, query);
+
+    std::vector<Candidate> heap;
+    heap.reserve(size_t(k) + 1);
+    search(0, int(m_nodes.size()), 0, query, size_t(k), heap);
+    std::sort_heap(heap.begin(), heap.end());
+
+    hits.reserve(qsizetype(heap.size()));
+    for (const Candidate &candidate : heap) {
+        // Хорда -> відстань по дузі великого кола
+        const double chord = std::sqrt(candidate.first);
+        const double distanceKm = 2.0 * kEarthRadiusKm * std::asin(std::min(1.0, chord / 2.0));
+        hits.append(Hit{ m_stations[m_nodes[size_t(candidate.second)].station], distanceKm });
+    }
+    return hits;
+}
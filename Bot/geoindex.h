@@ -0,0 +1,48 @@
+#ifndef GEOINDEX_H
+#define GEOINDEX_H
+
+#include <QList>
+#include <utility>
+#include <vector>
+#include "fleetindex.h"
+
+/**
+ * @brief Просторовий індекс АЗС для пошуку найближчих до точки.
+ *
+ * Неявне k-d дерево (медіана посередині діапазону масиву) над одиничними
+ * векторами на сфері: хорда монотонна з відстанню по дузі, тож k найближчих
+ * у 3D — це k найближчих і на мапі, без похибок біля меридіанів і полюсів.
+ * Будується з координат FleetIndex; запит — мікросекунди, без звернень до Palantír.
+ */
+class GeoIndex {
+public:
+    using Station = FleetIndex::Location;
+
+    struct Hit {
+        Station station;
+        double distanceKm;
+    };
+
+    void build(const QList<Station> &stations, quint64 revision);
+    QList<Hit> nearest(double latitude, double longitude, int k) const;
+
+    int size() const { return int(m_stations.size()); }
+    quint64 revision() const { return m_revision; }   // Ревізія FleetIndex, з якої побудовано
+
+private:
+    struct Node {
+        double xyz[3];
+        int station;
+    };
+    using Candidate = std::pair<double, int>;   // Квадрат хорди, індекс вузла
+
+    static void toUnitVector(double latitude, double longitude, double xyz[3]);
+    void buildRange(int begin, int end, int depth);
+    void search(int begin, int end, int depth, const double query[3], size_t k, std::vector<Candidate> &heap) const;
+
+    QList<Station> m_stations;
+    std::vector<Node> m_nodes;
+    quint64 m_revision = 0;
+};
+
+#endif // GEOINDEX_H
@@ -0,0 +1,169 @@
+#include "handoff.h"
+#include <QJsonDocument>
+#include <QtEndian>
+#include <QDebug>
+#include <memory>
+
+static const quint32 kMaxFrame = 64 * 1024 * 1024;
+
+static void writeFrame(QLocalSocket *socket, const QJsonObject &frame) {
+    const QByteArray json = QJsonDocument(frame).toJson(QJsonDocument::Compact);
+    QByteArray header(4, '\0');
+    qToBigEndian<quint32>(quint32(json.size()), header.data());
+    socket->write(header);
+    socket->write(json);
+    socket->flush();
+}
+
+/**
+ * @brief Виймає з буфера один повний кадр
+ * @return false, якщо кадр ще не надійшов повністю (або він некоректний — тоді error)
+ */
+static bool readFrame(QByteArray &buffer, QJsonObject *frame, bool *error) {
+    if (buffer.size() < 4) {
+        return false;
+    }
+    const quint32 length = qFromBigEndian<quint32>(buffer.constData());
+    if (length > kMaxFrame) {
+        *error = true;
+        return false;
+    }
+    if (quint32(buffer.size()) - 4 < length) {
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(buffer.mid(4, length), &parseError);
+    buffer.remove(0, 4 + int(length));
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        *error = true;
+        return false;
+    }
+    *frame = document.object();
+    return true;
+}
+
+HandoffServer::HandoffServer(const QString &name, Prepare prepare, QObject *parent)
+    : QObject(parent), name(name), prepare(std::move(prepare)) {
+    connect(&server, &QLocalServer::newConnection, this, &HandoffServer::onConnection);
+}
+
+bool HandoffServer::listen() {
+    QLocalServer::removeServer(name);   // Сокет, що лишився після аварійного завершення
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!server.listen(name)) {
+        qWarning() << "❌ Не вдалося відкрити сокет передачі стану" << name << ":" << server.errorString();
+        return false;
+    }
+    qInfo() << "🔁 Очікуємо передачу стану на" << server.fullServerName();
+    return true;
+}
+
+void HandoffServer::onConnection() {
+    while (QLocalSocket *socket = server.nextPendingConnection()) {
+        if (busy) {
+            socket->disconnectFromServer();
+            socket->deleteLater();
+            continue;
+        }
+
+        auto buffer = std::make_shared<QByteArray>();
+        auto acknowledged = std::make_shared<bool>(false);
+        QPointer<QLocalSocket> peer(socket);
+
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket, buffer, acknowledged, peer]() {
+            buffer->append(socket->readAll());
+
+            QJsonObject frame;
+            bool error = false;
+            while (readFrame(*buffer, &frame, &error)) {
+                const QString type = frame["type"].toString();
+                if (type == "hello" && !busy) {
+                    busy = true;
+                    server.close();   // Новий процес відкриє сокет сам
+                    qInfo() << "🔁 Новий процес просить передати стан";
+                    prepare([peer](const QJsonObject &state) {
+                        if (peer) {
+                            QJsonObject frame = state;
+                            frame["type"] = "state";
+                            writeFrame(peer, frame);
+                        }
+                    });
+                } else if (type == "ack" && busy && !*acknowledged) {
+                    *acknowledged = true;
+                    qInfo() << "🔁 Стан передано новому процесу";
+                    emit handedOff();
+                }
+            }
+            if (error) {
+                qWarning() << "❌ Некоректний кадр передачі стану";
+                socket->abort();
+            }
+        });
+
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket, acknowledged]() {
+            socket->deleteLater();
+            if (busy && !*acknowledged) {
+                qWarning() << "⚠️ Новий процес від'єднався до підтвердження — продовжуємо роботу";
+                busy = false;
+                listen();
+                emit aborted();
+            }
+        });
+    }
+}
+
+HandoffClient::HandoffClient(const QString &name, QObject *parent)
+    : QObject(parent), name(name) {
+    timeout.setSingleShot(true);
+    connect(&timeout, &QTimer::timeout, this, [this]() {
+        fail("час очікування вичерпано");
+    });
+
+    connect(&socket, &QLocalSocket::connected, this, [this]() {
+        writeFrame(&socket, QJsonObject{{"type", "hello"}});
+    });
+
+    connect(&socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError) {
+        fail(socket.errorString());
+    });
+
+    connect(&socket, &QLocalSocket::readyRead, this, [this]() {
+        buffer.append(socket.readAll());
+
+        QJsonObject frame;
+        bool error = false;
+        while (!done && readFrame(buffer, &frame, &error)) {
+            if (frame["type"].toString() == "state") {
+                done = true;
+                timeout.stop();
+                emit stateReceived(frame);
+            }
+        }
+        if (error) {
+            fail("некоректний кадр");
+        }
+    });
+}
+
+void HandoffClient::start(int timeoutMs) {
+    qInfo() << "🔁 Під'єднуємося до процесу, що працює, через" << name;
+    timeout.start(timeoutMs);
+    socket.connectToServer(name);
+}
+
+void HandoffClient::acknowledge() {
+    writeFrame(&socket, QJsonObject{{"type", "ack"}});
+    socket.disconnectFromServer();   // Дочекається запису ack
+}
+
+void HandoffClient::fail(const QString &reason) {
+    if (done) {
+        return;
+    }
+    done = true;
+    timeout.stop();
+    socket.abort();
+    qWarning() << "⚠️ Передача стану неможлива:" << reason << "— холодний старт";
+    emit unavailable(reason);
+}
@@ -0,0 +1,68 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonObject>
+#include <QTimer>
+#include <QPointer>
+#include <functional>
+
+/**
+ * @brief Передача стану між старим і новим процесом під час оновлення.
+ *
+ * Кадри по QLocalSocket: u32 довжина (big-endian) + компактний JSON.
+ *   новий → старий: {"type": "hello"}
+ *   старий → новий: {"type": "state", ...}   — стан Bot (Bot::exportState)
+ *   новий → старий: {"type": "ack"}
+ * Після hello старий процес перестає опитувати Telegram: непідтверджені
+ * оновлення Telegram віддасть новому процесу з переданого offset. Після ack
+ * старий дочищає вихідні черги і завершується.
+ */
+class HandoffServer : public QObject {
+    Q_OBJECT
+public:
+    using Ready = std::function<void(const QJsonObject &state)>;
+    using Prepare = std::function<void(Ready ready)>;   // Зупинити роботу і віддати стан
+
+    HandoffServer(const QString &name, Prepare prepare, QObject *parent = nullptr);
+
+    bool listen();
+
+signals:
+    void handedOff();   // Новий процес прийняв стан
+    void aborted();     // Новий процес зник до ack — старий продовжує роботу
+
+private:
+    void onConnection();
+
+    QLocalServer server;
+    QString name;
+    Prepare prepare;
+    bool busy = false;
+};
+
+class HandoffClient : public QObject {
+    Q_OBJECT
+public:
+    explicit HandoffClient(const QString &name, QObject *parent = nullptr);
+
+    void start(int timeoutMs);   // Під'єднатися до процесу, що працює зараз
+    void acknowledge();          // Стан застосовано — старий процес може завершуватися
+
+signals:
+    void stateReceived(const QJsonObject &state);
+    void unavailable(const QString &reason);   // Холодний старт
+
+private:
+    void fail(const QString &reason);
+
+    QLocalSocket socket;
+    QString name;
+    QByteArray buffer;
+    QTimer timeout;
+    bool done = false;
+};
+
+#endif // HANDOFF_H
@@ -0,0 +1,167 @@
+#include "jsonarraystream.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+
+static const qsizetype kMaxPrefixBytes = 64 * 1024;   // Заголовок документа до масиву
+static const qsizetype kMaxElementBytes = 1024 * 1024; // Один елемент масиву
+
+static bool isJsonSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+JsonArrayStream::JsonArrayStream(const QByteArray &arrayKey, ElementCallback onElement)
+    : m_key(arrayKey), m_onElement(std::move(onElement)) {}
+
+bool JsonArrayStream::fail(const QString &error) {
+    if (m_error.isEmpty()) {
+        m_error = error;
+    }
+    return false;
+}
+
+bool JsonArrayStream::emitElement() {
+    QJsonParseError parseError;
+    QJsonValue value;
+    if (m_element.startsWith('{') || m_element.startsWith('[')) {
+        const QJsonDocument jsonDoc = QJsonDocument::fromJson(m_element, &parseError);
+        value = jsonDoc.isObject() ? QJsonValue(jsonDoc.object()) : QJsonValue(jsonDoc.array());
+    } else {
+        // 🔹 Скаляр: QJsonDocument розбирає лише об'єкти й масиви
+        const QJsonArray wrapped = QJsonDocument::fromJson("[" + m_element + "]", &parseError).array();
+        if (parseError.error == QJsonParseError::NoError && wrapped.size() != 1) {
+            return fail("Invalid JSON array element");
+        }
+        value = wrapped.isEmpty() ? QJsonValue() : wrapped.first();
+    }
+    if (parseError.error != QJsonParseError::NoError) {
+        return fail("Invalid JSON array element: " + parseError.errorString());
+    }
+    m_element.clear();
+    ++m_elements;
+    m_onElement(value);
+    return true;
+}
+
+/**
+ * @brief Подає чергову частину документа
+ * @param chunk Байти JSON у порядку надходження
+ */
+bool JsonArrayStream::feed(const QByteArray &chunk) {
+    if (!m_error.isEmpty()) {
+        return false;
+    }
+
+    for (char c : chunk) {
+        switch (m_phase) {
+        case Phase::Seek:
+            m_prefix += c;
+            if (m_prefix.size() > kMaxPrefixBytes) {
+                return fail("JSON prefix too large");
+            }
+
+            if (m_inString) {
+                if (m_escape) {
+                    m_escape = false;
+                } else if (c == '\\') {
+                    m_escape = true;
+                } else if (c == '"') {
+                    m_inString = false;
+                    if (m_depth == 1) {
+                        m_lastString = m_prefix.mid(m_stringStart, m_prefix.size() - 1 - m_stringStart);
+                    }
+                }
+                continue;
+            }
+
+            if (c == '"') {
+                m_inString = true;
+                m_stringStart = m_prefix.size();
+            } else if (c == ':' && m_depth == 1) {
+                m_currentKey = m_lastString;
+            } else if (c == ',' && m_depth == 1) {
+                m_currentKey.clear();
+            } else if (c == '{' || c == '[') {
+                if (c == '[' && m_depth == 1 && m_currentKey == m_key) {
+                    m_prefix.chop(1);  // Масив у конверт не потрапляє
+                    m_phase = Phase::Array;
+                }
+                ++m_depth;
+            } else if (c == '}' || c == ']') {
+                --m_depth;
+            }
+            break;
+
+        case Phase::Array:
+            // 🔹 До гілки рядка: одне величезне рядкове значення теж обмежене
+            if (m_element.size() >= kMaxElementBytes) {
+                return fail("JSON array element too large");
+            }
+
+            if (m_inString) {
+                m_element += c;
+                if (m_escape) {
+                    m_escape = false;
+                } else if (c == '\\') {
+                    m_escape = true;
+                } else if (c == '"') {
+                    m_inString = false;
+                }
+                continue;
+            }
+
+            if (m_depth == 2) {
+                // 🔹 Між елементами або в кінці скалярного елемента
+                if (c == ',' || c == ']' || isJsonSpace(c)) {
+                    if (!m_element.isEmpty() && !emitElement()) {
+                        return false;
+                    }
+                    if (c == ']') {
+                        m_depth = 1;
+                        m_phase = Phase::Done;
+                        m_prefix += "null";  // Конверт лишається валідним JSON
+                    }
+                    continue;
+                }
+            }
+
+            m_element += c;
+
+            if (c == '"') {
+                m_inString = true;
+            } else if (c == '{' || c == '[') {
+                ++m_depth;
+            } else if (c == '}' || c == ']') {
+                --m_depth;
+                if (m_depth == 2 && !emitElement()) {
+                    return false;
+                }
+            }
+            break;
+
+        case Phase::Done:
+            // 🔹 Решта конверта: зазвичай лише закриваюча дужка
+            if (m_prefix.size() < kMaxPrefixBytes) {
+                m_prefix += c;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+bool JsonArrayStream::finish() {
+    if (!m_error.isEmpty()) {
+        return false;
+    }
+    if (m_phase == Phase::Array) {
+        return fail("JSON array is truncated");
+    }
+    if (m_phase == Phase::Seek && !QJsonDocument::fromJson(m_prefix).isObject()) {
+        return fail("Invalid JSON document");
+    }
+    return true;
+}
+
+QJsonObject JsonArrayStream::envelope() const {
+    return QJsonDocument::fromJson(m_prefix).object();
+}
@@ -0,0 +1,53 @@
+#ifndef JSONARRAYSTREAM_H
+#define JSONARRAYSTREAM_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief Інкрементальний розбір масиву верхнього рівня JSON-об'єкта.
+ *
+ * Для відповіді виду {"azs_list": [ {...}, {...} ]} віддає елементи масиву
+ * по одному, щойно вони повністю надійшли. У пам'яті тримається лише
+ * поточний елемент, а не весь документ.
+ */
+class JsonArrayStream {
+public:
+    using ElementCallback = std::function<void(const QJsonValue &)>;
+
+    explicit JsonArrayStream(const QByteArray &arrayKey, ElementCallback onElement);
+
+    bool feed(const QByteArray &chunk);     // false — документ некоректний
+    bool finish();                          // Кінець даних: перевіряє, що документ завершено
+
+    bool arrayFound() const { return m_phase != Phase::Seek; }
+    int elementCount() const { return m_elements; }
+    QJsonObject envelope() const;           // Об'єкт без масиву (наприклад, {"error": ...})
+    QString errorString() const { return m_error; }
+
+private:
+    enum class Phase { Seek, Array, Done };
+
+    bool fail(const QString &error);
+    bool emitElement();                     // false — елемент не є валідним JSON
+
+    QByteArray m_key;
+    ElementCallback m_onElement;
+    Phase m_phase = Phase::Seek;
+
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escape = false;
+    QByteArray m_prefix;        // Байти до масиву: ключі, можливе повідомлення про помилку
+    qsizetype m_stringStart = -1;
+    QByteArray m_lastString;    // Останній рядок на глибині 1 (кандидат у ключ)
+    QByteArray m_currentKey;
+    QByteArray m_element;       // Поточний незавершений елемент масиву
+    int m_elements = 0;
+    QString m_error;
+};
+
+#endif // JSONARRAYSTREAM_H
@@ -0,0 +1,534 @@
+#include "localsocketnetworkmanager.h"
+#include "config.h"
+#include <QNetworkReply>
+#include <QLocalSocket>
+#include <QTimer>
+#include <QDebug>
+#include <utility>
+
+/**
+ * @brief Код помилки QNetworkReply для HTTP-статусу, як у QNetworkAccessManager
+ */
+static QNetworkReply::NetworkError httpError(int status) {
+    switch (status) {
+    case 401: return QNetworkReply::AuthenticationRequiredError;
+    case 403: return QNetworkReply::ContentAccessDenied;
+    case 404: return QNetworkReply::ContentNotFoundError;
+    case 405: return QNetworkReply::ContentOperationNotPermittedError;
+    case 409: return QNetworkReply::ContentConflictError;
+    case 410: return QNetworkReply::ContentGoneError;
+    case 500: return QNetworkReply::InternalServerError;
+    case 501: return QNetworkReply::OperationNotImplementedError;
+    case 503: return QNetworkReply::ServiceUnavailableError;
+    }
+    return status >= 500 ? QNetworkReply::UnknownServerError : QNetworkReply::UnknownContentError;
+}
+
+static QNetworkReply::NetworkError socketError(QLocalSocket::LocalSocketError error) {
+    switch (error) {
+    case QLocalSocket::ServerNotFoundError: return QNetworkReply::HostNotFoundError;
+    case QLocalSocket::ConnectionRefusedError: return QNetworkReply::ConnectionRefusedError;
+    case QLocalSocket::PeerClosedError: return QNetworkReply::RemoteHostClosedError;
+    case QLocalSocket::SocketTimeoutError: return QNetworkReply::TimeoutError;
+    default: return QNetworkReply::UnknownNetworkError;
+    }
+}
+
+/**
+ * @brief Відповідь на запит через локальний сокет; тіло віддається з readyRead у міру надходження
+ */
+class LocalHttpReply : public QNetworkReply {
+public:
+    LocalHttpReply(const QNetworkRequest &request, LocalSocketNetworkManager *manager)
+        : QNetworkReply(manager), manager(manager) {
+        setRequest(request);
+        setUrl(request.url());
+        setOperation(QNetworkAccessManager::GetOperation);
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+        pipelining = request.attribute(QNetworkRequest::HttpPipeliningAllowedAttribute).toBool();
+
+        // 🔹 Transfer timeout, як у QNetworkAccessManager: відлік з початку і після кожної частини тіла
+        int timeoutMs = request.transferTimeout();
+        if (timeoutMs == 0) {
+            timeoutMs = manager->transferTimeout();
+        }
+        if (timeoutMs > 0) {
+            transferTimer.setSingleShot(true);
+            transferTimer.setInterval(timeoutMs);
+            QObject::connect(&transferTimer, &QTimer::timeout, this, [this]() { abort(); });
+            transferTimer.start();
+        }
+    }
+
+    QByteArray requestBytes() const {
+        const QUrl url = request().url();
+        QByteArray target = url.path(QUrl::FullyEncoded).toLatin1();
+        if (target.isEmpty()) {
+            target = "/";
+        }
+        if (url.hasQuery()) {
+            target += "?" + url.query(QUrl::FullyEncoded).toLatin1();
+        }
+
+        QByteArray head = "GET " + target + " HTTP/1.1\r\nHost: " + url.host(QUrl::FullyEncoded).toLatin1();
+        if (url.port() != -1) {
+            head += ":" + QByteArray::number(url.port());
+        }
+        head += "\r\n";
+        const QList<QByteArray> names = request().rawHeaderList();
+        for (const QByteArray &name : names) {
+            const QByteArray lower = name.toLower();
+            if (lower != "host" && lower != "connection") {
+                head += name + ": " + request().rawHeader(name) + "\r\n";
+            }
+        }
+        head += "Connection: keep-alive\r\n\r\n";
+        return head;
+    }
+
+    void setHead(int status, const QByteArray &reason, const QList<QPair<QByteArray, QByteArray>> &headers) {
+        responded = true;
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, status);
+        setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, reason);
+        for (const auto &header : headers) {
+            setRawHeader(header.first, header.second);
+        }
+        if (status >= 400) {
+            setError(httpError(status), QString("HTTP %1 %2").arg(status).arg(QString::fromLatin1(reason)));
+        }
+        emit metaDataChanged();
+    }
+
+    void appendBody(const QByteArray &data) {
+        content += data;
+        if (transferTimer.isActive()) {
+            transferTimer.start();
+        }
+        emit readyRead();
+    }
+
+    void complete() {
+        transferTimer.stop();
+        if (error() != QNetworkReply::NoError) {
+            emit errorOccurred(error());
+        }
+        setFinished(true);
+        emit finished();
+    }
+
+    void fail(NetworkError code, const QString &text) {
+        transferTimer.stop();
+        setError(code, text);
+        emit errorOccurred(code);
+        setFinished(true);
+        emit finished();
+    }
+
+    void abort() override;
+
+    qint64 bytesAvailable() const override {
+        return content.size() + QIODevice::bytesAvailable();
+    }
+
+    bool isSequential() const override { return true; }
+
+    LocalSocketNetworkManager *manager;
+    QPointer<LocalHttpConnection> connection;   // Де запит у польоті (порожньо — у черзі)
+    bool pipelining = false;                    // HttpPipeliningAllowedAttribute
+    bool responded = false;                     // Почала надходити відповідь — повторити вже не можна
+    int attempts = 0;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override {
+        qint64 count = qMin(maxSize, qint64(content.size()));
+        if (count <= 0) {
+            return isFinished() ? -1 : 0;
+        }
+        memcpy(data, content.constData(), size_t(count));
+        content.remove(0, count);
+        return count;
+    }
+
+private:
+    QByteArray content;
+    QTimer transferTimer;
+};
+
+/**
+ * @brief Одне keep-alive з'єднання пулу: запити пишуться одразу, відповіді розбираються по черзі (FIFO)
+ */
+class LocalHttpConnection : public QObject {
+public:
+    explicit LocalHttpConnection(LocalSocketNetworkManager *manager)
+        : QObject(manager), manager(manager), socket(new QLocalSocket(this)) {
+        connect(socket, &QLocalSocket::connected, this, [this]() {
+            connected = true;
+            socket->write(pendingWrite);
+            pendingWrite.clear();
+        });
+        connect(socket, &QLocalSocket::readyRead, this, [this]() {
+            buffer += socket->readAll();
+            parse();
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this]() {
+            // 🔹 Відповідь без Content-Length закінчується закриттям з'єднання
+            if (state == State::Body && untilClose && !inFlight.isEmpty()) {
+                finishResponse();
+            }
+            close(QNetworkReply::RemoteHostClosedError, "Palantír closed the connection");
+        });
+        connect(socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError error) {
+            if (error != QLocalSocket::PeerClosedError) {
+                close(socketError(error), socket->errorString());
+            }
+        });
+    }
+
+    void connectTo(const QString &socketName) {
+        socket->connectToServer(socketName);
+    }
+
+    int load() const { return int(inFlight.size()); }
+
+    bool accepts(const LocalHttpReply *reply, int depth) const {
+        if (closing) {
+            return false;
+        }
+        if (inFlight.isEmpty()) {
+            return true;
+        }
+        if (!reply->pipelining || !keepAlive || inFlight.size() >= depth) {
+            return false;
+        }
+        for (const QPointer<LocalHttpReply> &other : inFlight) {
+            if (other && !other->pipelining) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void send(LocalHttpReply *reply) {
+        reply->connection = this;
+        ++reply->attempts;
+        inFlight.append(reply);
+        if (connected) {
+            socket->write(reply->requestBytes());
+        } else {
+            pendingWrite += reply->requestBytes();
+        }
+    }
+
+    // 🔹 Запит скасовано посеред конвеєра: його відповідь ще прийде, з'єднання більше не узгоджене
+    void abandon(LocalHttpReply *reply) {
+        inFlight.removeAll(reply);
+        reply->connection = nullptr;
+        close(QNetworkReply::OperationCanceledError, "Pipelined request was aborted", true);
+    }
+
+private:
+    enum class State { StatusLine, Headers, Body, ChunkSize, ChunkData, ChunkEnd, Trailers };
+
+    void parse() {
+        while (!closing) {
+            if (state == State::Body || state == State::ChunkData) {
+                if (buffer.isEmpty()) {
+                    return;
+                }
+                const qint64 count = untilClose ? buffer.size() : qMin<qint64>(remaining, buffer.size());
+                deliver(buffer.left(count));
+                buffer.remove(0, count);
+                if (closing || untilClose) {
+                    return;
+                }
+                remaining -= count;
+                if (remaining == 0) {
+                    if (state == State::Body) {
+                        finishResponse();
+                    } else {
+                        state = State::ChunkEnd;
+                    }
+                }
+                continue;
+            }
+
+            if (state == State::ChunkEnd) {
+                if (buffer.size() < 2) {
+                    return;
+                }
+                buffer.remove(0, 2);
+                state = State::ChunkSize;
+                continue;
+            }
+
+            const qsizetype lineEnd = buffer.indexOf("\r\n");
+            if (lineEnd < 0) {
+                return;
+            }
+            const QByteArray line = buffer.left(lineEnd);
+            buffer.remove(0, lineEnd + 2);
+
+            switch (state) {
+            case State::StatusLine:
+                if (!parseStatusLine(line)) {
+                    close(QNetworkReply::ProtocolFailure, "Malformed HTTP status line");
+                    return;
+                }
+                break;
+            case State::Headers:
+                if (!line.isEmpty()) {
+                    parseHeader(line);
+                } else {
+                    beginBody();
+                }
+                break;
+            case State::ChunkSize: {
+                bool ok = false;
+                remaining = line.split(';').first().trimmed().toLongLong(&ok, 16);
+                if (!ok) {
+                    close(QNetworkReply::ProtocolFailure, "Malformed chunk size");
+                    return;
+                }
+                state = remaining == 0 ? State::Trailers : State::ChunkData;
+                break;
+            }
+            case State::Trailers:
+                if (line.isEmpty()) {
+                    finishResponse();
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    bool parseStatusLine(const QByteArray &line) {
+        const QList<QByteArray> parts = line.split(' ');
+        if (parts.size() < 2 || !parts[0].startsWith("HTTP/1.") || inFlight.isEmpty()) {
+            return false;
+        }
+        status = parts[1].toInt();
+        reason = line.mid(parts[0].size() + parts[1].size() + 2);
+        headers.clear();
+        contentLength = -1;
+        chunked = false;
+        untilClose = false;
+        keepAlive = !parts[0].startsWith("HTTP/1.0");
+        state = State::Headers;
+        return true;
+    }
+
+    void parseHeader(const QByteArray &line) {
+        const qsizetype colon = line.indexOf(':');
+        if (colon <= 0) {
+            return;
+        }
+        const QByteArray name = line.left(colon).trimmed();
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        const QByteArray lower = name.toLower();
+        if (lower == "content-length") {
+            contentLength = value.toLongLong();
+        } else if (lower == "transfer-encoding") {
+            chunked = value.toLower().contains("chunked");
+        } else if (lower == "connection") {
+            keepAlive = value.toLower() != "close";
+        }
+        headers.append({ name, value });
+    }
+
+    void beginBody() {
+        if (LocalHttpReply *reply = inFlight.first()) {
+            reply->setHead(status, reason, headers);
+            if (closing) {
+                return;
+            }
+        }
+
+        if (chunked) {
+            state = State::ChunkSize;
+        } else if (contentLength >= 0) {
+            remaining = contentLength;
+            state = State::Body;
+            if (remaining == 0) {
+                finishResponse();
+            }
+        } else {
+            untilClose = true;
+            keepAlive = false;
+            state = State::Body;
+        }
+    }
+
+    void deliver(const QByteArray &data) {
+        if (LocalHttpReply *reply = inFlight.first()) {
+            reply->appendBody(data);
+        }
+    }
+
+    void finishResponse() {
+        state = State::StatusLine;
+        QPointer<LocalHttpReply> reply = inFlight.takeFirst();
+        if (reply) {
+            reply->connection = nullptr;
+            reply->complete();
+        }
+        if (!keepAlive) {
+            close(QNetworkReply::RemoteHostClosedError, "Palantír closed the connection");
+            return;
+        }
+        manager->scheduleDispatch();
+    }
+
+    // 🔹 Запити без відповіді повторюються на іншому з'єднанні (GET ідемпотентний), решта — з помилкою
+    // @param retry Повторювати навіть без встановленого з'єднання (закрито через скасування, а не збій)
+    void close(QNetworkReply::NetworkError error, const QString &text, bool retry = false) {
+        if (closing) {
+            return;
+        }
+        closing = true;
+        socket->disconnect(this);
+        socket->abort();
+
+        const QList<QPointer<LocalHttpReply>> replies = std::exchange(inFlight, {});
+        for (auto it = replies.crbegin(); it != replies.crend(); ++it) {   // requeue ставить на початок черги
+            LocalHttpReply *reply = *it;
+            if (!reply || reply->isFinished()) {
+                continue;
+            }
+            reply->connection = nullptr;
+            if ((connected || retry) && !reply->responded && reply->attempts < 2) {
+                manager->requeue(reply);
+            } else {
+                reply->fail(error, text);
+            }
+        }
+        manager->removeConnection(this);
+        deleteLater();
+    }
+
+    LocalSocketNetworkManager *manager;
+    QLocalSocket *socket;
+    QList<QPointer<LocalHttpReply>> inFlight;   // Надіслані запити в порядку відповідей
+    QByteArray pendingWrite;                    // Запити, написані до встановлення з'єднання
+    QByteArray buffer;
+    bool connected = false;
+    bool closing = false;
+
+    State state = State::StatusLine;
+    int status = 0;
+    QByteArray reason;
+    QList<QPair<QByteArray, QByteArray>> headers;
+    qint64 contentLength = -1;
+    qint64 remaining = 0;
+    bool chunked = false;
+    bool untilClose = false;
+    bool keepAlive = true;
+};
+
+void LocalHttpReply::abort() {
+    if (isFinished()) {
+        return;
+    }
+    if (connection) {
+        connection->abandon(this);
+    } else {
+        manager->forget(this);
+    }
+    fail(QNetworkReply::OperationCanceledError, "Operation canceled");
+}
+
+LocalSocketNetworkManager::LocalSocketNetworkManager(QObject *parent)
+    : QNetworkAccessManager(parent) {}
+
+bool LocalSocketNetworkManager::routesToSocket(Operation op, const QUrl &url) const {
+    const ConfigSnapshot &config = Config::current();
+    if (op != GetOperation || config.palantirSocket.isEmpty()) {
+        return false;
+    }
+    const QUrl base(config.palantirBaseUrl);
+    return url.host() == base.host() && url.port(80) == base.port(80);
+}
+
+QNetworkReply *LocalSocketNetworkManager::createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData) {
+    if (!routesToSocket(op, request.url())) {
+        return QNetworkAccessManager::createRequest(op, request, outgoingData);
+    }
+
+    auto *reply = new LocalHttpReply(request, this);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() { emit finished(reply); });
+    ++m_requests;
+    m_queue.append(reply);
+    scheduleDispatch();   // Після повернення: виклик ще має під'єднатися до сигналів відповіді
+    return reply;
+}
+
+void LocalSocketNetworkManager::scheduleDispatch() {
+    if (m_dispatchScheduled) {
+        return;
+    }
+    m_dispatchScheduled = true;
+    QMetaObject::invokeMethod(this, &LocalSocketNetworkManager::dispatch, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Віддає запити з черги на вільні з'єднання; поки пул не повний, нове з'єднання
+ *        краще за конвеєр на зайнятому
+ */
+void LocalSocketNetworkManager::dispatch() {
+    m_dispatchScheduled = false;
+    const ConfigSnapshot &config = Config::current();
+    const int maxConnections = qMax(1, config.palantirSocketConnections);
+    const int depth = qMax(1, config.palantirSocketPipeline);
+
+    while (!m_queue.isEmpty()) {
+        LocalHttpReply *reply = m_queue.first();
+        if (!reply || reply->isFinished()) {
+            m_queue.removeFirst();
+            continue;
+        }
+
+        LocalHttpConnection *target = nullptr;
+        for (LocalHttpConnection *connection : std::as_const(m_connections)) {
+            if (connection->accepts(reply, depth) && (!target || connection->load() < target->load())) {
+                target = connection;
+            }
+        }
+        if (target && target->load() > 0 && m_connections.size() < maxConnections) {
+            target = nullptr;
+        }
+        if (!target) {
+            if (m_connections.size() >= maxConnections) {
+                break;   // Чекаємо на відповідь на одному з з'єднань
+            }
+            // 🔹 Помилка підключення може прийти синхронно — запит уже має бути на з'єднанні
+            target = new LocalHttpConnection(this);
+            m_connections.append(target);
+            ++m_opened;
+            m_queue.removeFirst();
+            target->send(reply);
+            target->connectTo(config.palantirSocket);
+            continue;
+        }
+
+        m_queue.removeFirst();
+        if (target->load() > 0) {
+            ++m_pipelined;
+        }
+        target->send(reply);
+    }
+}
+
+void LocalSocketNetworkManager::requeue(LocalHttpReply *reply) {
+    m_queue.prepend(reply);
+    scheduleDispatch();
+}
+
+void LocalSocketNetworkManager::forget(LocalHttpReply *reply) {
+    m_queue.removeAll(reply);
+}
+
+void LocalSocketNetworkManager::removeConnection(LocalHttpConnection *connection) {
+    m_connections.removeAll(connection);
+    scheduleDispatch();
+}
@@ -0,0 +1,52 @@
+#ifndef LOCALSOCKETNETWORKMANAGER_H
+#define LOCALSOCKETNETWORKMANAGER_H
+
+#include <QNetworkAccessManager>
+#include <QPointer>
+#include <QList>
+
+class LocalHttpConnection;
+class LocalHttpReply;
+
+/**
+ * @brief Транспорт до Palantír на тому ж хості: HTTP/1.1 через Unix domain socket.
+ *
+ * Коли в [Palantir] задано socket, GET-запити на base_url ідуть через пул
+ * QLocalSocket-з'єднань (socket_connections) в обхід loopback TCP; запити з
+ * HttpPipeliningAllowedAttribute можуть чекати на зайнятому з'єднанні до
+ * socket_pipeline штук. Усе інше (Telegram, порожній socket) — звичайний
+ * QNetworkAccessManager, тож транспорт перемикається перезавантаженням конфігурації.
+ */
+class LocalSocketNetworkManager : public QNetworkAccessManager {
+    Q_OBJECT
+public:
+    explicit LocalSocketNetworkManager(QObject *parent = nullptr);
+
+    quint64 localRequests() const { return m_requests; }       // Запитів через сокет
+    quint64 pipelinedRequests() const { return m_pipelined; }  // Надіслано, поки з'єднання чекало попередню відповідь
+    quint64 connectionsOpened() const { return m_opened; }
+    int openConnections() const { return int(m_connections.size()); }
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData) override;
+
+private:
+    friend class LocalHttpConnection;
+    friend class LocalHttpReply;
+
+    bool routesToSocket(Operation op, const QUrl &url) const;
+    void scheduleDispatch();
+    void dispatch();                                      // Розподіляє чергу по з'єднаннях пулу
+    void requeue(LocalHttpReply *reply);                  // Запит обірваного з'єднання, на який ще не було відповіді
+    void forget(LocalHttpReply *reply);                   // Скасовано в черзі
+    void removeConnection(LocalHttpConnection *connection);
+
+    QList<LocalHttpConnection *> m_connections;
+    QList<QPointer<LocalHttpReply>> m_queue;              // Чекають на вільне з'єднання
+    bool m_dispatchScheduled = false;
+    quint64 m_requests = 0;
+    quint64 m_pipelined = 0;
+    quint64 m_opened = 0;
+};
+
+#endif // LOCALSOCKETNETWORKMANAGER_H
@@ -0,0 +1,142 @@
+#include "loopmonitor.h"
+#include <QThread>
+#include <QDebug>
+
+std::atomic<const char *> LoopMonitor::s_activity{nullptr};
+QThread *LoopMonitor::s_mainThread = nullptr;
+
+LoopMonitor::Activity::Activity(const char *name) {
+    // Позначки інших потоків не перетирають позначку головного
+    if (s_mainThread && QThread::currentThread() == s_mainThread) {
+        m_previous = s_activity.exchange(name, std::memory_order_relaxed);
+        m_active = true;
+    }
+}
+
+LoopMonitor::Activity::~Activity() {
+    if (m_active) {
+        s_activity.store(m_previous, std::memory_order_relaxed);
+    }
+}
+
+LoopMonitor::LoopMonitor(QObject *parent) : QObject(parent) {
+    s_mainThread = thread();
+    m_probe.setTimerType(Qt::PreciseTimer);
+    connect(&m_probe, &QTimer::timeout, this, &LoopMonitor::probe);
+}
+
+LoopMonitor::~LoopMonitor() {
+    stop();
+    s_mainThread = nullptr;
+}
+
+/**
+ * @brief Запускає пробу і потік-сторож
+ * @param probeMs Інтервал проби
+ * @param stallThresholdMs Затримка, починаючи з якої це зависання
+ */
+void LoopMonitor::start(int probeMs, int stallThresholdMs) {
+    stop();
+
+    m_probeMs = qMax(1, probeMs);
+    m_thresholdMs = qMax(m_probeMs * 2, stallThresholdMs);
+    m_clock.start();
+    m_expectedAt = m_probeMs;
+    m_heartbeat.store(0);
+    m_probe.start(m_probeMs);
+
+    m_watcher = QThread::create([this]() { watch(); });
+    m_watcher->setObjectName("LoopWatchdog");
+    m_watcher->start();
+}
+
+void LoopMonitor::stop() {
+    m_probe.stop();
+    if (m_watcher) {
+        m_stopping.store(true);
+        m_watcher->wait();
+        delete m_watcher;
+        m_watcher = nullptr;
+        m_stopping.store(false);
+    }
+}
+
+void LoopMonitor::probe() {
+    const qint64 now = m_clock.elapsed();
+    const qint64 lag = qMax<qint64>(0, now - m_expectedAt);
+    m_expectedAt = now + m_probeMs;
+    m_heartbeat.store(now, std::memory_order_relaxed);
+
+    int bucket = 0;
+    for (qint64 bound = 1; bucket < kBuckets - 1 && lag >= bound; bound <<= 1) {
+        ++bucket;
+    }
+    ++m_buckets[size_t(bucket)];
+    ++m_samples;
+    m_maxLagMs = qMax(m_maxLagMs, lag);
+
+    const char *activity = m_stallActivity.exchange(nullptr);
+    if (lag < m_thresholdMs) {
+        return;
+    }
+
+    ++m_stalls;
+    m_lastStall.durationMs = lag;
+    m_lastStall.activity = activity ? QString::fromUtf8(activity) : QString("невідомо");
+    m_lastStall.at = QDateTime::currentDateTime();
+
+    qWarning() << "🐢 Цикл подій стояв" << lag << "мс, обробник:" << m_lastStall.activity;
+    emit stalled(lag, m_lastStall.activity);
+}
+
+/**
+ * @brief Потік-сторож: помічає, що проба давно не спрацьовувала, поки зависання ще триває
+ */
+void LoopMonitor::watch() {
+    const unsigned long checkMs = qMax(5, m_thresholdMs / 4);
+    bool reported = false;
+
+    while (!m_stopping.load()) {
+        QThread::msleep(checkMs);
+
+        const qint64 silentMs = m_clock.elapsed() - m_heartbeat.load(std::memory_order_relaxed);
+        if (silentMs < m_thresholdMs) {
+            reported = false;
+            continue;
+        }
+        if (reported) {
+            continue;
+        }
+
+        reported = true;
+        const char *activity = s_activity.load(std::memory_order_relaxed);
+        m_stallActivity.store(activity ? activity : "поза позначеними обробниками");
+        qWarning() << "🐢 Головний потік не відповідає вже" << silentMs << "мс, обробник:"
+                   << (activity ? activity : "невідомо");
+    }
+}
+
+/**
+ * @brief Верхня межа кошика, до якого включно набирається частка fraction усіх проб
+ */
+qint64 LoopMonitor::percentileMs(double fraction) const {
+    if (m_samples == 0) {
+        return 0;
+    }
+    const quint64 target = quint64(fraction * double(m_samples));
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += m_buckets[size_t(bucket)];
+        if (seen > target || bucket == kBuckets - 1) {
+            return bucket == kBuckets - 1 ? m_maxLagMs : (qint64(1) << bucket);
+        }
+    }
+    return m_maxLagMs;
+}
+
+QString LoopMonitor::bucketTitle(int bucket) {
+    if (bucket >= kBuckets - 1) {
+        return QString("≥%1 мс").arg(qint64(1) << (kBuckets - 2));
+    }
+    return QString("<%1 мс").arg(qint64(1) << bucket);
+}
@@ -0,0 +1,89 @@
+#ifndef LOOPMONITOR_H
+#define LOOPMONITOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QString>
+#include <QDateTime>
+#include <atomic>
+#include <array>
+
+class QThread;
+
+/**
+ * @brief Затримка циклу подій головного потоку і виявлення зависань.
+ *
+ * Частий таймер-проба вимірює, наскільки пізніше за план він спрацював, і
+ * складає це в гістограму зі степенів двійки. Окремий потік-сторож бачить,
+ * що проба давно не спрацьовувала, і ще під час зависання запам'ятовує,
+ * який обробник (LoopMonitor::Activity) виконується в головному потоці.
+ */
+class LoopMonitor : public QObject {
+    Q_OBJECT
+public:
+    static const int kBuckets = 12;   // <1, <2, <4, ... <1024 мс, далі — усе довше
+
+    // 🔹 Позначка обробника, що зараз виконується в головному потоці (рядковий літерал)
+    class Activity {
+    public:
+        explicit Activity(const char *name);
+        ~Activity();
+        Activity(const Activity &) = delete;
+        Activity &operator=(const Activity &) = delete;
+    private:
+        const char *m_previous = nullptr;
+        bool m_active = false;
+    };
+
+    struct Stall {
+        qint64 durationMs = 0;
+        QString activity;
+        QDateTime at;
+    };
+
+    explicit LoopMonitor(QObject *parent = nullptr);
+    ~LoopMonitor() override;
+
+    void start(int probeMs, int stallThresholdMs);
+    void stop();
+
+    std::array<quint64, kBuckets> histogram() const { return m_buckets; }
+    qint64 percentileMs(double fraction) const;   // Верхня межа кошика, в який потрапляє частка проб
+    qint64 maxLagMs() const { return m_maxLagMs; }
+    quint64 samples() const { return m_samples; }
+    quint64 stallCount() const { return m_stalls; }
+    Stall lastStall() const { return m_lastStall; }
+
+    static QString bucketTitle(int bucket);
+
+signals:
+    void stalled(qint64 durationMs, const QString &activity);   // Після того, як цикл подій відновився
+
+private:
+    void probe();
+    void watch();
+
+    static std::atomic<const char *> s_activity;
+    static QThread *s_mainThread;
+
+    QTimer m_probe;
+    QElapsedTimer m_clock;
+    qint64 m_expectedAt = 0;
+    int m_probeMs = 10;
+    int m_thresholdMs = 200;
+
+    std::array<quint64, kBuckets> m_buckets{};
+    quint64 m_samples = 0;
+    qint64 m_maxLagMs = 0;
+    quint64 m_stalls = 0;
+    Stall m_lastStall;
+
+    // 🔹 Спільне з потоком-сторожем
+    QThread *m_watcher = nullptr;
+    std::atomic<bool> m_stopping{false};
+    std::atomic<qint64> m_heartbeat{0};
+    std::atomic<const char *> m_stallActivity{nullptr};   // Обробник, захоплений сторожем під час зависання
+};
+
+#endif // LOOPMONITOR_H
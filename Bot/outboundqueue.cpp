@@ -0,0 +1,201 @@
+#include "outboundqueue.h"
+#include "config.h"
+#include <QTimer>
+#include <QIODevice>
+#include <QDebug>
+
+static const int kTelegramTextLimit = 4096;   // Найдовший текст одного повідомлення
+
+OutboundQueue::OutboundQueue(TelegramApi *telegram, QObject *parent)
+    : QObject(parent), telegram(telegram) {}
+
+/**
+ * @brief Надсилає текст, дописуючи його до ще не відправленого тексту цього чату
+ * @param isHtml parse_mode HTML
+ */
+void OutboundQueue::text(qint64 chatId, const QString &text, bool isHtml) {
+    auto it = chats.find(chatId);
+    if (it != chats.end() && !it->queue.isEmpty() && merge(it->queue.last(), text, isHtml, QJsonObject())) {
+        return;
+    }
+
+    QJsonObject payload;
+    payload["chat_id"] = chatId;
+    payload["text"] = text;
+    if (isHtml) {
+        payload["parse_mode"] = "HTML";
+    }
+
+    Item item;
+    item.method = "sendMessage";
+    item.payload = payload;
+    item.mergeable = true;
+    enqueue(chatId, item);
+}
+
+/**
+ * @brief Надсилає текст з клавіатурою; якщо перед ним у черзі текст — одним повідомленням
+ * @param replyMarkup ReplyKeyboardMarkup або InlineKeyboardMarkup
+ */
+void OutboundQueue::textWithMarkup(qint64 chatId, const QString &text, const QJsonObject &replyMarkup, bool isHtml) {
+    auto it = chats.find(chatId);
+    if (it != chats.end() && !it->queue.isEmpty() && merge(it->queue.last(), text, isHtml, replyMarkup)) {
+        return;
+    }
+
+    QJsonObject payload;
+    payload["chat_id"] = chatId;
+    payload["text"] = text;
+    if (isHtml) {
+        payload["parse_mode"] = "HTML";
+    }
+    payload["reply_markup"] = replyMarkup;
+
+    Item item;
+    item.method = "sendMessage";
+    item.payload = payload;
+    enqueue(chatId, item);
+}
+
+void OutboundQueue::call(qint64 chatId, const QString &method, const QJsonObject &payload, TelegramApi::Callback callback) {
+    Item item;
+    item.method = method;
+    item.payload = payload;
+    item.callback = std::move(callback);
+    enqueue(chatId, item);
+}
+
+/**
+ * @brief Надсилає документ у черзі чату, після всіх текстів, що вже чекають
+ * @param device Відкритий для читання пристрій; видаляється чергою після відправки
+ * @param caption Підпис до документа (HTML)
+ */
+void OutboundQueue::document(qint64 chatId, const QString &fileName, QIODevice *device, const QString &mimeType,
+                             const QString &caption, TelegramApi::Callback callback) {
+    QJsonObject payload;
+    payload["chat_id"] = chatId;
+    if (!caption.isEmpty()) {
+        payload["caption"] = caption;
+        payload["parse_mode"] = "HTML";
+    }
+
+    device->setParent(this);
+
+    Item item;
+    item.method = "sendDocument";
+    item.payload = payload;
+    item.callback = std::move(callback);
+    item.device = device;
+    item.fileName = fileName;
+    item.mimeType = mimeType;
+    enqueue(chatId, item);
+}
+
+/**
+ * @brief Дописує текст до повідомлення, що ще чекає в черзі
+ * @return false, якщо злиття неможливе (клавіатура вже є, або задовго)
+ */
+bool OutboundQueue::merge(Item &last, const QString &text, bool isHtml, const QJsonObject &replyMarkup) {
+    if (!last.mergeable) {
+        return false;
+    }
+
+    const bool lastHtml = last.payload.contains("parse_mode");
+    QString previous = last.payload["text"].toString();
+    QString next = text;
+
+    // 🔹 Різні parse_mode: звичайний текст екрануємо і зливаємо як HTML
+    if (lastHtml != isHtml) {
+        if (!lastHtml) {
+            previous = previous.toHtmlEscaped();
+        } else {
+            next = next.toHtmlEscaped();
+        }
+    }
+
+    QString merged = previous;
+    if (!merged.endsWith('\n')) {
+        merged += '\n';
+    }
+    merged += '\n' + next;
+    if (merged.size() > kTelegramTextLimit) {
+        return false;
+    }
+
+    last.payload["text"] = merged;
+    if (lastHtml || isHtml) {
+        last.payload["parse_mode"] = "HTML";
+    }
+    if (!replyMarkup.isEmpty()) {
+        last.payload["reply_markup"] = replyMarkup;
+        last.mergeable = false;      // Після клавіатури текст уже не дописуємо
+    }
+    ++m_merged;
+    return true;
+}
+
+void OutboundQueue::enqueue(qint64 chatId, Item item) {
+    Chat &chat = chats[chatId];
+    chat.queue.append(std::move(item));
+    if (chat.busy) {
+        return;
+    }
+
+    chat.busy = true;
+    const int window = Config::current().outboundCoalesceMs;
+    if (window <= 0) {
+        sendNext(chatId);
+        return;
+    }
+    QTimer::singleShot(window, this, [this, chatId]() {
+        sendNext(chatId);
+    });
+}
+
+/**
+ * @brief Надсилає наступне повідомлення чату; наступне — лише після відповіді на попереднє
+ */
+void OutboundQueue::sendNext(qint64 chatId) {
+    auto it = chats.find(chatId);
+    if (it == chats.end()) {
+        return;
+    }
+    if (it->queue.isEmpty()) {
+        chats.erase(it);
+        return;
+    }
+
+    Item item = it->queue.takeFirst();
+    ++m_sent;
+
+    TelegramApi::Callback done = [this, chatId, item](const TelegramResult &result) {
+        // 🔹 429: повторюємо те саме повідомлення після паузи, порядок у чаті зберігається
+        if (!result.ok && result.retryAfter > 0) {
+            Item retry = item;
+            retry.mergeable = false;
+            if (retry.device) {
+                retry.device->seek(0);   // Документ завантажуємо з початку
+            }
+            chats[chatId].queue.prepend(retry);
+            qWarning() << "⏳ Telegram просить зачекати" << result.retryAfter << "с для чату" << chatId;
+            QTimer::singleShot(result.retryAfter * 1000, this, [this, chatId]() {
+                sendNext(chatId);
+            });
+            return;
+        }
+
+        if (item.device) {
+            item.device->deleteLater();
+        }
+        if (item.callback) {
+            item.callback(result);
+        }
+        sendNext(chatId);
+    };
+
+    if (item.device) {
+        telegram->upload(item.method, item.payload, "document", item.fileName, item.device, item.mimeType, done);
+    } else {
+        telegram->call(item.method, item.payload, done);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef OUTBOUNDQUEUE_H
+#define OUTBOUNDQUEUE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QJsonObject>
+#include "telegramapi.h"
+
+class QIODevice;
+
+/**
+ * @brief Вихідна черга повідомлень кожного чату зі злиттям.
+ *
+ * Повідомлення чату затримуються на коротке вікно (outbound_coalesce_ms) і
+ * надсилаються по одному, у порядку додавання. Поки повідомлення чекає,
+ * наступний текст дописується до нього, а текст з клавіатурою приєднує її
+ * до попереднього тексту — одна дія користувача дає один виклик Telegram.
+ * Інші методи (sendLocation, sendDocument, sendMessage видів) не зливаються,
+ * але йдуть у тій самій черзі, тож порядок у чаті не змінюється.
+ */
+class OutboundQueue : public QObject {
+    Q_OBJECT
+public:
+    explicit OutboundQueue(TelegramApi *telegram, QObject *parent = nullptr);
+
+    // Текст: зливається з попереднім текстом чату, якщо той ще не відправлено
+    void text(qint64 chatId, const QString &text, bool isHtml = true);
+    // Текст з reply_markup: клавіатура приєднується до попереднього тексту
+    void textWithMarkup(qint64 chatId, const QString &text, const QJsonObject &replyMarkup, bool isHtml = false);
+    // Будь-який інший метод — по черзі з текстами чату, без злиття
+    void call(qint64 chatId, const QString &method, const QJsonObject &payload, TelegramApi::Callback callback = nullptr);
+    // Документ (multipart): по черзі з текстами чату, без злиття; пристрій переходить у власність черги
+    void document(qint64 chatId, const QString &fileName, QIODevice *device, const QString &mimeType,
+                  const QString &caption = QString(), TelegramApi::Callback callback = nullptr);
+
+    bool isIdle() const { return chats.isEmpty(); }        // Усе відправлено
+    quint64 mergedMessages() const { return m_merged; }   // Скільки повідомлень злито з попередніми
+    quint64 sentCalls() const { return m_sent; }
+
+private:
+    struct Item {
+        QString method;
+        QJsonObject payload;
+        TelegramApi::Callback callback;
+        bool mergeable = false;     // Текст без клавіатури, до якого ще можна дописати
+        QIODevice *device = nullptr;  // Вміст документа для sendDocument (інакше — JSON-виклик)
+        QString fileName;
+        QString mimeType;
+    };
+
+    struct Chat {
+        QList<Item> queue;
+        bool busy = false;          // Вікно злиття або виклик у польоті
+    };
+
+    void enqueue(qint64 chatId, Item item);
+    bool merge(Item &last, const QString &text, bool isHtml, const QJsonObject &replyMarkup);
+    void sendNext(qint64 chatId);
+
+    TelegramApi *telegram;
+    QHash<qint64, Chat> chats;
+    quint64 m_merged = 0;
+    quint64 m_sent = 0;
+};
+
+#endif // OUTBOUNDQUEUE_H
@@ -0,0 +1,271 @@
+#include "palantirbatcher.h"
+#include "config.h"
+#include <QTimer>
+#include <QThreadPool>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+
+static const qsizetype kOffloadBytes = 16 * 1024;  // Менші пакети дешевше розкласти на місці
+
+PalantirBatcher::PalantirBatcher(PalantirGateway *gateway, QObject *parent)
+    : QObject(parent), gateway(gateway) {}
+
+bool PalantirBatcher::accepts(const QString &endpoint) const {
+    const ConfigSnapshot &config = Config::current();
+    return config.batchWindowMs > 0 && config.batchEndpoints.contains(endpoint);
+}
+
+QUrlQuery PalantirBatcher::lookupQuery(qint64 clientId, int terminalId) {
+    QUrlQuery query;
+    query.addQueryItem("client_id", QString::number(clientId));
+    query.addQueryItem("terminal_id", QString::number(terminalId));
+    return query;
+}
+
+/**
+ * @brief Додає запит до пакета endpoint'у і клієнта; пакет відправляється через window_ms
+ *        або одразу, щойно набере max_size запитів
+ */
+void PalantirBatcher::get(const QString &endpoint, qint64 clientId, int terminalId, Callback callback,
+                          const ActionToken::Ptr &token) {
+    const ConfigSnapshot &config = Config::current();
+    const QString key = endpoint + "?" + QString::number(clientId);
+
+    BatchPtr &batch = m_open[key];
+    if (!batch) {
+        batch = std::make_shared<Batch>();
+        batch->endpoint = endpoint;
+        batch->clientId = clientId;
+        QTimer::singleShot(config.batchWindowMs, Qt::PreciseTimer, this, [this, key, opened = std::weak_ptr<Batch>(batch)]() {
+            if (!opened.expired() && m_open.value(key) == opened.lock()) {
+                flush(key);
+            }
+        });
+    }
+
+    auto lookup = std::make_shared<Lookup>();
+    lookup->terminalId = terminalId;
+    lookup->callback = std::move(callback);
+    lookup->token = token;
+    lookup->batch = batch;
+    batch->lookups.append(lookup);
+
+    if (token) {
+        connect(token.get(), &ActionToken::cancelled, this, [this, lookup]() {
+            onLookupCancelled(lookup);
+        });
+    }
+
+    if (batch->lookups.size() >= config.batchMaxSize) {
+        flush(key);
+    }
+}
+
+void PalantirBatcher::flush(const QString &key) {
+    const BatchPtr batch = m_open.take(key);
+    batch->sent = true;
+
+    // 🔹 Скасовані до відправки запити вже отримали відповідь
+    QList<LookupPtr> live;
+    for (const LookupPtr &lookup : std::as_const(batch->lookups)) {
+        if (!lookup->done) {
+            live.append(lookup);
+        }
+    }
+    batch->lookups = live;
+
+    if (live.isEmpty()) {
+        return;
+    }
+
+    if (live.size() == 1) {
+        const LookupPtr lookup = live.first();
+        gateway->get(batch->endpoint, lookupQuery(batch->clientId, lookup->terminalId),
+                     [lookup](const PalantirResponse &response) { finish(lookup, response); }, lookup->token);
+        return;
+    }
+
+    if (!Config::current().batchBulk || m_noBulk.contains(batch->endpoint)) {
+        sendPipelined(batch->endpoint, batch->clientId, live);
+        return;
+    }
+    sendBulk(batch);
+}
+
+/**
+ * @brief GET <endpoint>_batch за всі запити пакета
+ *
+ * Пакетний запит має власний токен з найпізнішим дедлайном серед запитів
+ * (без дедлайну, якщо хоч один запит без токена) і обривається, лише коли
+ * скасовано всі запити пакета.
+ */
+void PalantirBatcher::sendBulk(const BatchPtr &batch) {
+    QStringList terminalIds;
+    QDeadlineTimer deadline(0);
+    bool forever = false;
+    for (const LookupPtr &lookup : std::as_const(batch->lookups)) {
+        terminalIds.append(QString::number(lookup->terminalId));
+        if (!lookup->token) {
+            forever = true;
+        } else if (lookup->token->deadline() > deadline) {
+            deadline = lookup->token->deadline();
+        }
+    }
+    batch->token = ActionToken::create(batch->endpoint + "_batch", forever ? QDeadlineTimer(QDeadlineTimer::Forever) : deadline);
+
+    QUrlQuery query;
+    query.addQueryItem("client_id", QString::number(batch->clientId));
+    query.addQueryItem("terminal_ids", terminalIds.join(','));
+
+    ++m_bulkRequests;
+    gateway->getBulk(batch->endpoint + "_batch", query, [this, batch](const PalantirResponse &response) {
+        onBulkResponse(batch, response);
+    }, batch->token);
+}
+
+/**
+ * @brief Запасний шлях: окремі запити одним конвеєром HTTP/1.1
+ */
+void PalantirBatcher::sendPipelined(const QString &endpoint, qint64 clientId, const QList<LookupPtr> &lookups) {
+    for (const LookupPtr &lookup : lookups) {
+        if (lookup->done) {
+            continue;
+        }
+        ++m_pipelinedLookups;
+        gateway->getPipelined(endpoint, lookupQuery(clientId, lookup->terminalId),
+                              [lookup](const PalantirResponse &response) { finish(lookup, response); }, lookup->token);
+    }
+}
+
+void PalantirBatcher::onBulkResponse(const BatchPtr &batch, const PalantirResponse &response) {
+    if (response.cancelled) {
+        for (const LookupPtr &lookup : std::as_const(batch->lookups)) {
+            finish(lookup, response);
+        }
+        return;
+    }
+
+    // 🔹 4xx — бекенд не знає пакетного endpoint'у; далі для цього endpoint'у лише конвеєр
+    if (!response.ok && !response.degraded) {
+        if (!m_noBulk.contains(batch->endpoint)) {
+            qWarning() << "📦 Palantír не обслуговує" << batch->endpoint + "_batch" << "(" << response.errorString
+                       << "), далі — конвеєр окремих запитів.";
+            m_noBulk.insert(batch->endpoint);
+        }
+        sendPipelined(batch->endpoint, batch->clientId, batch->lookups);
+        return;
+    }
+
+    // 🔹 Бекенд деградований: окремі запити візьмуть власний кеш або знімок
+    if (!response.ok) {
+        sendPipelined(batch->endpoint, batch->clientId, batch->lookups);
+        return;
+    }
+
+    if (response.body.size() < kOffloadBytes) {
+        deliverSplit(batch, response, split(response.body));
+        return;
+    }
+
+    QThreadPool::globalInstance()->start([this, batch, response]() {
+        Split parts = split(response.body);
+        QMetaObject::invokeMethod(this, [this, batch, response, parts = std::move(parts)]() {
+            deliverSplit(batch, response, parts);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Розкладає {"terminals": [...]} за terminal_id (у будь-якому потоці)
+ */
+PalantirBatcher::Split PalantirBatcher::split(const QByteArray &body) {
+    Split result;
+    const QJsonDocument jsonDoc = QJsonDocument::fromJson(body);
+    if (!jsonDoc.isObject()) {
+        return result;
+    }
+
+    const QJsonObject envelope = jsonDoc.object();
+    if (envelope.contains("error")) {
+        result.ok = true;
+        result.error = envelope["error"].toString();
+        return result;
+    }
+
+    const QJsonArray terminals = envelope["terminals"].toArray();
+    result.bodies.reserve(terminals.size());
+    for (const QJsonValue &value : terminals) {
+        const QJsonObject terminal = value.toObject();
+        result.bodies.insert(terminal["terminal_id"].toInt(), QJsonDocument(terminal).toJson(QJsonDocument::Compact));
+    }
+    result.ok = true;
+    return result;
+}
+
+void PalantirBatcher::deliverSplit(const BatchPtr &batch, const PalantirResponse &response, const Split &parts) {
+    QList<LookupPtr> missing;
+
+    for (const LookupPtr &lookup : std::as_const(batch->lookups)) {
+        if (lookup->done) {
+            continue;
+        }
+
+        PalantirResponse part = response;
+        if (!parts.ok) {
+            // Некоректне тіло пакета — кожен запит отримує його як є і звітує BadPayload
+        } else if (!parts.error.isEmpty()) {
+            part.body = QJsonDocument(QJsonObject{{"error", parts.error}}).toJson(QJsonDocument::Compact);
+        } else if (parts.bodies.contains(lookup->terminalId)) {
+            part.body = parts.bodies.value(lookup->terminalId);
+            if (!response.fromCache) {
+                gateway->storeResponse(batch->endpoint, lookupQuery(batch->clientId, lookup->terminalId),
+                                       part.body, response.fetchedAt);
+            }
+        } else {
+            missing.append(lookup);   // Бекенд пропустив термінал — запитуємо окремо
+            continue;
+        }
+
+        ++m_bulkLookups;
+        finish(lookup, part);
+    }
+
+    if (!missing.isEmpty()) {
+        sendPipelined(batch->endpoint, batch->clientId, missing);
+    }
+}
+
+/**
+ * @brief Дію запиту скасовано: відповідаємо одразу, а пакет обриваємо, коли скасовано всі його запити
+ */
+void PalantirBatcher::onLookupCancelled(const LookupPtr &lookup) {
+    if (lookup->done) {
+        return;
+    }
+
+    PalantirResponse response;
+    response.cancelled = true;
+    response.errorString = "Action cancelled";
+    finish(lookup, response);
+
+    const BatchPtr batch = lookup->batch.lock();
+    if (!batch || !batch->sent || !batch->token) {
+        return;
+    }
+    for (const LookupPtr &other : std::as_const(batch->lookups)) {
+        if (!other->done) {
+            return;
+        }
+    }
+    batch->token->cancel("усі запити пакета скасовано");
+}
+
+void PalantirBatcher::finish(const LookupPtr &lookup, const PalantirResponse &response) {
+    if (lookup->done) {
+        return;
+    }
+    lookup->done = true;
+    lookup->callback(response);
+}
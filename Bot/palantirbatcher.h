@@ -0,0 +1,82 @@
+#ifndef PALANTIRBATCHER_H
+#define PALANTIRBATCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <memory>
+#include "palantirgateway.h"
+
+/**
+ * @brief Пакетування запитів до Palantír у стилі DataLoader.
+ *
+ * Запити одного endpoint'у і клієнта, що надійшли протягом [Batching] window_ms,
+ * збираються в один GET <endpoint>_batch?client_id=..&terminal_ids=..; відповідь
+ * розкладається назад по запитах, і кожна частина потрапляє в кеш шлюзу, як
+ * після окремого запиту. Якщо бекенд не має пакетного endpoint'у (bulk = false
+ * або відповідь 4xx), пакет іде конвеєром окремих запитів (HTTP pipelining).
+ */
+class PalantirBatcher : public QObject {
+    Q_OBJECT
+public:
+    using Callback = PalantirGateway::Callback;
+
+    explicit PalantirBatcher(PalantirGateway *gateway, QObject *parent = nullptr);
+
+    bool accepts(const QString &endpoint) const;   // Запити endpoint'у збираються в пакети
+    // Відповідь — як від PalantirGateway::get(endpoint, client_id + terminal_id); callback — рівно один раз
+    void get(const QString &endpoint, qint64 clientId, int terminalId, Callback callback,
+             const ActionToken::Ptr &token = nullptr);
+
+    quint64 bulkRequests() const { return m_bulkRequests; }          // Пакетних запитів до бекенду
+    quint64 bulkLookups() const { return m_bulkLookups; }            // Запитів, обслужених пакетами
+    quint64 pipelinedLookups() const { return m_pipelinedLookups; }  // Запитів, відправлених конвеєром
+
+private:
+    struct Batch;
+
+    struct Lookup {
+        int terminalId = 0;
+        Callback callback;
+        ActionToken::Ptr token;
+        std::weak_ptr<Batch> batch;
+        bool done = false;               // Відповідь уже віддано
+    };
+    using LookupPtr = std::shared_ptr<Lookup>;
+
+    struct Batch {
+        QString endpoint;
+        qint64 clientId = 0;
+        QList<LookupPtr> lookups;
+        ActionToken::Ptr token;          // Пакетного запиту; скасовується, коли скасовано всі його запити
+        bool sent = false;
+    };
+    using BatchPtr = std::shared_ptr<Batch>;
+
+    // 🔹 Пакетна відповідь, розкладена за terminal_id
+    struct Split {
+        bool ok = false;
+        QString error;                       // "error" усього пакета
+        QHash<int, QByteArray> bodies;       // terminal_id -> тіло, як у відповіді окремого запиту
+    };
+
+    void flush(const QString &key);
+    void sendBulk(const BatchPtr &batch);
+    void sendPipelined(const QString &endpoint, qint64 clientId, const QList<LookupPtr> &lookups);
+    void onBulkResponse(const BatchPtr &batch, const PalantirResponse &response);
+    void deliverSplit(const BatchPtr &batch, const PalantirResponse &response, const Split &split);
+    void onLookupCancelled(const LookupPtr &lookup);
+    static void finish(const LookupPtr &lookup, const PalantirResponse &response);
+    static Split split(const QByteArray &body);
+    static QUrlQuery lookupQuery(qint64 clientId, int terminalId);
+
+    PalantirGateway *gateway;
+    QHash<QString, BatchPtr> m_open;     // "endpoint?client_id" -> пакет, що ще збирається
+    QSet<QString> m_noBulk;              // Endpoint'и, для яких бекенд не має пакетного варіанту
+    quint64 m_bulkRequests = 0;
+    quint64 m_bulkLookups = 0;
+    quint64 m_pipelinedLookups = 0;
+};
+
+#endif // PALANTIRBATCHER_H
@@ -0,0 +1,179 @@
+#include "palantirclient.h"
+#include <QPromise>
+#include <QThreadPool>
+#include <QJsonDocument>
+#include <QUrlQuery>
+#include <memory>
+
+static const qsizetype kOffloadBytes = 16 * 1024;  // Менші тіла дешевше розібрати на місці
+
+/**
+ * @brief Розбирає тіло відповіді і завершує promise (у будь-якому потоці)
+ */
+template <typename T>
+static void decodeInto(QPromise<PalantirResult<T>> &promise, PalantirResult<T> result,
+                       const QByteArray &body, T (*decode)(const QJsonObject &)) {
+    QJsonParseError parseError;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(body, &parseError);
+
+    if (!jsonDoc.isObject()) {
+        result.status = PalantirStatus::BadPayload;
+        result.errorString = parseError.errorString();
+    } else {
+        QJsonObject jsonObj = jsonDoc.object();
+        if (jsonObj.contains("error")) {
+            result.status = PalantirStatus::ServerError;
+            result.errorString = jsonObj["error"].toString();
+        } else {
+            result.status = PalantirStatus::Ok;
+            result.value = decode(jsonObj);
+        }
+    }
+
+    promise.addResult(std::move(result));
+    promise.finish();
+}
+
+PalantirClient::PalantirClient(PalantirGateway *gateway, QObject *parent)
+    : QObject(parent), gateway(gateway), m_batcher(new PalantirBatcher(gateway, this)) {}
+
+QFuture<PalantirClient::TerminalResult> PalantirClient::terminal(qint64 clientId, int terminalId,
+                                                                 const ActionToken::Ptr &token) {
+    return fetch("terminal_info", clientId, terminalId, &Palantir::terminalFromJson, token);
+}
+
+QFuture<PalantirClient::ReservoirsResult> PalantirClient::reservoirs(qint64 clientId, int terminalId,
+                                                                     const ActionToken::Ptr &token) {
+    return fetch("reservoirs_info", clientId, terminalId, &Palantir::reservoirsFromJson, token);
+}
+
+QFuture<PalantirClient::PosDatasResult> PalantirClient::posdatas(qint64 clientId, int terminalId,
+                                                                 const ActionToken::Ptr &token) {
+    return fetch("posdatas", clientId, terminalId, &Palantir::posdatasFromJson, token);
+}
+
+/**
+ * @brief Додає дію до тих, що чекають на запит; коли скасовано всі — запит обривається
+ */
+void PalantirClient::join(const QString &key, Pending &pending, const ActionToken::Ptr &token) {
+    // 🔹 Спільний запит живе до найпізнішого дедлайну серед дій, як пакет у PalantirBatcher::sendBulk
+    if (!token) {
+        pending.pinned = true;
+        if (pending.shared) {
+            pending.shared->extendDeadline(QDeadlineTimer(QDeadlineTimer::Forever));
+        }
+        return;
+    }
+
+    token->addWork();
+    pending.owners.append(token);
+    if (pending.shared) {
+        pending.shared->extendDeadline(token->deadline());
+    }
+    connect(token.get(), &ActionToken::cancelled, this, [this, key, shared = pending.shared]() {
+        auto it = m_pending.find(key);
+        if (!shared || it == m_pending.end() || it->shared != shared || it->pinned) {
+            return;
+        }
+        for (const ActionToken::Ptr &owner : std::as_const(it->owners)) {
+            if (!owner->isCancelled()) {
+                return;
+            }
+        }
+        shared->cancel("усі дії скасовано");
+    });
+}
+
+/**
+ * @brief GET через шлюз і розбір відповіді у структуру T
+ * @param decode Перетворює JSON-об'єкт відповіді на T (викликається не більше одного разу)
+ * @param token Дія користувача; скасована дія отримує PalantirStatus::Cancelled
+ */
+template <typename T>
+QFuture<PalantirResult<T>> PalantirClient::fetch(const QString &endpoint, qint64 clientId, int terminalId,
+                                                 T (*decode)(const QJsonObject &), const ActionToken::Ptr &token) {
+    using Result = PalantirResult<T>;
+
+    QUrlQuery query;
+    query.addQueryItem("client_id", QString::number(clientId));
+    query.addQueryItem("terminal_id", QString::number(terminalId));
+
+    // 🔹 Той самий запит уже в польоті — віддаємо його QFuture
+    QString key = endpoint + "?" + query.toString(QUrl::FullyEncoded);
+    auto pending = m_pending.find(key);
+    if (pending != m_pending.end()) {
+        ++m_coalesced;
+        join(key, *pending, token);
+        return pending->future.template value<QFuture<Result>>();
+    }
+
+    auto promise = std::make_shared<QPromise<Result>>();
+    promise->start();
+    QFuture<Result> future = promise->future();
+
+    // 🔹 Дію вже скасовано — відповідь без запиту
+    if (token && token->isCancelled()) {
+        Result result;
+        result.status = PalantirStatus::Cancelled;
+        promise->addResult(std::move(result));
+        promise->finish();
+        return future;
+    }
+
+    // 🔹 Запит у шлюзі має власний токен: його не обірве скасування однієї з кількох дій
+    Pending &entry = m_pending[key];
+    entry.future = QVariant::fromValue(future);
+    if (token) {
+        entry.shared = ActionToken::create(token->action(), token->deadline());
+    }
+    join(key, entry, token);
+    const ActionToken::Ptr shared = entry.shared;
+
+    auto onResponse = [this, key, promise, decode](const PalantirResponse &response) {
+        const Pending done = m_pending.take(key);
+        for (const ActionToken::Ptr &owner : done.owners) {
+            owner->doneWork();
+        }
+
+        Result result;
+        result.fromCache = response.fromCache;
+        result.fetchedAt = response.fetchedAt;
+        result.errorString = response.errorString;
+
+        if (response.cancelled) {
+            result.status = PalantirStatus::Cancelled;
+            promise->addResult(std::move(result));
+            promise->finish();
+            return;
+        }
+
+        if (!response.ok) {
+            if (response.timedOut) {
+                result.status = PalantirStatus::TimedOut;
+            } else {
+                result.status = response.degraded ? PalantirStatus::Unavailable : PalantirStatus::RequestFailed;
+            }
+            promise->addResult(std::move(result));
+            promise->finish();
+            return;
+        }
+
+        if (response.body.size() < kOffloadBytes) {
+            decodeInto(*promise, std::move(result), response.body, decode);
+            return;
+        }
+
+        QThreadPool::globalInstance()->start([promise, result = std::move(result), body = response.body, decode]() mutable {
+            decodeInto(*promise, std::move(result), body, decode);
+        });
+    };
+
+    // 🔹 Запити до endpoint'ів з пакетуванням чекають вікно і йдуть до бекенду пакетом
+    if (m_batcher->accepts(endpoint)) {
+        m_batcher->get(endpoint, clientId, terminalId, std::move(onResponse), shared);
+    } else {
+        gateway->get(endpoint, query, std::move(onResponse), shared);
+    }
+
+    return future;
+}
@@ -0,0 +1,63 @@
+#ifndef PALANTIRCLIENT_H
+#define PALANTIRCLIENT_H
+
+#include <QObject>
+#include <QFuture>
+#include <QHash>
+#include <QVariant>
+#include "palantirgateway.h"
+#include "palantirbatcher.h"
+#include "palantirtypes.h"
+
+/**
+ * @brief Типізований асинхронний клієнт Palantír поверх PalantirGateway.
+ *
+ * Повертає QFuture з уже розібраними структурами: JSON розбирається один раз,
+ * великі тіла — у QThreadPool, а не в event loop. Дедлайни, запобіжник і кеш
+ * лишаються в шлюзі. Однакові запити, що вже в польоті, ділять один QFuture.
+ * Паралельні виклики компонуються через QtFuture::whenAll, продовження з
+ * контекстом (.then(this, ...)) виконуються в потоці бота.
+ *
+ * Запити до [Batching] endpoints (terminal_info) кількох терміналів одного
+ * клієнта, що надійшли в межах window_ms, ідуть до бекенду одним пакетом.
+ *
+ * Запит з ActionToken обривається, лише коли скасовано всі дії, що на нього
+ * чекають; запит без токена (фонові задачі) не обривається ніколи.
+ */
+class PalantirClient : public QObject {
+    Q_OBJECT
+public:
+    using TerminalResult = PalantirResult<Palantir::Terminal>;
+    using ReservoirsResult = PalantirResult<QList<Palantir::Reservoir>>;
+    using PosDatasResult = PalantirResult<QList<Palantir::PosData>>;
+
+    explicit PalantirClient(PalantirGateway *gateway, QObject *parent = nullptr);
+
+    QFuture<TerminalResult> terminal(qint64 clientId, int terminalId, const ActionToken::Ptr &token = nullptr);       // terminal_info
+    QFuture<ReservoirsResult> reservoirs(qint64 clientId, int terminalId, const ActionToken::Ptr &token = nullptr);   // reservoirs_info
+    QFuture<PosDatasResult> posdatas(qint64 clientId, int terminalId, const ActionToken::Ptr &token = nullptr);       // posdatas
+
+    quint64 coalescedRequests() const { return m_coalesced; }
+    const PalantirBatcher *batcher() const { return m_batcher; }   // Лічильники пакетування
+
+private:
+    // 🔹 Незавершений запит і дії, що на нього чекають
+    struct Pending {
+        QVariant future;                  // QFuture<PalantirResult<T>>
+        ActionToken::Ptr shared;          // Токен запиту в шлюзі; скасовується, коли скасовано всіх власників
+        QList<ActionToken::Ptr> owners;
+        bool pinned = false;              // Чекає хтось без токена — не скасовуємо
+    };
+
+    template <typename T>
+    QFuture<PalantirResult<T>> fetch(const QString &endpoint, qint64 clientId, int terminalId,
+                                     T (*decode)(const QJsonObject &), const ActionToken::Ptr &token);
+    void join(const QString &key, Pending &pending, const ActionToken::Ptr &token);
+
+    PalantirGateway *gateway;
+    PalantirBatcher *m_batcher;           // Збирає запити [Batching] endpoints у пакети
+    QHash<QString, Pending> m_pending;    // "endpoint?query" -> незавершений запит
+    quint64 m_coalesced = 0;
+};
+
+#endif // PALANTIRCLIENT_H
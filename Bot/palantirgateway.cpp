@@ -0,0 +1,509 @@
+#include "palantirgateway.h"
+#include "config.h"
+#include "trafficrecorder.h"
+#include "catalogsnapshot.h"
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+static const int kLatencySamples = 128;    // Розмір вікна для оцінки p95
+static const int kMinSamplesForHedge = 20; // Без достатньої статистики не дублюємо
+
+CircuitBreaker::CircuitBreaker(int failureThreshold, int openMs)
+    : m_failureThreshold(failureThreshold), m_openMs(openMs) {}
+
+void CircuitBreaker::setLimits(int failureThreshold, int openMs) {
+    m_failureThreshold = failureThreshold;
+    m_openMs = openMs;
+}
+
+bool CircuitBreaker::allowRequest(bool *probe) {
+    if (probe) {
+        *probe = false;
+    }
+    if (m_state == State::Closed) {
+        return true;
+    }
+
+    if (m_state == State::Open && m_openedAt.elapsed() >= m_openMs) {
+        m_state = State::HalfOpen;  // Пора перевірити, чи ожив бекенд
+        m_probeInFlight = false;
+    }
+
+    if (m_state == State::HalfOpen && !m_probeInFlight) {
+        m_probeInFlight = true;  // Пропускаємо лише один пробний запит
+        if (probe) {
+            *probe = true;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void CircuitBreaker::recordSuccess() {
+    if (m_state != State::Closed) {
+        qInfo() << "✅ Palantír знову доступний, запобіжник закрито.";
+    }
+    m_failures = 0;
+    m_state = State::Closed;
+    m_probeInFlight = false;
+}
+
+void CircuitBreaker::recordCancelled(bool probe) {
+    if (probe) {
+        m_probeInFlight = false;   // Пробний запит обірвано — наступний запит знову може бути пробним
+    }
+}
+
+void CircuitBreaker::recordFailure() {
+    ++m_failures;
+    if (m_state == State::HalfOpen || m_failures >= m_failureThreshold) {
+        if (m_state != State::Open) {
+            qWarning() << "⚡ Запобіжник Palantír відкрито після" << m_failures << "невдач.";
+        }
+        m_state = State::Open;
+        m_probeInFlight = false;
+        m_openedAt.start();
+    }
+}
+
+
+PalantirGateway::PalantirGateway(QNetworkAccessManager *networkManager, QObject *parent)
+    : QObject(parent), networkManager(networkManager) {
+    m_cache.setMaxCost(Config::current().cacheEntries);
+}
+
+/**
+ * @brief Виконує GET до Palantír з дедлайном, запобіжником і, за потреби, hedging'ом
+ * @param endpoint Назва endpoint'у (наприклад, "terminal_info")
+ * @param query Параметри запиту
+ * @param callback Викликається рівно один раз
+ * @param token Дія користувача: скасування обриває запит (response.cancelled), після дедлайну
+ *              віддається кеш або деградація з response.timedOut
+ */
+void PalantirGateway::get(const QString &endpoint, const QUrlQuery &query, Callback callback,
+                          const ActionToken::Ptr &token) {
+    dispatch(endpoint, query, std::move(callback), nullptr, token);
+}
+
+/**
+ * @brief Потоковий GET: розпаковане тіло віддається частинами з readyRead
+ * @param onChunk Викликається для кожної частини тіла в порядку надходження
+ * @param callback Викликається рівно один раз після завершення; при успіху body порожнє,
+ *                 при деградації може містити повне тіло з кешу
+ *
+ * Потокові запити не дублюються (hedging) і не кешуються — тіло не накопичується.
+ */
+void PalantirGateway::getStream(const QString &endpoint, const QUrlQuery &query, ChunkCallback onChunk, Callback callback,
+                                const ActionToken::Ptr &token) {
+    dispatch(endpoint, query, std::move(callback), std::move(onChunk), token);
+}
+
+/**
+ * @brief GET з HTTP/1.1 pipelining: запити серії йдуть одним з'єднанням, не чекаючи відповідей
+ *
+ * Для дрібних незалежних запитів одного endpoint'у (запасний шлях пакетування,
+ * коли бекенд не має пакетного endpoint'у). Інші параметри — як у get().
+ */
+void PalantirGateway::getPipelined(const QString &endpoint, const QUrlQuery &query, Callback callback,
+                                   const ActionToken::Ptr &token) {
+    dispatch(endpoint, query, std::move(callback), nullptr, token, true);
+}
+
+/**
+ * @brief GET пакетного endpoint'у (<endpoint>_batch)
+ *
+ * Ключ пакета унікальний для кожного набору ID і більше не запитується, тож ні
+ * кеш, ні знімок його не зберігають: частини кешує PalantirBatcher через storeResponse().
+ */
+void PalantirGateway::getBulk(const QString &endpoint, const QUrlQuery &query, Callback callback,
+                              const ActionToken::Ptr &token) {
+    dispatch(endpoint, query, std::move(callback), nullptr, token, false, false);
+}
+
+void PalantirGateway::storeResponse(const QString &endpoint, const QUrlQuery &query, const QByteArray &body,
+                                    const QDateTime &fetchedAt) {
+    QUrl url(Config::current().palantirBaseUrl + "/" + endpoint);
+    url.setQuery(query);
+    m_cache.insert(url.toString(), new CachedBody{body, fetchedAt});
+    if (m_snapshot) {
+        m_snapshot->store(endpoint + "?" + url.query(QUrl::FullyEncoded), body, fetchedAt);
+    }
+}
+
+QList<PalantirGateway::CachedResponse> PalantirGateway::cachedResponses() const {
+    QList<CachedResponse> responses;
+    const QList<QString> urls = m_cache.keys();
+    responses.reserve(urls.size());
+    for (const QString &url : urls) {
+        if (const CachedBody *cached = m_cache.object(url)) {
+            responses.append(CachedResponse{ url, cached->body, cached->fetchedAt });
+        }
+    }
+    return responses;
+}
+
+void PalantirGateway::warmCache(const QList<CachedResponse> &responses) {
+    for (const CachedResponse &response : responses) {
+        m_cache.insert(response.url, new CachedBody{response.body, response.fetchedAt});
+    }
+}
+
+void PalantirGateway::dispatch(const QString &endpoint, const QUrlQuery &query, Callback callback, ChunkCallback onChunk,
+                               const ActionToken::Ptr &token, bool pipelined, bool cacheable) {
+    const ConfigSnapshot &config = Config::current();
+    m_breaker.setLimits(config.breakerFailureThreshold, config.breakerOpenMs);
+    if (m_cache.maxCost() != config.cacheEntries) {
+        m_cache.setMaxCost(config.cacheEntries);
+    }
+
+    auto call = std::make_shared<PendingCall>();
+    call->endpoint = endpoint;
+    call->url = QUrl(config.palantirBaseUrl + "/" + endpoint);
+    call->url.setQuery(query);
+    call->callback = std::move(callback);
+    call->onChunk = std::move(onChunk);
+    call->token = token;
+    call->pipelined = pipelined;
+    call->cacheable = cacheable && !call->onChunk;
+
+    // 🔹 Дію вже скасовано: бекенд не турбуємо
+    if (token && token->isCancelled()) {
+        call->done = true;
+        ++m_cancelledRequests;
+        deliverCancelled(call);
+        return;
+    }
+
+    // 🔹 Дедлайн дії вичерпано ще до запиту: лише кеш або знімок
+    if (token && token->isExpired()) {
+        call->done = true;
+        ++m_timedOutRequests;
+        deliverFallback(call, "Action deadline exceeded", true);
+        return;
+    }
+
+    if (!m_breaker.allowRequest(&call->probe)) {
+        ++m_rejectedRequests;
+        qWarning() << "⚡ Запобіжник відкритий, запит не виконується:" << call->url.toString();
+        deliverFallback(call, "Palantír backend degraded");
+        return;
+    }
+
+    call->elapsed.start();
+    ++m_inFlight;
+    if (token) {
+        token->addWork();
+        call->onCancel = connect(token.get(), &ActionToken::cancelled, this, [this, call]() {
+            abortCall(call);
+        });
+    }
+    startAttempt(call);
+
+    // 🔹 Hedging: якщо відповідь повільніша за p95 — надсилаємо дубль
+    //    (але не пробний запит: поки запобіжник не закритий, до бекенду йде рівно один)
+    if (config.hedging && !call->onChunk && !call->probe) {
+        int p95 = percentile95(endpoint);
+        if (p95 > 0) {
+            QTimer::singleShot(p95, this, [this, call]() {
+                if (call->done || call->cancelled || call->replies.size() != 1
+                    || m_breaker.state() != CircuitBreaker::State::Closed) {
+                    return;
+                }
+                ++m_hedgedRequests;
+                qDebug() << "🔁 Hedged-запит до" << call->url.toString();
+                startAttempt(call);
+            });
+        }
+    }
+}
+
+void PalantirGateway::startAttempt(const std::shared_ptr<PendingCall> &call) {
+    const ConfigSnapshot &config = Config::current();
+    QNetworkRequest request(call->url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    // 🔹 Дедлайн дії обмежує дедлайн endpoint'у: відповідь після нього вже не знадобиться
+    auto attempt = std::make_shared<Attempt>();
+    int timeoutMs = config.backendTimeoutMs(call->endpoint);
+    if (call->token && !call->token->deadline().isForever()) {
+        attempt->deadline = call->token->deadline();
+        attempt->deadlineClipped = attempt->deadline.remainingTime() < timeoutMs;
+        timeoutMs = int(qBound<qint64>(1, attempt->deadline.remainingTime(), timeoutMs));
+    }
+    request.setTransferTimeout(timeoutMs);
+    if (call->pipelined) {
+        request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    }
+
+    // 🔹 Власний Accept-Encoding вимикає прозоре розпакування Qt —
+    //    так бачимо реальний обсяг трафіку і підтримуємо zstd
+    if (config.compression && ContentDecoder::isAvailable()) {
+        request.setRawHeader("Accept-Encoding", ContentDecoder::acceptEncoding());
+        attempt->manualDecoding = true;
+    }
+
+    QNetworkReply *reply = networkManager->get(request);
+    attempt->reply = reply;
+    attempt->sink = call->onChunk;
+    attempt->capture = m_recorder && call->onChunk;
+    call->replies.append(reply);
+
+    connect(reply, &QNetworkReply::readyRead, this, [attempt]() {
+        if (!readAttempt(*attempt)) {
+            attempt->reply->abort();
+        }
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, call, attempt]() {
+        onAttemptFinished(call, attempt);
+    });
+}
+
+/**
+ * @brief Читає доступні байти відповіді, розпаковуючи їх за Content-Encoding
+ * @return false, якщо потік пошкоджено або кодування не підтримується
+ */
+bool PalantirGateway::readAttempt(Attempt &attempt) {
+    if (!attempt.decoder) {
+        QByteArray encoding = attempt.manualDecoding ? attempt.reply->rawHeader("Content-Encoding") : QByteArray();
+        attempt.decoder = std::make_unique<ContentDecoder>(encoding);
+    }
+
+    if (!attempt.decoder->decode(attempt.reply->readAll(), attempt.body)) {
+        qWarning() << "❌ Не вдалося розпакувати відповідь Palantír:" << attempt.decoder->errorString();
+        return false;
+    }
+
+    // 🔹 Потоковий запит: віддаємо частину одразу, тіло не накопичуємо
+    if (attempt.sink && !attempt.body.isEmpty() && attempt.reply->error() == QNetworkReply::NoError
+        && attempt.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() < 400) {
+        if (attempt.capture) {
+            attempt.captured += attempt.body;
+        }
+        attempt.sink(attempt.body);
+        attempt.body.clear();
+    }
+    return true;
+}
+
+void PalantirGateway::recordCompression(const QString &endpoint, const Attempt &attempt) {
+    CompressionStats &stats = m_compression[endpoint];
+    ++stats.responses;
+    stats.encodedBytes += quint64(attempt.decoder->encodedBytes());
+    stats.decodedBytes += quint64(attempt.decoder->decodedBytes());
+
+    if (attempt.decoder->encodedBytes() != attempt.decoder->decodedBytes()) {
+        qDebug() << "🗜" << endpoint << attempt.decoder->encodedBytes() << "→" << attempt.decoder->decodedBytes()
+                 << "байт, середнє стиснення" << QString::number(stats.ratio(), 'f', 2) << "x";
+    }
+}
+
+QString PalantirGateway::callKey(const PendingCall &call) {
+    return call.endpoint + "?" + call.url.query(QUrl::FullyEncoded);
+}
+
+/**
+ * @brief Пише обмін у журнал трафіку (якщо увімкнено запис)
+ */
+void PalantirGateway::recordExchange(const PendingCall &call, const Attempt &attempt, const QByteArray &body) {
+    if (!m_recorder) {
+        return;
+    }
+    int httpStatus = attempt.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    m_recorder->recordPalantir(callKey(call), httpStatus,
+                               call.elapsed.elapsed(), attempt.capture ? attempt.captured : body);
+}
+
+void PalantirGateway::onAttemptFinished(const std::shared_ptr<PendingCall> &call, const std::shared_ptr<Attempt> &attempt) {
+    QNetworkReply *reply = attempt->reply;
+    reply->deleteLater();
+    call->replies.removeOne(reply);
+
+    if (call->done) {
+        return;  // Відповідь уже віддано (спрацювала інша спроба)
+    }
+
+    // 🔹 Скасована дія — не збій бекенду і не привід для кешу
+    if (call->cancelled) {
+        if (!call->replies.isEmpty()) {
+            return;
+        }
+        finishCall(call);
+        ++m_cancelledRequests;
+        m_breaker.recordCancelled(call->probe);
+        deliverCancelled(call);
+        return;
+    }
+
+    // 🔹 Спробу обрізано дедлайном, який тим часом подовжила інша дія спільного запиту — повторюємо
+    const bool clippedTimeout = attempt->deadlineClipped && reply->error() == QNetworkReply::OperationCanceledError;
+    if (clippedTimeout && call->token->deadline() > attempt->deadline) {
+        if (call->replies.isEmpty()) {
+            startAttempt(call);
+        }
+        return;
+    }
+
+    // 🔹 Вичерпаний дедлайн дії — тайм-аут бекенду: користувач досі чекає на кеш або повідомлення
+    const bool deadlineHit = clippedTimeout || (call->token && call->token->isExpired()
+                                                && reply->error() == QNetworkReply::OperationCanceledError);
+    if (deadlineHit) {
+        if (!call->replies.isEmpty()) {
+            return;
+        }
+        finishCall(call);
+        ++m_timedOutRequests;
+        recordExchange(*call, *attempt, attempt->body);
+        m_breaker.recordFailure();
+        qWarning() << "⌛ Palantír не відповів до дедлайну дії:" << call->url.toString();
+        deliverFallback(call, "Action deadline exceeded", true);
+        return;
+    }
+
+    QNetworkReply::NetworkError error = reply->error();
+    QString errorString = reply->errorString();
+
+    // 🔹 Пошкоджений стиснений потік — збій бекенду, як і обірване з'єднання
+    bool decodeFailed = attempt->decoder && !attempt->decoder->errorString().isEmpty();
+    if (!decodeFailed && error == QNetworkReply::NoError) {
+        decodeFailed = !readAttempt(*attempt) || !attempt->decoder->finish();
+    }
+    if (decodeFailed) {
+        error = QNetworkReply::ProtocolFailure;
+        errorString = attempt->decoder->errorString();
+    }
+
+    if (error == QNetworkReply::NoError) {
+        finishCall(call);
+
+        // 🔹 Скасовуємо спроби, що ще тривають
+        const QList<QNetworkReply *> others = call->replies;
+        call->replies.clear();
+        for (QNetworkReply *other : others) {
+            other->abort();
+        }
+
+        recordLatency(call->endpoint, call->elapsed.elapsed());
+        recordCompression(call->endpoint, *attempt);
+        m_breaker.recordSuccess();
+
+        PalantirResponse response;
+        response.ok = true;
+        response.body = std::move(attempt->body);
+        response.fetchedAt = QDateTime::currentDateTime();
+        if (call->cacheable) {
+            m_cache.insert(call->url.toString(), new CachedBody{response.body, response.fetchedAt});
+            if (m_snapshot) {
+                m_snapshot->store(callKey(*call), response.body, response.fetchedAt);
+            }
+        }
+        recordExchange(*call, *attempt, response.body);
+
+        call->callback(response);
+        return;
+    }
+
+    if (!call->replies.isEmpty()) {
+        return;  // Hedge ще може встигнути
+    }
+
+    finishCall(call);
+
+    // 🔹 4xx — відповідь бекенду по суті, а не його несправність
+    bool contentError = error >= QNetworkReply::ContentAccessDenied && error < QNetworkReply::ProtocolUnknownError;
+    recordExchange(*call, *attempt, attempt->body);
+
+    if (contentError) {
+        m_breaker.recordSuccess();
+        PalantirResponse response;
+        response.errorString = errorString;
+        call->callback(response);
+        return;
+    }
+
+    m_breaker.recordFailure();
+    qWarning() << "❌ Palantír не відповів вчасно або з помилкою:" << call->url.toString() << errorString;
+    deliverFallback(call, errorString);
+}
+
+/**
+ * @brief Дію скасовано: обриваємо всі спроби, відповідь віддасть onAttemptFinished останньої
+ */
+void PalantirGateway::abortCall(const std::shared_ptr<PendingCall> &call) {
+    if (call->done || call->cancelled) {
+        return;
+    }
+    call->cancelled = true;
+
+    const QList<QNetworkReply *> replies = call->replies;
+    for (QNetworkReply *reply : replies) {
+        reply->abort();
+    }
+}
+
+void PalantirGateway::finishCall(const std::shared_ptr<PendingCall> &call) {
+    call->done = true;
+    --m_inFlight;
+    if (call->token) {
+        disconnect(call->onCancel);
+        call->token->doneWork();
+    }
+}
+
+void PalantirGateway::deliverCancelled(const std::shared_ptr<PendingCall> &call) {
+    qDebug() << "🚫 Запит дії" << call->token->action() << "скасовано:" << call->url.toString();
+    PalantirResponse response;
+    response.cancelled = true;
+    response.errorString = "Action cancelled";
+    call->callback(response);
+}
+
+/**
+ * @brief Віддає кешовану відповідь або ознаку деградації бекенду
+ */
+void PalantirGateway::deliverFallback(const std::shared_ptr<PendingCall> &call, const QString &errorString, bool timedOut) {
+    PalantirResponse response;
+    response.degraded = true;
+    response.timedOut = timedOut;
+    response.errorString = errorString;
+
+    const ConfigSnapshot &config = Config::current();
+    const QDateTime now = QDateTime::currentDateTime();
+    CachedBody *cached = m_cache.object(call->url.toString());
+    if (cached && cached->fetchedAt.secsTo(now) <= config.staleCacheTtlSec) {
+        response.ok = true;
+        response.fromCache = true;
+        response.body = cached->body;
+        response.fetchedAt = cached->fetchedAt;
+    } else if (m_snapshot) {
+        // 🔹 Після перезапуску кеш у пам'яті порожній — беремо знімок з диска
+        QByteArray body;
+        QDateTime fetchedAt;
+        if (m_snapshot->lookup(callKey(*call), &body, &fetchedAt) && fetchedAt.secsTo(now) <= config.snapshotMaxAgeSec) {
+            response.ok = true;
+            response.fromCache = true;
+            response.body = body;
+            response.fetchedAt = fetchedAt;
+        }
+    }
+
+    call->callback(response);
+}
+
+void PalantirGateway::recordLatency(const QString &endpoint, qint64 ms) {
+    QList<int> &samples = m_latencies[endpoint];
+    if (samples.size() >= kLatencySamples) {
+        samples.removeFirst();
+    }
+    samples.append(int(ms));
+}
+
+int PalantirGateway::percentile95(const QString &endpoint) const {
+    QList<int> samples = m_latencies.value(endpoint);
+    if (samples.size() < kMinSamplesForHedge) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    return qMax(1, samples.at((samples.size() * 95) / 100));
+}
@@ -0,0 +1,184 @@
+#ifndef PALANTIRGATEWAY_H
+#define PALANTIRGATEWAY_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QUrlQuery>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <memory>
+#include <functional>
+#include "contentdecoder.h"
+#include "actiontoken.h"
+
+class TrafficRecorder;
+class CatalogSnapshot;
+
+// 🔹 Результат запиту до Palantír
+struct PalantirResponse {
+    bool ok = false;          // Тіло відповіді придатне для обробки
+    bool fromCache = false;   // Відповідь узята з кешу, бо бекенд недоступний
+    bool degraded = false;    // Бекенд деградований (запобіжник відкритий або дедлайн вичерпано)
+    bool timedOut = false;    // Вичерпано дедлайн дії (разом із degraded; тіло — з кешу, якщо є)
+    bool cancelled = false;   // Дію скасовано — відповідь нікому не потрібна
+    QByteArray body;
+    QString errorString;
+    QDateTime fetchedAt;      // Коли відповідь була отримана від бекенду
+};
+
+/**
+ * @brief Запобіжник (circuit breaker) для викликів Palantír.
+ *
+ * Після серії невдач відкривається і одразу відхиляє запити,
+ * через паузу пропускає один пробний запит (half-open).
+ */
+class CircuitBreaker {
+public:
+    enum class State { Closed, Open, HalfOpen };
+
+    explicit CircuitBreaker(int failureThreshold = 5, int openMs = 30000);
+
+    void setLimits(int failureThreshold, int openMs);
+
+    bool allowRequest(bool *probe = nullptr);   // Чи можна зараз звертатися до бекенду; probe — це пробний запит
+    void recordSuccess();
+    void recordFailure();
+    void recordCancelled(bool probe);           // Запит обірвано до відповіді — бекенд не оцінюємо
+    State state() const { return m_state; }
+
+private:
+    int m_failureThreshold;
+    int m_openMs;
+    int m_failures = 0;
+    State m_state = State::Closed;
+    bool m_probeInFlight = false;
+    QElapsedTimer m_openedAt;
+};
+
+/**
+ * @brief Шар стійкості для запитів до Palantír.
+ *
+ * Кожен запит має дедлайн за endpoint'ом, проходить через запобіжник,
+ * а для ідемпотентних GET може бути продубльований (hedged), якщо перша
+ * відповідь повільніша за p95 цього endpoint'у. Запит дії користувача
+ * (ActionToken) не переживає її дедлайн і обривається при скасуванні.
+ */
+class PalantirGateway : public QObject {
+    Q_OBJECT
+public:
+    using Callback = std::function<void(const PalantirResponse &)>;
+    using ChunkCallback = std::function<void(const QByteArray &)>;
+
+    explicit PalantirGateway(QNetworkAccessManager *networkManager, QObject *parent = nullptr);
+
+    // GET /endpoint?query; token — дія користувача, якій належить запит
+    void get(const QString &endpoint, const QUrlQuery &query, Callback callback,
+             const ActionToken::Ptr &token = nullptr);
+    void getStream(const QString &endpoint, const QUrlQuery &query, ChunkCallback onChunk, Callback callback,
+                   const ActionToken::Ptr &token = nullptr);
+    // Те саме, що get, але з HTTP/1.1 pipelining — для серії дрібних незалежних запитів
+    void getPipelined(const QString &endpoint, const QUrlQuery &query, Callback callback,
+                      const ActionToken::Ptr &token = nullptr);
+    // Пакетний запит: сама відповідь не кешується — частини зберігає викликач через storeResponse
+    void getBulk(const QString &endpoint, const QUrlQuery &query, Callback callback,
+                 const ActionToken::Ptr &token = nullptr);
+    // Відповідь endpoint'у, отримана у складі пакета: кеш і знімок, як після окремого запиту
+    void storeResponse(const QString &endpoint, const QUrlQuery &query, const QByteArray &body, const QDateTime &fetchedAt);
+    void setRecorder(TrafficRecorder *recorder) { m_recorder = recorder; }  // Запис обміну для replay
+    void setSnapshot(CatalogSnapshot *snapshot) { m_snapshot = snapshot; }  // Останній рубіж деградованого режиму
+
+    CircuitBreaker::State breakerState() const { return m_breaker.state(); }
+    int inFlight() const { return m_inFlight; }
+    quint64 hedgedRequests() const { return m_hedgedRequests; }
+    quint64 rejectedRequests() const { return m_rejectedRequests; }
+    quint64 cancelledRequests() const { return m_cancelledRequests; }   // Обірвано через скасування дії
+    quint64 timedOutRequests() const { return m_timedOutRequests; }     // Не встигли до дедлайну дії
+
+    // 🔹 Статистика стиснення: байти з мережі проти розпакованих
+    struct CompressionStats {
+        quint64 responses = 0;
+        quint64 encodedBytes = 0;
+        quint64 decodedBytes = 0;
+        double ratio() const { return encodedBytes ? double(decodedBytes) / double(encodedBytes) : 1.0; }
+    };
+    CompressionStats compressionStats(const QString &endpoint) const { return m_compression.value(endpoint); }
+    QHash<QString, CompressionStats> compressionStats() const { return m_compression; }
+
+    // 🔹 Кеш відповідей для передачі новому процесу
+    struct CachedResponse {
+        QString url;
+        QByteArray body;
+        QDateTime fetchedAt;
+    };
+    QList<CachedResponse> cachedResponses() const;
+    void warmCache(const QList<CachedResponse> &responses);
+
+private:
+    struct PendingCall {
+        QString endpoint;
+        QUrl url;
+        Callback callback;
+        ChunkCallback onChunk;           // Лише для потокових запитів
+        QList<QNetworkReply *> replies;  // Основна спроба + можливий hedge
+        QElapsedTimer elapsed;
+        ActionToken::Ptr token;
+        QMetaObject::Connection onCancel;
+        bool cancelled = false;          // Спроби обриваються через скасування дії
+        bool pipelined = false;          // Дозволено HTTP/1.1 pipelining
+        bool cacheable = true;           // Успішна відповідь іде в кеш і знімок
+        bool probe = false;              // Пробний запит напіввідкритого запобіжника
+        bool done = false;
+    };
+
+    // 🔹 Одна HTTP-спроба: тіло розпаковується потоково з readyRead
+    struct Attempt {
+        QNetworkReply *reply = nullptr;
+        bool manualDecoding = false;              // Accept-Encoding виставлено нами, Qt не розпаковує
+        std::unique_ptr<ContentDecoder> decoder;
+        QByteArray body;
+        ChunkCallback sink;                       // Потоковий запит: частини віддаються одразу
+        bool capture = false;                     // Потоковий запит під час запису трафіку
+        QByteArray captured;
+        bool deadlineClipped = false;             // transferTimeout обрізано дедлайном дії
+        QDeadlineTimer deadline;                  // Дедлайн дії на момент спроби
+    };
+
+    struct CachedBody {
+        QByteArray body;
+        QDateTime fetchedAt;
+    };
+
+    void dispatch(const QString &endpoint, const QUrlQuery &query, Callback callback, ChunkCallback onChunk,
+                  const ActionToken::Ptr &token, bool pipelined = false, bool cacheable = true);
+    void startAttempt(const std::shared_ptr<PendingCall> &call);
+    void abortCall(const std::shared_ptr<PendingCall> &call);
+    void finishCall(const std::shared_ptr<PendingCall> &call);          // Більше жодних відповідей цього виклику
+    void deliverCancelled(const std::shared_ptr<PendingCall> &call);
+    void onAttemptFinished(const std::shared_ptr<PendingCall> &call, const std::shared_ptr<Attempt> &attempt);
+    static bool readAttempt(Attempt &attempt);   // Дочитує і розпаковує доступні байти
+    void recordCompression(const QString &endpoint, const Attempt &attempt);
+    void recordExchange(const PendingCall &call, const Attempt &attempt, const QByteArray &body);
+    static QString callKey(const PendingCall &call);   // "endpoint?query" — ключ журналу і знімка
+    void deliverFallback(const std::shared_ptr<PendingCall> &call, const QString &errorString, bool timedOut = false);
+    void recordLatency(const QString &endpoint, qint64 ms);
+    int percentile95(const QString &endpoint) const;
+
+    QNetworkAccessManager *networkManager;
+    CircuitBreaker m_breaker;
+    QCache<QString, CachedBody> m_cache;          // Остання успішна відповідь за URL
+    QHash<QString, QList<int>> m_latencies;       // Кільцеві буфери затримок за endpoint'ом
+    QHash<QString, CompressionStats> m_compression;
+    TrafficRecorder *m_recorder = nullptr;
+    CatalogSnapshot *m_snapshot = nullptr;
+    int m_inFlight = 0;
+    quint64 m_hedgedRequests = 0;
+    quint64 m_rejectedRequests = 0;
+    quint64 m_cancelledRequests = 0;
+    quint64 m_timedOutRequests = 0;
+};
+
+#endif // PALANTIRGATEWAY_H
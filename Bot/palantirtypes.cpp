@@ -0,0 +1,85 @@
+#include "palantirtypes.h"
+#include <QJsonArray>
+
+namespace Palantir {
+
+static Dispenser dispenserFromJson(const QJsonObject &obj) {
+    Dispenser dispenser;
+    dispenser.dispenserId = obj["dispenser_id"].toInt();
+    dispenser.protocol = obj["protocol"].toString();
+    dispenser.port = obj["port"].toInt();
+    dispenser.speed = obj["speed"].toInt();
+    dispenser.address = obj["address"].toInt();
+
+    const QJsonArray pumps = obj["pumps_info"].toArray();
+    dispenser.pumps.reserve(pumps.size());
+    for (const QJsonValue &val : pumps) {
+        QJsonObject pumpObj = val.toObject();
+        Pump pump;
+        pump.pumpId = pumpObj["pump_id"].toInt();
+        pump.tankId = pumpObj["tank_id"].toInt();
+        pump.fuelShortName = pumpObj["fuel_shortname"].toString();
+        dispenser.pumps.append(pump);
+    }
+    return dispenser;
+}
+
+Terminal terminalFromJson(const QJsonObject &obj) {
+    Terminal terminal;
+    terminal.terminalId = obj["terminal_id"].toInt();
+    terminal.clientName = obj["client_name"].toString();
+    terminal.address = obj["adress"].toString();   // Так у Palantír
+    terminal.phone = obj["phone"].toString();
+    terminal.hasCoordinates = obj.contains("latitude") && obj.contains("longitude");
+    terminal.latitude = obj["latitude"].toDouble();
+    terminal.longitude = obj["longitude"].toDouble();
+
+    const QJsonArray dispensers = obj["dispensers_info"].toArray();
+    terminal.dispensers.reserve(dispensers.size());
+    for (const QJsonValue &val : dispensers) {
+        terminal.dispensers.append(dispenserFromJson(val.toObject()));
+    }
+    return terminal;
+}
+
+QList<Reservoir> reservoirsFromJson(const QJsonObject &obj) {
+    const QJsonArray array = obj["reservoirs_info"].toArray();
+    QList<Reservoir> reservoirs;
+    reservoirs.reserve(array.size());
+    for (const QJsonValue &val : array) {
+        QJsonObject item = val.toObject();
+        Reservoir reservoir;
+        reservoir.tankId = item["tank_id"].toInt();
+        reservoir.name = item["name"].toString();
+        reservoir.shortName = item["shortname"].toString();
+        reservoir.minValue = item["minvalue"].toInt();
+        reservoir.maxValue = item["maxvalue"].toInt();
+        reservoir.deadMin = item["deadmin"].toInt();
+        reservoir.deadMax = item["deadmax"].toInt();
+        reservoir.tubeAmount = item["tubeamount"].toInt();
+        reservoirs.append(reservoir);
+    }
+    return reservoirs;
+}
+
+QList<PosData> posdatasFromJson(const QJsonObject &obj) {
+    const QJsonArray array = obj["posdatas"].toArray();
+    QList<PosData> posdatas;
+    posdatas.reserve(array.size());
+    for (const QJsonValue &val : array) {
+        QJsonObject item = val.toObject();
+        PosData pos;
+        pos.posId = item["pos_id"].toInt();
+        pos.manufacturer = item["manufacturer"].toString();
+        pos.model = item["model"].toString();
+        pos.posVersion = item["posversion"].toString();
+        pos.mukVersion = item["mukversion"].toString();
+        pos.factoryNumber = item["factorynumber"].toString();
+        pos.regNumber = item["regnumber"].toString();
+        pos.registeredAt = item["datreg"].toString();
+        posdatas.append(pos);
+    }
+    return posdatas;
+}
+
+}
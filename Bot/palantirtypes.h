@@ -0,0 +1,93 @@
+#ifndef PALANTIRTYPES_H
+#define PALANTIRTYPES_H
+
+#include <QString>
+#include <QList>
+#include <QDateTime>
+#include <QJsonObject>
+
+// 🔹 Відповіді Palantír у вигляді простих структур (розбираються один раз)
+namespace Palantir {
+
+struct Pump {
+    int pumpId = 0;
+    int tankId = 0;
+    QString fuelShortName;
+};
+
+struct Dispenser {
+    int dispenserId = 0;
+    QString protocol;
+    int port = 0;
+    int speed = 0;
+    int address = 0;
+    QList<Pump> pumps;
+};
+
+struct Terminal {
+    int terminalId = 0;
+    QString clientName;
+    QString address;
+    QString phone;
+    bool hasCoordinates = false;   // Обидва поля latitude/longitude присутні у відповіді
+    double latitude = 0.0;
+    double longitude = 0.0;
+    QList<Dispenser> dispensers;
+};
+
+struct Reservoir {
+    int tankId = 0;
+    QString name;
+    QString shortName;
+    int minValue = 0;
+    int maxValue = 0;
+    int deadMin = 0;
+    int deadMax = 0;
+    int tubeAmount = 0;
+};
+
+struct PosData {
+    int posId = 0;
+    QString manufacturer;
+    QString model;
+    QString posVersion;
+    QString mukVersion;
+    QString factoryNumber;
+    QString regNumber;
+    QString registeredAt;          // datreg як є (ISO-дата або довільний текст)
+};
+
+Terminal terminalFromJson(const QJsonObject &obj);
+QList<Reservoir> reservoirsFromJson(const QJsonObject &obj);   // reservoirs_info
+QList<PosData> posdatasFromJson(const QJsonObject &obj);       // posdatas
+
+}
+
+// 🔹 Чому запит не дав даних
+enum class PalantirStatus {
+    Ok,
+    Unavailable,     // Бекенд деградований і кешу немає
+    RequestFailed,   // Помилка HTTP (4xx тощо)
+    BadPayload,      // Тіло не є JSON-об'єктом
+    ServerError,     // Palantír повернув {"error": "..."}
+    TimedOut,        // Вичерпано дедлайн дії, а кешу немає
+    Cancelled        // Дію користувача скасовано — відповідь нікому не потрібна
+};
+
+// 🔹 Стан типізованого запиту, спільний для всіх типів результату
+struct PalantirOutcome {
+    PalantirStatus status = PalantirStatus::RequestFailed;
+    bool fromCache = false;   // Дані з кешу, бо бекенд недоступний
+    QString errorString;      // Текст помилки мережі або поле "error" від сервера
+    QDateTime fetchedAt;
+
+    bool ok() const { return status == PalantirStatus::Ok; }
+};
+
+// 🔹 Типізований результат запиту до Palantír
+template <typename T>
+struct PalantirResult : PalantirOutcome {
+    T value;
+};
+
+#endif // PALANTIRTYPES_H
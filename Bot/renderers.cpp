@@ -0,0 +1,170 @@
+#include "renderers.h"
+#include <QDateTime>
+
+namespace Renderers {
+
+QString terminalCard(const Palantir::Terminal &terminal) {
+    QString responseText;
+    responseText += QString("🏪 <b>АЗС:</b> %1\n").arg(terminal.clientName);
+    responseText += QString("⛽ <b>Термінал:</b> %1\n").arg(terminal.terminalId);
+    responseText += QString("📍 <b>Адреса:</b> %1\n").arg(terminal.address);
+    responseText += QString("📞 <b>Телефон:</b> <code>%1</code>\n\n").arg(terminal.phone);
+    return responseText;
+}
+
+QString reservoirs(const QList<Palantir::Reservoir> &reservoirs) {
+    QString responseText = "🛢 <b>Інформація про резервуари</b>\n";
+    for (const Palantir::Reservoir &reservoir : reservoirs) {
+        responseText += QString("🔹 <b>Резервуар %1</b> – %2, %3:\n")
+                            .arg(reservoir.tankId)
+                            .arg(reservoir.name)
+                            .arg(reservoir.shortName);
+        responseText += QString("   🔽 <b>Min:</b> %1  |  🔼 <b>Max:</b> %2\n")
+                            .arg(reservoir.minValue)
+                            .arg(reservoir.maxValue);
+        responseText += QString("   📏 <b>Рівномір:</b> %1 - %2\n")
+                            .arg(reservoir.deadMin)
+                            .arg(reservoir.deadMax);
+        responseText += QString("   🏭 <b>Трубопровід:</b> %1\n\n")
+                            .arg(reservoir.tubeAmount);
+    }
+    return responseText;
+}
+
+QString prk(const QList<Palantir::Dispenser> &dispensers) {
+    QString responseText = "<b>Конфігурація ПРК</b>\n";
+
+    if (dispensers.isEmpty()) {
+        responseText += "ℹ️ Дані про ПРК відсутні.";
+        return responseText;
+    }
+
+    for (const Palantir::Dispenser &dispenser : dispensers) {
+        responseText += QString("🔹 <b>ПРК %1:</b> %2, порт %3, швидкість %4, адреса %5\n")
+                            .arg(dispenser.dispenserId).arg(dispenser.protocol).arg(dispenser.port)
+                            .arg(dispenser.speed).arg(dispenser.address);
+
+        for (int i = 0; i < dispenser.pumps.size(); ++i) {
+            const Palantir::Pump &pump = dispenser.pumps.at(i);
+
+            if (i == dispenser.pumps.size() - 1) {
+                responseText += QString("  └ 🛠 Пістолет %1 (резервуар %2) – %3\n")
+                                    .arg(pump.pumpId).arg(pump.tankId).arg(pump.fuelShortName);
+            } else {
+                responseText += QString("  ├ 🛠 Пістолет %1 (резервуар %2) – %3\n")
+                                    .arg(pump.pumpId).arg(pump.tankId).arg(pump.fuelShortName);
+            }
+        }
+    }
+    return responseText;
+}
+
+QString rro(const QList<Palantir::PosData> &posdatas) {
+    QString responseText = "<b>💳 Інформація про каси</b>\n\n";
+    for (const Palantir::PosData &pos : posdatas) {
+        responseText += QString("🧾 Каса №%1\n").arg(pos.posId);
+        responseText += QString("• Виробник: %1\n").arg(pos.manufacturer);
+        responseText += QString("• Модель: %1\n").arg(pos.model);
+        responseText += QString("• Версія ПО РРО: %1\n").arg(pos.posVersion);
+        responseText += QString("• Версія ПО МУК: %1\n").arg(pos.mukVersion);
+        responseText += QString("• ЗН: %1\n").arg(pos.factoryNumber);
+        responseText += QString("• ФН: %1\n").arg(pos.regNumber);
+        QString dateOnly;
+        if (!pos.registeredAt.isEmpty()) {
+            QDateTime dt = QDateTime::fromString(pos.registeredAt, Qt::ISODate);
+            if (dt.isValid()) {
+                dateOnly = dt.date().toString("yyyy-MM-dd");
+            } else {
+                dateOnly = pos.registeredAt; // fallback, якщо не розпізналось
+            }
+        }
+        responseText += QString("• Дата реєстрації: %1\n\n").arg(dateOnly);
+    }
+    return responseText;
+}
+
+QString azsListHeader(bool continuation) {
+    return continuation ? "⛽ <b>Список АЗС (продовження)</b>\n" : "⛽ <b>Список АЗС</b>\n";
+}
+
+QString azsListLine(const QJsonObject &azs) {
+    return QString("🔹 %1 - %2\n")
+        .arg(azs["terminal_id"].toInt())
+        .arg(azs["name"].toString());
+}
+
+QString terminalBatchLine(const Palantir::Terminal &terminal) {
+    return QString("🔹 <b>%1</b> – %2, <code>%3</code>\n")
+        .arg(terminal.terminalId)
+        .arg(terminal.address, terminal.phone);
+}
+
+QString terminalBatchFailure(int terminalId, const QString &reason) {
+    return QString("❌ <b>%1</b> – %2\n").arg(terminalId).arg(reason);
+}
+
+QJsonObject clientsKeyboard(const QJsonArray &clients, int columns) {
+    QJsonArray keyboardArray;
+    QJsonArray row;
+
+    for (const QJsonValue &client : clients) {
+        row.append(client.toObject()["name"].toString());
+        if (row.size() == columns) {
+            keyboardArray.append(row);
+            row = QJsonArray();
+        }
+    }
+
+    if (!row.isEmpty()) {
+        keyboardArray.append(row);
+    }
+    keyboardArray.append(QJsonArray{ "🔙 Головне меню" });
+
+    QJsonObject keyboard;
+    keyboard["keyboard"] = keyboardArray;
+    keyboard["resize_keyboard"] = true;
+    keyboard["one_time_keyboard"] = false;
+    return keyboard;
+}
+
+QStringList chunked(const QStringList &lines, const QString &header, const QString &continuation, int messageLimit) {
+    QStringList parts;
+    QString responseText = header;
+
+    for (const QString &line : lines) {
+        if (responseText.size() + line.size() > messageLimit && responseText.size() > continuation.size()) {
+            parts.append(responseText);
+            responseText = continuation;
+        }
+        responseText += line;
+    }
+
+    parts.append(responseText);
+    return parts;
+}
+
+QStringList azsList(const QJsonArray &azsList, const QString &prefix, int messageLimit) {
+    QStringList parts;
+    QString responseText = prefix + azsListHeader(false);
+    int currentLength = responseText.size();
+
+    for (const QJsonValue &val : azsList) {
+        QString line = azsListLine(val.toObject());
+
+        if (currentLength + line.size() > messageLimit) {
+            parts.append(responseText);
+            responseText = azsListHeader(true);
+            currentLength = responseText.size();
+        }
+
+        responseText += line;
+        currentLength += line.size();
+    }
+
+    if (!responseText.isEmpty()) {
+        parts.append(responseText);
+    }
+    return parts;
+}
+
+}
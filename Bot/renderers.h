@@ -0,0 +1,28 @@
+#ifndef RENDERERS_H
+#define RENDERERS_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QJsonArray>
+#include "palantirtypes.h"
+
+// 🔹 Формування HTML-тексту повідомлень з відповідей Palantír
+namespace Renderers {
+
+QString terminalCard(const Palantir::Terminal &terminal);            // Картка терміналу (АЗС, адреса, телефон)
+QString reservoirs(const QList<Palantir::Reservoir> &reservoirs);   // Інформація про резервуари
+QString prk(const QList<Palantir::Dispenser> &dispensers);          // Конфігурація ПРК з пістолетами
+QString rro(const QList<Palantir::PosData> &posdatas);              // Інформація про каси
+QStringList azsList(const QJsonArray &azsList, const QString &prefix = QString(), int messageLimit = 3500); // Список АЗС частинами
+QString azsListHeader(bool continuation);                   // Заголовок частини списку АЗС
+QString azsListLine(const QJsonObject &azs);                // Рядок списку АЗС
+QString terminalBatchLine(const Palantir::Terminal &terminal);               // Рядок зведення кількох терміналів
+QString terminalBatchFailure(int terminalId, const QString &reason);         // Рядок терміналу, який не вдалося отримати
+QJsonObject clientsKeyboard(const QJsonArray &clients, int columns = 3);   // Клавіатура вибору клієнта з /clients
+QStringList chunked(const QStringList &lines, const QString &header, const QString &continuation,
+                    int messageLimit = 3500);                                // Рядки частинами до messageLimit
+
+}
+
+#endif // RENDERERS_H
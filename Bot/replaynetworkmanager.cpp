@@ -0,0 +1,153 @@
+#include "replaynetworkmanager.h"
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QTimer>
+#include <QDebug>
+#include <utility>
+
+/**
+ * @brief Готова відповідь, яка віддається після затримки
+ */
+class CannedReply : public QNetworkReply {
+public:
+    CannedReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request, int httpStatus,
+                const QByteArray &body, int delayMs, QObject *parent)
+        : QNetworkReply(parent), content(body) {
+        setRequest(request);
+        setUrl(request.url());
+        setOperation(op);
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+        if (httpStatus > 0) {
+            setAttribute(QNetworkRequest::HttpStatusCodeAttribute, httpStatus);
+            setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+            setHeader(QNetworkRequest::ContentLengthHeader, content.size());
+        }
+
+        QTimer::singleShot(qMax(0, delayMs), this, [this, httpStatus]() {
+            if (isFinished()) {
+                return;
+            }
+            if (httpStatus == 0) {
+                fail(QNetworkReply::TimeoutError, "Recorded request timed out");
+                return;
+            }
+            if (httpStatus >= 400) {
+                NetworkError code = httpStatus < 500 ? QNetworkReply::ContentNotFoundError : QNetworkReply::InternalServerError;
+                setError(code, QString("HTTP %1").arg(httpStatus));
+                emit errorOccurred(code);
+            }
+            emit metaDataChanged();
+            if (!content.isEmpty()) {
+                emit readyRead();
+            }
+            setFinished(true);
+            emit finished();
+        });
+    }
+
+    void abort() override {
+        if (!isFinished()) {
+            fail(QNetworkReply::OperationCanceledError, "Operation canceled");
+        }
+    }
+
+    qint64 bytesAvailable() const override {
+        return content.size() - offset + QIODevice::bytesAvailable();
+    }
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override {
+        qint64 count = qMin(maxSize, qint64(content.size()) - offset);
+        if (count <= 0) {
+            return isFinished() ? -1 : 0;
+        }
+        memcpy(data, content.constData() + offset, size_t(count));
+        offset += count;
+        return count;
+    }
+
+private:
+    void fail(NetworkError code, const QString &text) {
+        content.clear();
+        offset = 0;
+        setError(code, text);
+        emit errorOccurred(code);
+        setFinished(true);
+        emit finished();
+    }
+
+    QByteArray content;
+    qint64 offset = 0;
+};
+
+
+ReplayNetworkManager::ReplayNetworkManager(const QUrl &palantirBaseUrl, QObject *parent)
+    : QNetworkAccessManager(parent), palantirBaseUrl(palantirBaseUrl) {}
+
+void ReplayNetworkManager::addExchange(const TrafficRecord &record) {
+    scripts[record.key].exchanges.append(Exchange{record.httpStatus, record.durationMs, record.body});
+}
+
+QNetworkReply *ReplayNetworkManager::createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData) {
+    const QUrl url = request.url();
+    if (url.host() == palantirBaseUrl.host() && url.port(80) == palantirBaseUrl.port(80)) {
+        return track(palantirReply(op, request));
+    }
+    return track(telegramReply(op, request, outgoingData));
+}
+
+QNetworkReply *ReplayNetworkManager::track(QNetworkReply *reply) {
+    ++pending;
+    connect(reply, &QNetworkReply::finished, this, [this]() { --pending; });
+    return reply;
+}
+
+QNetworkReply *ReplayNetworkManager::palantirReply(Operation op, const QNetworkRequest &request) {
+    const QUrl url = request.url();
+    QString key = url.path().section('/', -1) + "?" + url.query(QUrl::FullyEncoded);
+
+    auto it = scripts.find(key);
+    if (it == scripts.end() || it->exchanges.isEmpty()) {
+        ++missed;
+        qWarning() << "⏯ Немає записаної відповіді для" << key;
+        return new CannedReply(op, request, 404, R"({"error":"Not recorded"})", 0, this);
+    }
+
+    Script &script = it.value();
+    const Exchange &exchange = script.exchanges.at(qMin(script.next, script.exchanges.size() - 1));
+    ++script.next;
+    ++served;
+
+    int delayMs = speed > 0 ? int(exchange.durationMs / speed) : 0;
+    return new CannedReply(op, request, exchange.httpStatus, exchange.body, delayMs, this);
+}
+
+QNetworkReply *ReplayNetworkManager::telegramReply(Operation op, const QNetworkRequest &request, QIODevice *outgoingData) {
+    QString method = request.url().path().section('/', -1);
+
+    // 🔹 chat_id з JSON або form-urlencoded тіла (multipart не розбираємо)
+    qint64 chatId = 0;
+    QByteArray payload = outgoingData ? outgoingData->readAll() : QByteArray();
+    QJsonObject json = QJsonDocument::fromJson(payload).object();
+    if (!json.isEmpty()) {
+        chatId = json["chat_id"].toVariant().toLongLong();
+    } else if (!payload.isEmpty()) {
+        chatId = QUrlQuery(QString::fromUtf8(payload)).queryItemValue("chat_id").toLongLong();
+    }
+    emit telegramRequest(method, chatId);
+
+    if (method == "getUpdates") {
+        const QJsonArray result = std::exchange(updates, QJsonArray());
+        QByteArray body = QJsonDocument(QJsonObject{{"ok", true}, {"result", result}}).toJson(QJsonDocument::Compact);
+        return new CannedReply(op, request, 200, body, 0, this);
+    }
+
+    QJsonObject result{{"message_id", nextMessageId++}, {"chat", QJsonObject{{"id", chatId}}}};
+    QByteArray body = QJsonDocument(QJsonObject{{"ok", true}, {"result", result}}).toJson(QJsonDocument::Compact);
+    return new CannedReply(op, request, 200, body, 0, this);
+}
@@ -0,0 +1,62 @@
+#ifndef REPLAYNETWORKMANAGER_H
+#define REPLAYNETWORKMANAGER_H
+
+#include <QNetworkAccessManager>
+#include <QHash>
+#include <QList>
+#include <QUrl>
+#include <QJsonObject>
+#include <QJsonArray>
+#include "trafficrecorder.h"
+
+/**
+ * @brief In-process двійник мережі для відтворення записаного трафіку.
+ *
+ * Запити до Palantír отримують записані відповіді з записаною затримкою
+ * (з урахуванням прискорення), виклики Telegram API — миттєву успішну
+ * відповідь. Жоден запит не виходить за межі процесу.
+ */
+class ReplayNetworkManager : public QNetworkAccessManager {
+    Q_OBJECT
+public:
+    explicit ReplayNetworkManager(const QUrl &palantirBaseUrl, QObject *parent = nullptr);
+
+    void addExchange(const TrafficRecord &record);   // Записана відповідь Palantír
+    void setSpeed(double factor) { speed = factor; } // 0 — без затримок
+    void queueUpdate(const QJsonObject &update) { updates.append(update); }   // Віддасть наступний getUpdates
+    int pendingReplies() const { return pending; }
+    quint64 palantirServed() const { return served; }
+    quint64 palantirMissed() const { return missed; }
+
+signals:
+    void telegramRequest(const QString &method, qint64 chatId);
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData) override;
+
+private:
+    struct Exchange {
+        int httpStatus = 0;
+        int durationMs = 0;
+        QByteArray body;
+    };
+    struct Script {
+        QList<Exchange> exchanges;
+        int next = 0;   // Відповіді видаються по черзі; остання повторюється
+    };
+
+    QNetworkReply *palantirReply(Operation op, const QNetworkRequest &request);
+    QNetworkReply *telegramReply(Operation op, const QNetworkRequest &request, QIODevice *outgoingData);
+    QNetworkReply *track(QNetworkReply *reply);
+
+    QUrl palantirBaseUrl;
+    QHash<QString, Script> scripts;
+    double speed = 1.0;
+    int pending = 0;
+    QJsonArray updates;
+    qint64 nextMessageId = 1;
+    quint64 served = 0;
+    quint64 missed = 0;
+};
+
+#endif // REPLAYNETWORKMANAGER_H
@@ -0,0 +1,74 @@
+#include "startupsequence.h"
+#include <QThreadPool>
+#include <QDebug>
+
+StartupSequence::StartupSequence(QNetworkAccessManager *networkManager, QObject *parent)
+    : QObject(parent), networkManager(networkManager) {
+    sinceLaunch.start();
+}
+
+/**
+ * @brief Виконує блокуючий крок у глобальному пулі потоків
+ * @param name Назва кроку (для логів і очікування готовності)
+ * @param work Робота у фоновому потоці — не повинна торкатися об'єктів головного потоку
+ * @param done Продовження в головному потоці після завершення work
+ */
+void StartupSequence::runInPool(const QString &name, std::function<void()> work, std::function<void()> done) {
+    beginStep(name);
+    QThreadPool::globalInstance()->start([this, name, work = std::move(work), done = std::move(done)]() {
+        work();
+        QMetaObject::invokeMethod(this, [this, name, done]() {
+            if (done) {
+                done();
+            }
+            finishStep(name);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void StartupSequence::beginStep(const QString &name) {
+    pending.insert(name);
+}
+
+void StartupSequence::finishStep(const QString &name) {
+    if (!pending.remove(name)) {
+        return;
+    }
+    qDebug() << "🚦 Крок старту завершено:" << name << "за" << sinceLaunch.elapsed() << "мс";
+    checkReady();
+}
+
+void StartupSequence::preconnect(const QUrl &url) {
+    if (!url.isValid() || url.host().isEmpty()) {
+        return;
+    }
+
+    if (url.scheme() == "https") {
+        networkManager->connectToHostEncrypted(url.host(), quint16(url.port(443)));
+    } else {
+        networkManager->connectToHost(url.host(), quint16(url.port(80)));
+    }
+    qDebug() << "🔌 Попереднє з'єднання з" << url.host();
+}
+
+void StartupSequence::start() {
+    started = true;
+    checkReady();
+}
+
+void StartupSequence::checkReady() {
+    if (!started || ready_ || !pending.isEmpty()) {
+        return;
+    }
+    ready_ = true;
+    qInfo() << "✅ Бот готовий за" << sinceLaunch.elapsed() << "мс";
+    emit ready(sinceLaunch.elapsed());
+}
+
+void StartupSequence::markFirstReply() {
+    if (firstReplySeen) {
+        return;
+    }
+    firstReplySeen = true;
+    qInfo() << "⏱ Time-to-first-reply:" << sinceLaunch.elapsed() << "мс";
+}
@@ -0,0 +1,49 @@
+#ifndef STARTUPSEQUENCE_H
+#define STARTUPSEQUENCE_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QUrl>
+#include <functional>
+
+/**
+ * @brief Паралельний старт бота.
+ *
+ * Незалежні кроки (ротація логів, списки доступу, каталог клієнтів)
+ * виконуються одночасно: блокуючі — у QThreadPool, мережеві — асинхронно.
+ * TLS-з'єднання з Telegram і Palantír відкриваються заздалегідь.
+ * ready() надсилається, коли всі кроки завершені і бот відповідає з пам'яті.
+ */
+class StartupSequence : public QObject {
+    Q_OBJECT
+public:
+    explicit StartupSequence(QNetworkAccessManager *networkManager, QObject *parent = nullptr);
+
+    // Блокуючий крок у фоновому потоці; done викликається в потоці StartupSequence
+    void runInPool(const QString &name, std::function<void()> work, std::function<void()> done = nullptr);
+    void beginStep(const QString &name);    // Асинхронний крок, що завершиться через finishStep()
+    void finishStep(const QString &name);
+    void preconnect(const QUrl &url);       // Відкриває з'єднання (TLS для https) до першого запиту
+    void start();                           // Більше кроків не буде — чекаємо завершення наявних
+
+    void markFirstReply();                  // Перша відповідь користувачу після запуску
+    bool isReady() const { return ready_; }
+    qint64 elapsedMs() const { return sinceLaunch.elapsed(); }
+
+signals:
+    void ready(qint64 elapsedMs);
+
+private:
+    void checkReady();
+
+    QNetworkAccessManager *networkManager;
+    QElapsedTimer sinceLaunch;
+    QSet<QString> pending;
+    bool started = false;
+    bool ready_ = false;
+    bool firstReplySeen = false;
+};
+
+#endif // STARTUPSEQUENCE_H
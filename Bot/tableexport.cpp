@@ -0,0 +1,393 @@
+#include "tableexport.h"
+#include <QDateTime>
+#include <QDir>
+#include <QList>
+
+#ifdef SHADOWFAX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+static const char kCsvSeparator = ';';   // Excel з українською локаллю чекає саме ';'
+
+// 🔹 Службові частини пакета XLSX (незмінні)
+static const char kContentTypes[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+    "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+    "<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+    "<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+    "<Override PartName=\"/xl/worksheets/sheet1.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+    "</Types>";
+
+static const char kRootRels[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+    "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument\" Target=\"xl/workbook.xml\"/>"
+    "</Relationships>";
+
+static const char kWorkbook[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<workbook xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" "
+    "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">"
+    "<sheets><sheet name=\"%1\" sheetId=\"1\" r:id=\"rId1\"/></sheets></workbook>";
+
+static const char kWorkbookRels[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+    "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet1.xml\"/>"
+    "</Relationships>";
+
+static const char kSheetHead[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\"><sheetData>";
+
+static const char kSheetTail[] = "</sheetData></worksheet>";
+
+static quint32 crc32Update(quint32 crc, const QByteArray &data) {
+    static const QList<quint32> table = []() {
+        QList<quint32> t(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (char byte : data) {
+        crc = table[(crc ^ quint8(byte)) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void putLE16(QByteArray &out, quint16 value) {
+    out.append(char(value & 0xFF));
+    out.append(char(value >> 8));
+}
+
+static void putLE32(QByteArray &out, quint32 value) {
+    putLE16(out, quint16(value & 0xFFFF));
+    putLE16(out, quint16(value >> 16));
+}
+
+// 🔹 Текст для XML: екранування і без керівних символів, заборонених у XML 1.0
+static QString xmlText(const QString &text) {
+    QString clean;
+    clean.reserve(text.size());
+    for (QChar ch : text) {
+        if (ch.unicode() >= 0x20 || ch == '\t' || ch == '\n' || ch == '\r') {
+            clean.append(ch);
+        }
+    }
+    return clean.toHtmlEscaped();
+}
+
+static QString columnLetters(int column) {
+    QString letters;
+    for (int n = column + 1; n > 0; n = (n - 1) / 26) {
+        letters.prepend(QChar('A' + (n - 1) % 26));
+    }
+    return letters;
+}
+
+/**
+ * @brief Потоковий запис ZIP: заголовок запису дописується після даних (файл seekable)
+ */
+struct TableExport::Zip {
+    struct Entry {
+        QByteArray name;
+        quint16 method = 0;          // 0 — stored, 8 — deflate
+        quint32 crc = 0;
+        quint32 compressedSize = 0;
+        quint32 size = 0;
+        quint32 offset = 0;
+    };
+
+    explicit Zip(QIODevice *out) : out(out) {
+        const QDateTime now = QDateTime::currentDateTime();
+        dosTime = quint16((now.time().hour() << 11) | (now.time().minute() << 5) | (now.time().second() / 2));
+        dosDate = quint16(((now.date().year() - 1980) << 9) | (now.date().month() << 5) | now.date().day());
+    }
+
+    ~Zip() {
+#ifdef SHADOWFAX_HAVE_ZLIB
+        if (deflating) {
+            deflateEnd(&stream);
+        }
+#endif
+    }
+
+    void localHeader(QByteArray &header, const Entry &entry) const {
+        putLE32(header, 0x04034b50);
+        putLE16(header, 20);             // Версія для розпакування
+        putLE16(header, 0x0800);         // Імена в UTF-8
+        putLE16(header, entry.method);
+        putLE16(header, dosTime);
+        putLE16(header, dosDate);
+        putLE32(header, entry.crc);
+        putLE32(header, entry.compressedSize);
+        putLE32(header, entry.size);
+        putLE16(header, quint16(entry.name.size()));
+        putLE16(header, 0);
+        header.append(entry.name);
+    }
+
+    void begin(const QByteArray &name, bool compress) {
+        current = Entry();
+        current.name = name;
+        current.offset = quint32(out->pos());
+#ifdef SHADOWFAX_HAVE_ZLIB
+        if (compress) {
+            stream = z_stream();
+            deflating = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            current.method = deflating ? 8 : 0;
+        }
+#else
+        Q_UNUSED(compress);
+#endif
+        QByteArray header;
+        localHeader(header, current);    // CRC і розміри поки нульові
+        out->write(header);
+    }
+
+    void write(const QByteArray &data) {
+        current.crc = crc32Update(current.crc, data);
+        current.size += quint32(data.size());
+#ifdef SHADOWFAX_HAVE_ZLIB
+        if (deflating) {
+            stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+            stream.avail_in = uInt(data.size());
+            pump(Z_NO_FLUSH);
+            return;
+        }
+#endif
+        out->write(data);
+        current.compressedSize += quint32(data.size());
+    }
+
+#ifdef SHADOWFAX_HAVE_ZLIB
+    void pump(int flush) {
+        char buffer[16 * 1024];
+        int status = Z_OK;
+        do {
+            stream.next_out = reinterpret_cast<Bytef *>(buffer);
+            stream.avail_out = sizeof(buffer);
+            status = deflate(&stream, flush);
+            const qint64 produced = qint64(sizeof(buffer)) - stream.avail_out;
+            out->write(buffer, produced);
+            current.compressedSize += quint32(produced);
+        } while (stream.avail_out == 0 || (flush == Z_FINISH && status == Z_OK));
+    }
+#endif
+
+    void end() {
+#ifdef SHADOWFAX_HAVE_ZLIB
+        if (deflating) {
+            pump(Z_FINISH);
+            deflateEnd(&stream);
+            deflating = false;
+        }
+#endif
+        const qint64 position = out->pos();
+        QByteArray header;
+        localHeader(header, current);
+        out->seek(current.offset);
+        out->write(header);
+        out->seek(position);
+        entries.append(current);
+    }
+
+    void add(const QByteArray &name, const QByteArray &data) {
+        begin(name, false);
+        write(data);
+        end();
+    }
+
+    void finish() {
+        const quint32 directoryOffset = quint32(out->pos());
+        QByteArray directory;
+        for (const Entry &entry : entries) {
+            putLE32(directory, 0x02014b50);
+            putLE16(directory, 20);      // Створено
+            putLE16(directory, 20);      // Потрібно для розпакування
+            putLE16(directory, 0x0800);
+            putLE16(directory, entry.method);
+            putLE16(directory, dosTime);
+            putLE16(directory, dosDate);
+            putLE32(directory, entry.crc);
+            putLE32(directory, entry.compressedSize);
+            putLE32(directory, entry.size);
+            putLE16(directory, quint16(entry.name.size()));
+            putLE16(directory, 0);       // extra
+            putLE16(directory, 0);       // коментар
+            putLE16(directory, 0);       // диск
+            putLE16(directory, 0);       // внутрішні атрибути
+            putLE32(directory, 0);       // зовнішні атрибути
+            putLE32(directory, entry.offset);
+            directory.append(entry.name);
+        }
+
+        // 🔹 Кінцевий запис центрального каталогу
+        const quint32 directorySize = quint32(directory.size());
+        putLE32(directory, 0x06054b50);
+        putLE16(directory, 0);
+        putLE16(directory, 0);
+        putLE16(directory, quint16(entries.size()));
+        putLE16(directory, quint16(entries.size()));
+        putLE32(directory, directorySize);
+        putLE32(directory, directoryOffset);
+        putLE16(directory, 0);
+        out->write(directory);
+    }
+
+    QIODevice *out;
+    QList<Entry> entries;
+    Entry current;
+    quint16 dosTime = 0;
+    quint16 dosDate = 0;
+#ifdef SHADOWFAX_HAVE_ZLIB
+    z_stream stream;
+    bool deflating = false;
+#endif
+};
+
+TableExport::TableExport(Format format, const QString &sheetName)
+    : m_format(format), m_sheetName(sheetName) {}
+
+TableExport::~TableExport() = default;
+
+bool TableExport::formatFromName(const QString &name, Format *format) {
+    if (name.compare("csv", Qt::CaseInsensitive) == 0) {
+        *format = Format::Csv;
+        return true;
+    }
+    if (name.compare("xlsx", Qt::CaseInsensitive) == 0) {
+        *format = Format::Xlsx;
+        return true;
+    }
+    return false;
+}
+
+bool TableExport::open(const QStringList &header) {
+    m_file = std::make_unique<QTemporaryFile>(QDir::tempPath() + "/shadowfax_export_XXXXXX");
+    if (!m_file->open()) {
+        m_error = m_file->errorString();
+        m_file.reset();
+        return false;
+    }
+
+    QVariantList headerCells;
+    for (const QString &title : header) {
+        headerCells.append(title);
+    }
+
+    if (m_format == Format::Csv) {
+        m_file->write("\xEF\xBB\xBF");   // BOM: інакше Excel не впізнає UTF-8
+        writeCsvRow(headerCells);
+        return true;
+    }
+
+    // Назва аркуша: до 31 символу, без []:*?/\ .
+    QString sheet = m_sheetName;
+    static const QString forbidden = "[]:*?/\\";
+    for (QChar &ch : sheet) {
+        if (forbidden.contains(ch)) {
+            ch = '_';
+        }
+    }
+    sheet = sheet.left(31);
+
+    m_zip = std::make_unique<Zip>(m_file.get());
+    m_zip->add("[Content_Types].xml", kContentTypes);
+    m_zip->add("_rels/.rels", kRootRels);
+    m_zip->add("xl/workbook.xml", QString::fromUtf8(kWorkbook).arg(xmlText(sheet)).toUtf8());
+    m_zip->add("xl/_rels/workbook.xml.rels", kWorkbookRels);
+    m_zip->begin("xl/worksheets/sheet1.xml", true);
+    m_zip->write(kSheetHead);
+    writeXlsxRow(headerCells, 1);
+    return true;
+}
+
+void TableExport::addRow(const QVariantList &cells) {
+    if (!m_file) {
+        return;
+    }
+    if (m_format == Format::Csv) {
+        writeCsvRow(cells);
+    } else {
+        writeXlsxRow(cells, m_rows + 2);   // Рядок 1 — заголовок
+    }
+    ++m_rows;
+}
+
+void TableExport::writeCsvRow(const QVariantList &cells) {
+    QString line;
+    for (int i = 0; i < cells.size(); ++i) {
+        if (i > 0) {
+            line += kCsvSeparator;
+        }
+        QString value = cells[i].toString();
+        if (value.contains(kCsvSeparator) || value.contains('"') || value.contains('\n') || value.contains('\r')) {
+            value = '"' + value.replace("\"", "\"\"") + '"';
+        }
+        line += value;
+    }
+    line += "\r\n";
+    m_file->write(line.toUtf8());
+}
+
+void TableExport::writeXlsxRow(const QVariantList &cells, int rowNumber) {
+    QString xml = QString("<row r=\"%1\">").arg(rowNumber);
+    for (int i = 0; i < cells.size(); ++i) {
+        const QVariant &cell = cells[i];
+        const QString ref = columnLetters(i) + QString::number(rowNumber);
+        const int type = cell.typeId();
+        if (type == QMetaType::Int || type == QMetaType::LongLong || type == QMetaType::Double) {
+            xml += QString("<c r=\"%1\"><v>%2</v></c>").arg(ref, cell.toString());
+        } else {
+            xml += QString("<c r=\"%1\" t=\"inlineStr\"><is><t xml:space=\"preserve\">%2</t></is></c>")
+                       .arg(ref, xmlText(cell.toString()));
+        }
+    }
+    xml += "</row>";
+    m_zip->write(xml.toUtf8());
+}
+
+bool TableExport::finish() {
+    if (!m_file) {
+        return false;
+    }
+
+    if (m_format == Format::Xlsx) {
+        m_zip->write(kSheetTail);
+        m_zip->end();
+        m_zip->finish();
+        m_zip.reset();
+    }
+
+    if (m_file->error() != QFileDevice::NoError || !m_file->flush()) {
+        m_error = m_file->errorString();
+        return false;
+    }
+    return m_file->seek(0);
+}
+
+QTemporaryFile *TableExport::takeDevice() {
+    return m_file.release();
+}
+
+qint64 TableExport::size() const {
+    return m_file ? m_file->size() : 0;
+}
+
+QString TableExport::fileName(const QString &baseName) const {
+    return baseName + (m_format == Format::Csv ? ".csv" : ".xlsx");
+}
+
+QString TableExport::mimeType() const {
+    return m_format == Format::Csv ? "text/csv"
+                                   : "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet";
+}
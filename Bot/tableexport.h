@@ -0,0 +1,54 @@
+#ifndef TABLEEXPORT_H
+#define TABLEEXPORT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QTemporaryFile>
+#include <memory>
+
+/**
+ * @brief Таблиця у файл CSV або XLSX, що пишеться рядок за рядком.
+ *
+ * Рядки одразу йдуть у тимчасовий файл — у пам'яті лише поточний рядок.
+ * XLSX — мінімальний пакет OOXML (workbook + один аркуш з inline-рядками)
+ * у ZIP, що пишеться потоково; аркуш стискається deflate, якщо є zlib.
+ * Готовий файл віддається як QIODevice для QHttpMultiPart (sendDocument).
+ */
+class TableExport {
+public:
+    enum class Format { Csv, Xlsx };
+
+    TableExport(Format format, const QString &sheetName);
+    ~TableExport();
+
+    bool open(const QStringList &header);
+    void addRow(const QVariantList &cells);   // Числа — числовими клітинками XLSX, решта — текстом
+    bool finish();
+
+    // Після finish(): файл перемотано на початок, власність переходить до викликача
+    QTemporaryFile *takeDevice();
+
+    QString fileName(const QString &baseName) const;
+    QString mimeType() const;
+    int rowCount() const { return m_rows; }
+    qint64 size() const;
+    QString errorString() const { return m_error; }
+
+    static bool formatFromName(const QString &name, Format *format);
+
+private:
+    struct Zip;
+
+    void writeCsvRow(const QVariantList &cells);
+    void writeXlsxRow(const QVariantList &cells, int rowNumber);
+
+    Format m_format;
+    QString m_sheetName;
+    std::unique_ptr<QTemporaryFile> m_file;
+    std::unique_ptr<Zip> m_zip;
+    int m_rows = 0;
+    QString m_error;
+};
+
+#endif // TABLEEXPORT_H
@@ -0,0 +1,96 @@
+#include "telegramapi.h"
+#include "config.h"
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QHttpMultiPart>
+#include <QJsonDocument>
+#include <QDebug>
+
+TelegramApi::TelegramApi(QNetworkAccessManager *networkManager, QObject *parent)
+    : QObject(parent), networkManager(networkManager) {}
+
+/**
+ * @brief Викликає метод Telegram Bot API
+ * @param method Назва методу (sendMessage, editMessageText, ...)
+ * @param payload JSON-параметри методу
+ * @param callback Викликається з розібраним результатом (може бути порожнім)
+ */
+void TelegramApi::call(const QString &method, const QJsonObject &payload, Callback callback) {
+    QUrl url(QString("%1/bot%2/%3").arg(Config::current().telegramApiUrl, botToken, method));
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+    QNetworkReply *reply = networkManager->post(request, QJsonDocument(payload).toJson(QJsonDocument::Compact));
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, method, callback]() {
+        onReply(reply, method, callback);
+    });
+}
+
+/**
+ * @brief Викликає метод з файлом (sendDocument, ...) як multipart/form-data
+ * @param payload Звичайні параметри методу (chat_id, caption, parse_mode, ...)
+ * @param field Назва поля з файлом ("document")
+ * @param device Відкритий для читання пристрій; читається частинами під час завантаження,
+ *        не копіюється в пам'ять і не видаляється — має жити до колбека
+ */
+void TelegramApi::upload(const QString &method, const QJsonObject &payload, const QString &field, const QString &fileName,
+                         QIODevice *device, const QString &mimeType, Callback callback) {
+    QUrl url(QString("%1/bot%2/%3").arg(Config::current().telegramApiUrl, botToken, method));
+
+    QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+
+    for (auto it = payload.begin(); it != payload.end(); ++it) {
+        QHttpPart part;
+        part.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant(QString("form-data; name=\"%1\"").arg(it.key())));
+        // 🔹 Числа (chat_id) — цілими, без експоненти double
+        part.setBody(it.value().isString() ? it.value().toString().toUtf8()
+                                           : QByteArray::number(it.value().toInteger()));
+        multiPart->append(part);
+    }
+
+    QHttpPart filePart;
+    filePart.setHeader(QNetworkRequest::ContentDispositionHeader,
+                       QVariant(QString("form-data; name=\"%1\"; filename=\"%2\"").arg(field, fileName)));
+    filePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(mimeType));
+    filePart.setBodyDevice(device);
+    multiPart->append(filePart);
+
+    QNetworkReply *reply = networkManager->post(QNetworkRequest(url), multiPart);
+    multiPart->setParent(reply);  // Видаляється разом з відповіддю
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, method, callback]() {
+        onReply(reply, method, callback);
+    });
+}
+
+/**
+ * @brief Розбирає відповідь Telegram у TelegramResult і передає колбеку
+ */
+void TelegramApi::onReply(QNetworkReply *reply, const QString &method, const Callback &callback) {
+    reply->deleteLater();
+
+    TelegramResult result;
+    QJsonObject jsonObj = QJsonDocument::fromJson(reply->readAll()).object();
+
+    if (jsonObj.isEmpty()) {
+        // 🔹 Немає тіла — мережева помилка
+        result.errorCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        result.description = reply->errorString();
+    } else {
+        result.ok = jsonObj["ok"].toBool();
+        result.result = jsonObj["result"];
+        result.errorCode = jsonObj["error_code"].toInt();
+        result.description = jsonObj["description"].toString();
+        result.retryAfter = jsonObj["parameters"].toObject()["retry_after"].toInt();
+    }
+
+    if (!result.ok) {
+        qWarning() << "❌ Telegram" << method << "повернув помилку:" << result.errorCode << result.description;
+    }
+
+    if (callback) {
+        callback(result);
+    }
+}
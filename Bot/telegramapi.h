@@ -0,0 +1,47 @@
+#ifndef TELEGRAMAPI_H
+#define TELEGRAMAPI_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <functional>
+
+class QIODevice;
+class QNetworkReply;
+
+// 🔹 Результат виклику методу Telegram Bot API
+struct TelegramResult {
+    bool ok = false;
+    QJsonValue result;       // Поле "result" відповіді
+    int errorCode = 0;       // HTTP-подібний код помилки Telegram (403, 429, ...)
+    int retryAfter = 0;      // Секунди очікування при 429 Too Many Requests
+    QString description;
+};
+
+/**
+ * @brief Тонка обгортка над Telegram Bot API з колбеком на результат
+ */
+class TelegramApi : public QObject {
+    Q_OBJECT
+public:
+    using Callback = std::function<void(const TelegramResult &)>;
+
+    explicit TelegramApi(QNetworkAccessManager *networkManager, QObject *parent = nullptr);
+
+    void setToken(const QString &token) { botToken = token; }
+
+    // POST <api_url>/bot<token>/<method> з JSON-тілом
+    void call(const QString &method, const QJsonObject &payload, Callback callback = nullptr);
+    // Той самий виклик як multipart/form-data: поля payload + файл із пристрою (пристрій лишається у викликача)
+    void upload(const QString &method, const QJsonObject &payload, const QString &field, const QString &fileName,
+                QIODevice *device, const QString &mimeType, Callback callback = nullptr);
+
+private:
+    void onReply(QNetworkReply *reply, const QString &method, const Callback &callback);
+
+    QNetworkAccessManager *networkManager;
+    QString botToken;
+};
+
+#endif // TELEGRAMAPI_H
@@ -0,0 +1,116 @@
+#include "trafficrecorder.h"
+#include <QJsonDocument>
+#include <QDebug>
+#include <cstring>
+
+static const char kMagic[] = "SFXTRACE";
+
+TrafficRecorder::TrafficRecorder(const QString &path) : file(path) {
+    bool fresh = !file.exists() || file.size() == 0;
+    if (!file.open(QIODevice::Append)) {
+        qWarning() << "❌ Не вдалося відкрити файл запису трафіку:" << path << file.errorString();
+        return;
+    }
+
+    out.setDevice(&file);
+    out.setVersion(QDataStream::Qt_6_5);
+    if (fresh) {
+        out.writeRawData(kMagic, 8);
+        out << kVersion;
+    }
+    sinceStart.start();
+    qInfo() << "⏺ Запис трафіку у" << path;
+}
+
+void TrafficRecorder::recordUpdate(const QJsonObject &update) {
+    TrafficRecord record;
+    record.kind = TrafficRecord::Kind::Update;
+    record.update = QJsonDocument(update).toJson(QJsonDocument::Compact);
+    write(record);
+}
+
+void TrafficRecorder::recordPalantir(const QString &key, int httpStatus, qint64 durationMs, const QByteArray &body) {
+    TrafficRecord record;
+    record.kind = TrafficRecord::Kind::Palantir;
+    record.key = key;
+    record.httpStatus = httpStatus;
+    record.durationMs = qint32(durationMs);
+    record.body = body;
+    write(record);
+}
+
+void TrafficRecorder::write(const TrafficRecord &record) {
+    if (!file.isOpen()) {
+        return;
+    }
+
+    out << quint8(record.kind) << sinceStart.elapsed();
+    if (record.kind == TrafficRecord::Kind::Update) {
+        out << qCompress(record.update);
+    } else {
+        out << record.key << record.httpStatus << record.durationMs << qCompress(record.body);
+    }
+    file.flush();
+}
+
+/**
+ * @brief Читає весь журнал трафіку
+ * @return false, якщо файл відсутній або має інший формат
+ */
+bool TrafficRecorder::readAll(const QString &path, QList<TrafficRecord> &records, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    char magic[8];
+    quint32 version = 0;
+    if (in.readRawData(magic, 8) != 8 || memcmp(magic, kMagic, 8) != 0) {
+        if (error) *error = "Not a Shadowfax traffic file";
+        return false;
+    }
+    in >> version;
+    if (version != kVersion) {
+        if (error) *error = QString("Unsupported traffic file version %1").arg(version);
+        return false;
+    }
+
+    // 🔹 Дозапис новим процесом починає шкалу з нуля — склеюємо сесії
+    qint64 sessionOffset = 0;
+    qint64 lastAtMs = 0;
+
+    while (!in.atEnd()) {
+        TrafficRecord record;
+        quint8 kind = 0;
+        QByteArray packed;
+        in >> kind >> record.atMs;
+        record.kind = TrafficRecord::Kind(kind);
+
+        if (record.kind == TrafficRecord::Kind::Update) {
+            in >> packed;
+            record.update = qUncompress(packed);
+        } else if (record.kind == TrafficRecord::Kind::Palantir) {
+            in >> record.key >> record.httpStatus >> record.durationMs >> packed;
+            record.body = qUncompress(packed);
+        } else {
+            if (error) *error = QString("Unknown record kind %1").arg(kind);
+            return false;
+        }
+
+        if (in.status() != QDataStream::Ok) {
+            break;  // Обірваний останній запис (процес зупинили під час запису)
+        }
+
+        if (record.atMs + sessionOffset < lastAtMs) {
+            sessionOffset = lastAtMs;
+        }
+        record.atMs += sessionOffset;
+        lastAtMs = record.atMs;
+        records.append(record);
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef TRAFFICRECORDER_H
+#define TRAFFICRECORDER_H
+
+#include <QFile>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+
+// 🔹 Один запис журналу трафіку
+struct TrafficRecord {
+    enum class Kind : quint8 { Update = 1, Palantir = 2 };
+
+    Kind kind = Kind::Update;
+    qint64 atMs = 0;          // Від початку запису
+    QByteArray update;        // Update: JSON оновлення Telegram (compact)
+    QString key;              // Palantir: "endpoint?query"
+    qint32 httpStatus = 0;    // Palantir: 0 — відповіді не було (дедлайн, обрив)
+    qint32 durationMs = 0;    // Palantir: час від запиту до відповіді
+    QByteArray body;          // Palantir: розпаковане тіло
+};
+
+/**
+ * @brief Запис вхідних оновлень і обміну з Palantír у компактний
+ *        append-only файл для відтворення (replay).
+ *
+ * Формат: заголовок "SFXTRACE" + версія, далі записи QDataStream;
+ * тіла стискаються qCompress. Кожен запис одразу скидається на диск.
+ */
+class TrafficRecorder {
+public:
+    static constexpr quint32 kVersion = 1;
+
+    explicit TrafficRecorder(const QString &path);
+
+    bool isOpen() const { return file.isOpen(); }
+    void recordUpdate(const QJsonObject &update);
+    void recordPalantir(const QString &key, int httpStatus, qint64 durationMs, const QByteArray &body);
+
+    static bool readAll(const QString &path, QList<TrafficRecord> &records, QString *error = nullptr);
+
+private:
+    void write(const TrafficRecord &record);
+
+    QFile file;
+    QDataStream out;
+    QElapsedTimer sinceStart;
+};
+
+#endif // TRAFFICRECORDER_H
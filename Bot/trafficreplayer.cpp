@@ -0,0 +1,118 @@
+#include "trafficreplayer.h"
+#include "replaynetworkmanager.h"
+#include "alloccounter.h"
+#include "bot.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+
+TrafficReplayer::TrafficReplayer(Bot *bot, ReplayNetworkManager *network, QObject *parent)
+    : QObject(parent), bot(bot), network(network) {
+    quietTimer.setInterval(100);
+    connect(&quietTimer, &QTimer::timeout, this, &TrafficReplayer::waitForQuiet);
+
+    // 🔹 Затримка відповіді: від подачі оновлення до першого виклику Telegram у тому ж чаті
+    connect(network, &ReplayNetworkManager::telegramRequest, this, [this](const QString &, qint64 chatId) {
+        ++telegramCalls;
+        auto it = awaitingReply.find(chatId);
+        if (it != awaitingReply.end() && !it->isEmpty()) {
+            latenciesMs.append(wallClock.elapsed() - it->dequeue());
+        }
+    });
+}
+
+bool TrafficReplayer::load(const QString &path) {
+    QList<TrafficRecord> records;
+    QString error;
+    if (!TrafficRecorder::readAll(path, records, &error)) {
+        qCritical() << "❌ Не вдалося прочитати запис трафіку" << path << ":" << error;
+        return false;
+    }
+
+    QSet<qint64> users;
+    for (const TrafficRecord &record : records) {
+        if (record.kind == TrafficRecord::Kind::Update) {
+            updates.append(record);
+            QJsonObject update = QJsonDocument::fromJson(record.update).object();
+            QJsonObject source = update.contains("callback_query") ? update["callback_query"].toObject()
+                                 : update.contains("message") ? update["message"].toObject()
+                                                              : update["edited_message"].toObject();
+            users.insert(source["from"].toObject()["id"].toVariant().toLongLong());
+        } else {
+            network->addExchange(record);
+        }
+    }
+
+    // 🔹 Записані користувачі мали доступ — не впираємось у локальні users.txt
+    bot->allowUsers(users);
+
+    qInfo() << "⏯ Завантажено" << updates.size() << "оновлень і" << records.size() - updates.size()
+            << "відповідей Palantír з" << path;
+    return true;
+}
+
+void TrafficReplayer::start(double factor) {
+    speed = factor;
+    network->setSpeed(speed);
+    allocationsAtStart = AllocCounter::allocations();
+    wallClock.start();
+    injectNext();
+}
+
+void TrafficReplayer::injectNext() {
+    if (nextUpdate >= updates.size()) {
+        quietTimer.start();
+        return;
+    }
+
+    const TrafficRecord &record = updates.at(nextUpdate++);
+    QJsonObject update = QJsonDocument::fromJson(record.update).object();
+
+    QJsonObject message = update.contains("callback_query")
+        ? update["callback_query"].toObject()["message"].toObject()
+        : update.contains("message") ? update["message"].toObject() : update["edited_message"].toObject();
+    qint64 chatId = message["chat"].toObject()["id"].toVariant().toLongLong();
+    awaitingReply[chatId].enqueue(wallClock.elapsed());
+
+    bot->processUpdate(update);
+
+    if (nextUpdate >= updates.size()) {
+        quietTimer.start();
+        return;
+    }
+
+    // 🔹 Пауза до наступного оновлення за записаною шкалою часу
+    qint64 gap = updates.at(nextUpdate).atMs - updates.at(0).atMs;
+    qint64 dueMs = speed > 0 ? qint64(gap / speed) : 0;
+    QTimer::singleShot(int(qMax<qint64>(0, dueMs - wallClock.elapsed())), this, &TrafficReplayer::injectNext);
+}
+
+/**
+ * @brief Чекає, доки двійник мережі не віддасть усі відповіді
+ */
+void TrafficReplayer::waitForQuiet() {
+    if (network->pendingReplies() > 0) {
+        return;
+    }
+    quietTimer.stop();
+    report();
+    emit finished();
+}
+
+void TrafficReplayer::report() {
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+    auto percentile = [this](int p) -> qint64 {
+        return latenciesMs.isEmpty() ? 0 : latenciesMs.at(qMin(latenciesMs.size() - 1, latenciesMs.size() * p / 100));
+    };
+
+    qInfo() << "⏯ Replay завершено за" << wallClock.elapsed() << "мс (швидкість" << speed << "x)";
+    qInfo() << "   оновлень:" << updates.size() << ", викликів Telegram:" << telegramCalls
+            << ", відповідей Palantír:" << network->palantirServed() << ", без запису:" << network->palantirMissed();
+    qInfo() << "   затримка відповіді, мс: p50 =" << percentile(50) << "p95 =" << percentile(95)
+            << "max =" << (latenciesMs.isEmpty() ? 0 : latenciesMs.last());
+    if (AllocCounter::isEnabled()) {
+        qInfo() << "   алокацій:" << AllocCounter::allocations() - allocationsAtStart;
+    }
+}
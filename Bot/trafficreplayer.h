@@ -0,0 +1,50 @@
+#ifndef TRAFFICREPLAYER_H
+#define TRAFFICREPLAYER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include "trafficrecorder.h"
+
+class Bot;
+class ReplayNetworkManager;
+
+/**
+ * @brief Відтворює записані оновлення через Bot у реальному або прискореному часі
+ *        і звітує про затримку відповіді та кількість алокацій.
+ */
+class TrafficReplayer : public QObject {
+    Q_OBJECT
+public:
+    TrafficReplayer(Bot *bot, ReplayNetworkManager *network, QObject *parent = nullptr);
+
+    // Завантажує журнал і передає записані відповіді Palantír у двійник мережі
+    bool load(const QString &path);
+    void start(double speed);   // 1 — реальний час, 10 — вдесятеро швидше, 0 — без пауз
+
+signals:
+    void finished();
+
+private:
+    void injectNext();
+    void waitForQuiet();
+    void report();
+
+    Bot *bot;
+    ReplayNetworkManager *network;
+    QList<TrafficRecord> updates;
+    int nextUpdate = 0;
+    double speed = 1.0;
+
+    QElapsedTimer wallClock;
+    QTimer quietTimer;
+    QHash<qint64, QQueue<qint64>> awaitingReply;  // chat_id -> моменти подачі оновлень без відповіді
+    QList<qint64> latenciesMs;
+    quint64 telegramCalls = 0;
+    quint64 allocationsAtStart = 0;
+};
+
+#endif // TRAFFICREPLAYER_H
@@ -0,0 +1,172 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <QNetworkAccessManager>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <memory>
+#include "Bot/config.h"
+#include "Bot/palantirgateway.h"
+#include "Bot/palantirclient.h"
+#include "Bot/localsocketnetworkmanager.h"
+#include "palantirstub.h"
+#include "benchreport.h"
+
+/**
+ * @brief Наскрізні виміри запитів до Palantír через PalantirClient і шлюз на локальному PalantirStub.
+ *
+ * Заглушка працює в тому ж процесі на вільному порту loopback і водночас на
+ * Unix domain socket, тож transport порівнює обидва транспорти на однакових
+ * запитах. Конфігурація бенчмарку пишеться в config/config.ini поруч із
+ * виконуваним файлом і перечитується перед кожним рядком даних.
+ */
+class BackendBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void terminalLookups_data();
+    void terminalLookups();
+
+    void transport_data();
+    void transport();
+
+private:
+    void configure(const QString &sections, const QString &palantir = QString());
+    bool lookupAll(qint64 clientId, int count);
+
+    PalantirStub stub;
+    QString socketName;
+    std::unique_ptr<LocalSocketNetworkManager> network;
+    std::unique_ptr<PalantirGateway> gateway;
+    std::unique_ptr<PalantirClient> client;
+};
+
+void BackendBenchmark::initTestCase() {
+    stub.setFleetSize(2, 200);
+    QVERIFY(stub.listen(0));
+    socketName = QString("shadowfax-bench-%1").arg(QCoreApplication::applicationPid());
+    QVERIFY(stub.listenLocal(socketName));
+    configure(QString());
+
+    network = std::make_unique<LocalSocketNetworkManager>();
+    gateway = std::make_unique<PalantirGateway>(network.get());
+    client = std::make_unique<PalantirClient>(gateway.get());
+}
+
+void BackendBenchmark::cleanupTestCase() {
+    client.reset();
+    gateway.reset();
+    network.reset();
+}
+
+/**
+ * @brief Публікує новий знімок конфігурації: адреса заглушки (+ ключі [Palantir]) і додаткові секції
+ */
+void BackendBenchmark::configure(const QString &sections, const QString &palantir) {
+    QDir().mkpath(QFileInfo(Config::configPath()).path());
+    QFile file(Config::configPath());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qFatal("Cannot write %s", qPrintable(Config::configPath()));
+    }
+    file.write(QString("[Authorization]\nuse_auth=false\n\n[Palantir]\nbase_url=http://127.0.0.1:%1\n%2\n%3")
+                   .arg(stub.serverPort()).arg(palantir, sections).toUtf8());
+    file.close();
+    Config::instance().loadConfig();
+}
+
+/**
+ * @brief terminal_info для count різних терміналів клієнта одночасно, як на початку зміни
+ * @return true, якщо всі відповіді успішні
+ */
+bool BackendBenchmark::lookupAll(qint64 clientId, int count) {
+    QList<QFuture<PalantirClient::TerminalResult>> futures;
+    futures.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        futures.append(client->terminal(clientId, 101 + i));
+    }
+
+    auto all = QtFuture::whenAll(futures.begin(), futures.end());
+    if (!QTest::qWaitFor([&all]() { return all.isFinished(); }, 30000)) {
+        return false;
+    }
+    for (const QFuture<PalantirClient::TerminalResult> &future : std::as_const(futures)) {
+        if (!future.result().ok()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BackendBenchmark::terminalLookups_data() {
+    QTest::addColumn<QString>("batching");
+    QTest::addColumn<int>("count");
+
+    const QString individual = "[Batching]\nwindow_ms=0\n";
+    const QString pipelined = "[Batching]\nwindow_ms=5\nbulk=false\n";
+    const QString bulk = "[Batching]\nwindow_ms=5\nbulk=true\n";
+    for (int count : { 10, 50 }) {
+        QTest::addRow("individual/%d", count) << individual << count;
+        QTest::addRow("pipelined/%d", count) << pipelined << count;
+        QTest::addRow("bulk/%d", count) << bulk << count;
+    }
+}
+
+void BackendBenchmark::terminalLookups() {
+    QFETCH(QString, batching);
+    QFETCH(int, count);
+    configure(batching);
+
+    bool ok = true;
+    QBENCHMARK {
+        ok = lookupAll(1, count) && ok;
+    }
+    QVERIFY(ok);
+}
+
+/**
+ * @brief Loopback TCP проти Unix domain socket: послідовні запити (затримка одного
+ *        обміну) і 50 одночасних без пакетування (пул з'єднань і конвеєр)
+ */
+void BackendBenchmark::transport_data() {
+    QTest::addColumn<QString>("palantir");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("rounds");
+
+    const QString tcp;
+    const QString local = QString("socket=%1\nsocket_connections=4\nsocket_pipeline=4\n").arg(socketName);
+    QTest::addRow("tcp/serial") << tcp << 1 << 20;
+    QTest::addRow("unix/serial") << local << 1 << 20;
+    QTest::addRow("tcp/concurrent") << tcp << 50 << 1;
+    QTest::addRow("unix/concurrent") << local << 50 << 1;
+}
+
+void BackendBenchmark::transport() {
+    QFETCH(QString, palantir);
+    QFETCH(int, count);
+    QFETCH(int, rounds);
+    configure("[Batching]\nwindow_ms=0\n", palantir);
+
+    const quint64 localBefore = network->localRequests();
+    bool ok = true;
+    QBENCHMARK {
+        for (int round = 0; round < rounds; ++round) {
+            ok = lookupAll(1, count) && ok;
+        }
+    }
+    QVERIFY(ok);
+    QCOMPARE(network->localRequests() > localBefore, !palantir.isEmpty());   // Запити справді йшли обраним транспортом
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");   // Журнал шлюзу спотворив би виміри
+
+    BackendBenchmark benchmark;
+    return runBenchmarks(app, benchmark, "BackendBenchmark");
+}
+
+#include "backend_bench.moc"
@@ -0,0 +1,97 @@
+#include "benchreport.h"
+#include <QtTest>
+#include <QFile>
+#include <QDateTime>
+#include <QTemporaryFile>
+#include <QXmlStreamReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSysInfo>
+
+/**
+ * @brief XML-звіт QtTest -> JSON з результатами QBENCHMARK для порівняння комітів
+ */
+static bool writeJson(const QString &xmlPath, const QString &jsonPath, const QString &suiteName, const QString &label) {
+    QFile xml(xmlPath);
+    if (!xml.open(QIODevice::ReadOnly)) {
+        qWarning() << "❌ Не вдалося прочитати звіт QtTest:" << xmlPath;
+        return false;
+    }
+
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader reader(&xml);
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        const QXmlStreamAttributes attributes = reader.attributes();
+        if (reader.name() == QLatin1String("TestFunction")) {
+            function = attributes.value("name").toString();
+        } else if (reader.name() == QLatin1String("BenchmarkResult")) {
+            results.append(QJsonObject{
+                {"name", function},
+                {"tag", attributes.value("tag").toString()},
+                {"metric", attributes.value("metric").toString()},
+                {"value", attributes.value("value").toDouble()},
+                {"iterations", attributes.value("iterations").toInt()}
+            });
+        }
+    }
+    if (reader.hasError()) {
+        qWarning() << "❌ Некоректний звіт QtTest:" << reader.errorString();
+        return false;
+    }
+
+    const QJsonObject report{
+        {"suite", suiteName},
+        {"label", label},
+        {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"qt", QString::fromLatin1(qVersion())},
+        {"cpu", QSysInfo::currentCpuArchitecture()},
+        {"results", results}
+    };
+
+    QFile out(jsonPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "❌ Не вдалося записати" << jsonPath;
+        return false;
+    }
+    out.write(QJsonDocument(report).toJson());
+    return true;
+}
+
+static QString takeOption(QStringList &args, const QString &name) {
+    const int index = args.indexOf(name);
+    if (index < 1 || index + 1 >= args.size()) {
+        return QString();
+    }
+    const QString value = args.at(index + 1);
+    args.remove(index, 2);
+    return value;
+}
+
+int runBenchmarks(QCoreApplication &app, QObject &suite, const QString &suiteName) {
+    QStringList args = app.arguments();
+    const QString jsonPath = takeOption(args, "--json");
+    const QString label = takeOption(args, "--label");
+
+    if (jsonPath.isEmpty()) {
+        return QTest::qExec(&suite, args);
+    }
+
+    QTemporaryFile xml;
+    if (!xml.open()) {
+        qWarning() << "❌ Не вдалося створити тимчасовий файл звіту";
+        return 1;
+    }
+    xml.close();
+
+    args << "-o" << xml.fileName() + ",xml" << "-o" << "-,txt";
+    const int failed = QTest::qExec(&suite, args);
+    if (!writeJson(xml.fileName(), jsonPath, suiteName, label)) {
+        return failed ? failed : 1;
+    }
+    return failed;
+}
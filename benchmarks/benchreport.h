@@ -0,0 +1,16 @@
+#ifndef BENCHREPORT_H
+#define BENCHREPORT_H
+
+#include <QCoreApplication>
+#include <QObject>
+#include <QString>
+
+/**
+ * @brief Запускає набір QBENCHMARK з опціями QtTest і додатковими --json <файл> [--label <мітка>].
+ *
+ * З --json результати пишуться ще й у JSON (через XML-звіт QtTest) для порівняння
+ * комітів, наприклад --label $(git rev-parse --short HEAD).
+ */
+int runBenchmarks(QCoreApplication &app, QObject &suite, const QString &suiteName);
+
+#endif // BENCHREPORT_H
@@ -0,0 +1,298 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <memory>
+#include <algorithm>
+#include "Bot/bot.h"
+#include "Bot/renderers.h"
+#include "Bot/palantirtypes.h"
+#include "Bot/accesslist.h"
+#include "Bot/admissioncontroller.h"
+#include "Bot/replaynetworkmanager.h"
+#include "benchreport.h"
+
+static const qint64 kAdminId = 722142144;   // Має доступ і не підлягає лімітам допуску
+
+/**
+ * @brief Мікробенчмарки гарячих шляхів бота на фікстурах у форматі Palantír і Telegram.
+ *
+ * Бот працює на ReplayNetworkManager: виклики Telegram отримують миттєву
+ * відповідь, жоден запит не виходить за межі процесу.
+ */
+class HotPathBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void timeToFirstReply();
+    void updateParsing();
+    void processUpdate_data();
+    void processUpdate();
+    void aclChecks();
+    void admission();
+    void clientsKeyboard();
+    void renderReservoirs();
+    void renderPrk();
+    void renderRro();
+    void renderAzsList();
+
+private:
+    static QByteArray fixture(const QString &name);
+    static QJsonObject fixtureObject(const QString &name);
+    static QJsonObject messageUpdate(qint64 userId, const QString &text);
+
+    std::unique_ptr<ReplayNetworkManager> network;
+    std::unique_ptr<Bot> bot;
+    QTemporaryDir aclDir;
+    QList<qint64> aclProbe;   // Суміш адмінів, користувачів, заблокованих і невідомих
+};
+
+QByteArray HotPathBenchmark::fixture(const QString &name) {
+    QFile file(":/fixtures/" + name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qFatal("Fixture %s is missing", qPrintable(name));
+    }
+    return file.readAll();
+}
+
+QJsonObject HotPathBenchmark::fixtureObject(const QString &name) {
+    return QJsonDocument::fromJson(fixture(name)).object();
+}
+
+QJsonObject HotPathBenchmark::messageUpdate(qint64 userId, const QString &text) {
+    const QJsonObject from{{"id", userId}, {"first_name", "Олена"}, {"last_name", "Коваль"}, {"username", "okoval"}};
+    const QJsonObject chat{{"id", userId}, {"type", "private"}};
+    return QJsonObject{
+        {"update_id", 1},
+        {"message", QJsonObject{{"message_id", 1}, {"from", from}, {"chat", chat}, {"text", text}}}
+    };
+}
+
+void HotPathBenchmark::initTestCase() {
+    // 🔹 Списки доступу бота: адміністратор фікстур не впирається в ліміти допуску
+    const QString configDir = QCoreApplication::applicationDirPath() + "/Config";
+    QDir().mkpath(configDir);
+    QFile admins(configDir + "/admins.txt");
+    QVERIFY(admins.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    admins.write(QByteArray::number(kAdminId) + "\n");
+    admins.close();
+
+    network = std::make_unique<ReplayNetworkManager>(QUrl(Config::current().palantirBaseUrl));
+    network->setSpeed(0);
+    bot = std::make_unique<Bot>(network.get());
+
+    // 🔹 Окремі списки для aclChecks: 5000 користувачів, 200 заблокованих
+    QVERIFY(aclDir.isValid());
+    QFile users(aclDir.filePath("users.txt"));
+    QFile blacklist(aclDir.filePath("blacklist.txt"));
+    QVERIFY(users.open(QIODevice::WriteOnly) && blacklist.open(QIODevice::WriteOnly));
+    for (int i = 0; i < 5000; ++i) {
+        users.write(QByteArray::number(500000000 + i) + " #user\n");
+    }
+    for (int i = 0; i < 200; ++i) {
+        blacklist.write(QByteArray::number(600000000 + i) + "\n");
+    }
+    users.close();
+    blacklist.close();
+    QFile aclAdmins(aclDir.filePath("admins.txt"));
+    QVERIFY(aclAdmins.open(QIODevice::WriteOnly));
+    aclAdmins.write(QByteArray::number(kAdminId) + "\n");
+    aclAdmins.close();
+
+    for (int i = 0; i < 100; ++i) {
+        switch (i % 4) {
+        case 0: aclProbe.append(500000000 + i * 37); break;   // Користувач
+        case 1: aclProbe.append(600000000 + i); break;         // Заблокований
+        case 2: aclProbe.append(700000000 + i); break;         // Невідомий
+        default: aclProbe.append(kAdminId); break;
+        }
+    }
+}
+
+void HotPathBenchmark::cleanupTestCase() {
+    bot.reset();
+    network.reset();
+}
+
+/**
+ * @brief Time-to-first-reply: від створення бота і startPolling() до першого sendMessage
+ *
+ * Перше оновлення (/help від адміністратора) віддає перший же getUpdates, тож
+ * вимір охоплює конструктор, паралельний старт, long poll і обробку команди.
+ * Результат — медіана кількох запусків через setBenchmarkResult: зупинка бота
+ * (дочекатися кроків старту в пулі) до виміру не входить.
+ */
+void HotPathBenchmark::timeToFirstReply() {
+    QList<qint64> samples;
+
+    for (int round = 0; round < 7; ++round) {
+        ReplayNetworkManager startupNetwork(QUrl(Config::current().palantirBaseUrl));
+        startupNetwork.setSpeed(0);
+        startupNetwork.queueUpdate(messageUpdate(kAdminId, "/help"));
+
+        bool sent = false;
+        connect(&startupNetwork, &ReplayNetworkManager::telegramRequest, this,
+                [&sent](const QString &method, qint64 chatId) {
+            sent = sent || (method == "sendMessage" && chatId == kAdminId);
+        });
+
+        QElapsedTimer elapsed;
+        elapsed.start();
+        Bot startupBot(&startupNetwork);
+        startupBot.startPolling();
+        QVERIFY(QTest::qWaitFor([&sent]() { return sent; }, 5000));
+        samples.append(elapsed.nsecsElapsed());
+
+        // 🔹 Кроки старту в пулі повертаються в бот — він має їх дочекатися
+        startupBot.stopPolling();
+        QVERIFY(QTest::qWaitFor([]() { return QThreadPool::globalInstance()->activeThreadCount() == 0; }, 30000));
+        QCoreApplication::processEvents();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    QTest::setBenchmarkResult(qreal(samples.at(samples.size() / 2)) / 1e6, QTest::WalltimeMilliseconds);
+}
+
+/**
+ * @brief Відповідь getUpdates на 100 оновлень: Bot::parseUpdates
+ */
+void HotPathBenchmark::updateParsing() {
+    const QByteArray body = fixture("updates.json");
+    qint64 lastUpdateId = 0;
+    QList<QJsonObject> updates;
+    bool ok = true;
+
+    QBENCHMARK {
+        updates.clear();
+        ok = Bot::parseUpdates(body, updates, lastUpdateId) && ok;
+    }
+    QVERIFY(ok);
+    QVERIFY(lastUpdateId > 0);
+    QVERIFY(!updates.isEmpty());
+}
+
+void HotPathBenchmark::processUpdate_data() {
+    QTest::addColumn<QString>("text");
+    QTest::newRow("help") << "/help";
+    QTest::newRow("button") << "📜 Допомога";
+    QTest::newRow("start") << "/start";
+    QTest::newRow("subscriptions") << "/subscriptions";
+    QTest::newRow("unknown") << "/no_such_command";
+}
+
+/**
+ * @brief Оновлення від адміністратора до відповіді в чергу: допуск, processMessage і диспетчеризація
+ */
+void HotPathBenchmark::processUpdate() {
+    QFETCH(QString, text);
+    const QJsonObject update = messageUpdate(kAdminId, text);
+
+    QBENCHMARK {
+        bot->processUpdate(update);
+    }
+
+    // 🔹 Відповіді Telegram, накопичені під час вимірювання, не переносимо в наступний рядок
+    QTest::qWait(100);
+}
+
+/**
+ * @brief Перевірки доступу одного повідомлення (чорний список, адмін, користувач) для 100 ID
+ */
+void HotPathBenchmark::aclChecks() {
+    AccessList acl(aclDir.path());
+    acl.reload();
+    int allowed = 0;
+
+    QBENCHMARK {
+        for (qint64 userId : std::as_const(aclProbe)) {
+            if (!acl.isBlacklisted(userId) && (acl.isAdmin(userId) || acl.isUser(userId))) {
+                ++allowed;
+            }
+        }
+    }
+    QVERIFY(allowed > 0);
+}
+
+void HotPathBenchmark::admission() {
+    AccessList acl(aclDir.path());
+    acl.reload();
+    AdmissionController controller(acl);
+
+    QBENCHMARK {
+        for (qint64 userId : std::as_const(aclProbe)) {
+            controller.admit(userId, userId, acl.isUser(userId), 0);
+        }
+    }
+    QVERIFY(controller.counters().admitted > 0);
+}
+
+void HotPathBenchmark::clientsKeyboard() {
+    const QJsonArray clients = fixtureObject("clients.json")["data"].toArray();
+    QJsonObject keyboard;
+
+    QBENCHMARK {
+        keyboard = Renderers::clientsKeyboard(clients);
+    }
+    QCOMPARE(keyboard["keyboard"].toArray().size(), (clients.size() + 2) / 3 + 1);
+}
+
+void HotPathBenchmark::renderReservoirs() {
+    const QList<Palantir::Reservoir> reservoirs = Palantir::reservoirsFromJson(fixtureObject("reservoirs_info.json"));
+    QString text;
+
+    QBENCHMARK {
+        text = Renderers::reservoirs(reservoirs);
+    }
+    QVERIFY(!text.isEmpty());
+}
+
+void HotPathBenchmark::renderPrk() {
+    const Palantir::Terminal terminal = Palantir::terminalFromJson(fixtureObject("terminal_info.json"));
+    QString text;
+
+    QBENCHMARK {
+        text = Renderers::prk(terminal.dispensers);
+    }
+    QVERIFY(text.contains("ПРК"));
+}
+
+void HotPathBenchmark::renderRro() {
+    const QList<Palantir::PosData> posdatas = Palantir::posdatasFromJson(fixtureObject("posdatas.json"));
+    QString text;
+
+    QBENCHMARK {
+        text = Renderers::rro(posdatas);
+    }
+    QVERIFY(!text.isEmpty());
+}
+
+void HotPathBenchmark::renderAzsList() {
+    const QJsonArray azsList = fixtureObject("azs_list.json")["azs_list"].toArray();
+    QStringList parts;
+
+    QBENCHMARK {
+        parts = Renderers::azsList(azsList);
+    }
+    QVERIFY(parts.size() > 1);
+}
+
+// 🔹 Додатково до опцій QtTest: --json <файл> [--label <мітка>], див. benchreport.h
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");   // Журнал бота спотворив би виміри
+
+    HotPathBenchmark benchmark;
+    return runBenchmarks(app, benchmark, "HotPathBenchmark");
+}
+
+#include "hotpaths_bench.moc"
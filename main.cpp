@@ -1,20 +1,71 @@
 #include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <memory>
 #include "Bot/bot.h"
 #include "Bot/config.h"
+#include "Bot/trafficrecorder.h"
+#include "Bot/trafficreplayer.h"
+#include "Bot/replaynetworkmanager.h"
+#include "Bot/handoff.h"
 
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Shadowfax — Telegram-бот для мережі АЗС");
+    parser.addHelpOption();
+    parser.addOption({"record", "Записувати вхідні оновлення та обмін з Palantír у файл.", "file"});
+    parser.addOption({"replay", "Відтворити записаний трафік без Telegram і Palantír.", "file"});
+    parser.addOption({"speed", "Швидкість відтворення: 1 — реальний час, 0 — без пауз.", "factor", "1"});
+    parser.addOption({"handoff", "Забрати стан у процесу, що працює зараз, і замінити його без простою."});
+    parser.process(a);
+
     Bot::initLogging();  // 🔹 Ініціалізуємо логування
+    Config::instance().startWatching();  // 🔄 Перечитування config.ini без перезапуску
+
+    // ⏯ Відтворення записаного трафіку через in-process двійник мережі
+    if (parser.isSet("replay")) {
+        ReplayNetworkManager network(QUrl(Config::current().palantirBaseUrl));
+        Bot bot(&network);
+        TrafficReplayer replayer(&bot, &network);
+        if (!replayer.load(parser.value("replay"))) {
+            return 1;
+        }
+        QObject::connect(&replayer, &TrafficReplayer::finished, &a, &QCoreApplication::quit);
+        QTimer::singleShot(0, &replayer, [&replayer, &parser]() {
+            replayer.start(parser.value("speed").toDouble());
+        });
+        return a.exec();
+    }
 
-    // Якщо увімкнена авторизація, перевіряємо, чи є адміністратор
-    if (Config::instance().useAuth()) {
-        ensureAdminExists();
+    std::unique_ptr<TrafficRecorder> recorder;
+    if (parser.isSet("record")) {
+        recorder = std::make_unique<TrafficRecorder>(parser.value("record"));
     }
 
     Bot bot;
-    bot.startPolling();  // 🔹 Починаємо отримувати оновлення з Telegram
+    if (recorder && recorder->isOpen()) {
+        bot.setRecorder(recorder.get());
+    }
+
+    // 🔁 Оновлення без простою: offset, сесії і кеші — від попереднього процесу
+    if (parser.isSet("handoff")) {
+        HandoffClient *handoff = new HandoffClient(Config::current().handoffSocket, &a);
+        QObject::connect(handoff, &HandoffClient::stateReceived, &bot, [&bot, handoff](const QJsonObject &state) {
+            bot.restoreState(state);
+            handoff->acknowledge();
+            bot.startPolling();
+        });
+        QObject::connect(handoff, &HandoffClient::unavailable, &bot, [&bot]() {
+            bot.startPolling();
+        });
+        handoff->start(15 * 1000);
+        return a.exec();
+    }
+
+    bot.startPolling();  // 🔹 Паралельний старт і отримання оновлень з Telegram
 
     return a.exec();
 }
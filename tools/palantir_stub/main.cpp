@@ -0,0 +1,44 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "palantirstub.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("PalantirStub");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Локальна заміна Palantír для розробки Shadowfax");
+    parser.addHelpOption();
+    parser.addOption({"port", "TCP порт.", "port", "8181"});
+    parser.addOption({"socket", "Також слухати Unix domain socket (ім'я або шлях).", "name"});
+    parser.addOption({"clients", "Кількість клієнтів.", "n", "5"});
+    parser.addOption({"terminals", "Кількість терміналів на клієнта.", "n", "40"});
+    parser.addOption({"fault", "Режим збоїв: off, slow, hang, error.", "mode", "off"});
+    parser.addOption({"fault-rate", "Частка запитів зі збоєм (0..1).", "rate", "1.0"});
+    parser.addOption({"fault-delay-ms", "Затримка для режиму slow.", "ms", "8000"});
+    parser.addOption({"compression", "Стиснення відповідей за Accept-Encoding: auto, off.", "mode", "auto"});
+    parser.addOption({"compression-min-bytes", "Менші тіла не стискаються.", "bytes", "1024"});
+    parser.addOption({"batch", "Пакетний endpoint terminal_info_batch: on, off.", "mode", "on"});
+    parser.process(a);
+
+    PalantirStub stub;
+    stub.setFleetSize(parser.value("clients").toInt(), parser.value("terminals").toInt());
+
+    PalantirStub::FaultConfig fault;
+    fault.mode = PalantirStub::faultModeFromString(parser.value("fault"));
+    fault.rate = parser.value("fault-rate").toDouble();
+    fault.delayMs = parser.value("fault-delay-ms").toInt();
+    stub.setFault(fault);
+    stub.setCompression(parser.value("compression") != "off", parser.value("compression-min-bytes").toInt());
+    stub.setBatchEndpoint(parser.value("batch") != "off");
+
+    if (!stub.listen(quint16(parser.value("port").toUInt()))) {
+        return 1;
+    }
+    if (parser.isSet("socket") && !stub.listenLocal(parser.value("socket"))) {
+        return 1;
+    }
+
+    return a.exec();
+}
@@ -0,0 +1,455 @@
+#include "palantirstub.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <QDateTime>
+#include <QTimer>
+#include <QPointer>
+#include <QDebug>
+
+#ifdef SHADOWFAX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SHADOWFAX_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static const char *const kFuels[] = { "А-92", "А-95", "А-95+", "ДП", "ГАЗ" };
+static const char *const kProtocols[] = { "Gilbarco", "Tokheim", "Nara", "Shelf", "Dart" };
+static const char *const kPosModels[] = { "MINI-T 400ME", "Datecs FP-700", "ЕКСЕЛЛІО FP-2000" };
+
+PalantirStub::PalantirStub(QObject *parent) : QObject(parent) {
+    connect(&server, &QTcpServer::newConnection, this, &PalantirStub::onNewConnection);
+    connect(&localServer, &QLocalServer::newConnection, this, &PalantirStub::onNewLocalConnection);
+}
+
+bool PalantirStub::listen(quint16 port) {
+    if (!server.listen(QHostAddress::LocalHost, port)) {
+        qCritical() << "❌ Не вдалося відкрити порт" << port << ":" << server.errorString();
+        return false;
+    }
+    qInfo() << "🛰 Palantír stub слухає на порту" << server.serverPort();
+    return true;
+}
+
+bool PalantirStub::listenLocal(const QString &name) {
+    QLocalServer::removeServer(name);   // Сокет, що лишився після аварійного завершення
+    if (!localServer.listen(name)) {
+        qCritical() << "❌ Не вдалося відкрити сокет" << name << ":" << localServer.errorString();
+        return false;
+    }
+    qInfo() << "🛰 Palantír stub слухає на сокеті" << localServer.fullServerName();
+    return true;
+}
+
+void PalantirStub::setFault(const FaultConfig &newFault) {
+    fault = newFault;
+    qInfo() << "💥 Режим збоїв:" << faultModeToString(fault.mode)
+            << "rate =" << fault.rate << "delay_ms =" << fault.delayMs;
+}
+
+void PalantirStub::setFleetSize(int clients, int terminals) {
+    clientCount = clients;
+    terminalsPerClient = terminals;
+}
+
+void PalantirStub::setBatchEndpoint(bool enabled) {
+    batchEnabled = enabled;
+}
+
+void PalantirStub::setCompression(bool enabled, int minBytes) {
+    compressionEnabled = enabled;
+    compressionMinBytes = minBytes;
+}
+
+PalantirStub::FaultMode PalantirStub::faultModeFromString(const QString &name) {
+    if (name == "slow") return FaultMode::Slow;
+    if (name == "hang") return FaultMode::Hang;
+    if (name == "error") return FaultMode::Error;
+    return FaultMode::Off;
+}
+
+QString PalantirStub::faultModeToString(FaultMode mode) {
+    switch (mode) {
+    case FaultMode::Slow: return "slow";
+    case FaultMode::Hang: return "hang";
+    case FaultMode::Error: return "error";
+    case FaultMode::Off: break;
+    }
+    return "off";
+}
+
+void PalantirStub::onNewConnection() {
+    while (QTcpSocket *socket = server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            connections.remove(socket);
+            socket->deleteLater();
+        });
+        accept(socket);
+    }
+}
+
+void PalantirStub::onNewLocalConnection() {
+    while (QLocalSocket *socket = localServer.nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            connections.remove(socket);
+            socket->deleteLater();
+        });
+        accept(socket);
+    }
+}
+
+void PalantirStub::accept(QIODevice *socket) {
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() { onReadyRead(socket); });
+}
+
+void PalantirStub::onReadyRead(QIODevice *socket) {
+    Connection &connection = connections[socket];
+    QByteArray &buffer = connection.buffer;
+    buffer += socket->readAll();
+
+    // 🔹 Обробляємо всі повні запити (підтримка keep-alive та pipelining)
+    int headerEnd;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) >= 0) {
+        QByteArray head = buffer.left(headerEnd);
+        QList<QByteArray> lines = head.split('\n');
+
+        HttpRequest request;
+        QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+        if (requestLine.size() < 2) {
+            socket->close();
+            return;
+        }
+        request.method = QString::fromLatin1(requestLine[0]);
+        QUrl url(QString::fromUtf8(requestLine[1]));
+        request.path = url.path();
+        request.query = QUrlQuery(url);
+
+        for (int i = 1; i < lines.size(); ++i) {
+            int colon = lines[i].indexOf(':');
+            if (colon > 0) {
+                request.headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+            }
+        }
+
+        int bodyLength = request.headers.value("content-length", "0").toInt();
+        if (buffer.size() < headerEnd + 4 + bodyLength) {
+            return;  // Тіло ще не надійшло повністю
+        }
+        buffer.remove(0, headerEnd + 4 + bodyLength);
+        request.sequence = connection.nextRequest++;
+
+        handleRequest(socket, request);
+        if (!connections.contains(socket)) {
+            return;   // З'єднання закрито під час обробки
+        }
+    }
+}
+
+/**
+ * @brief Застосовує поточний режим збоїв
+ * @return true, якщо запит уже оброблено (або навмисно «завис»)
+ */
+bool PalantirStub::applyFault(QIODevice *socket, const HttpRequest &request) {
+    if (fault.mode == FaultMode::Off || QRandomGenerator::global()->generateDouble() >= fault.rate) {
+        return false;
+    }
+
+    switch (fault.mode) {
+    case FaultMode::Hang:
+        qDebug() << "💤 hang:" << request.path;
+        return true;  // Ніколи не відповідаємо — конвеєрні запити за ним на цьому з'єднанні теж чекають
+    case FaultMode::Error:
+        writeResponse(socket, 500, R"({"error":"Injected failure"})", request);
+        return true;
+    case FaultMode::Slow: {
+        QPointer<QIODevice> guard(socket);
+        HttpRequest delayed = request;
+        QTimer::singleShot(fault.delayMs, this, [this, guard, delayed]() {
+            if (guard) {
+                HttpRequest plain = delayed;
+                plain.headers.insert("x-fault-bypass", "1");
+                handleRequest(guard, plain);
+            }
+        });
+        return true;
+    }
+    case FaultMode::Off:
+        break;
+    }
+    return false;
+}
+
+void PalantirStub::handleRequest(QIODevice *socket, const HttpRequest &request) {
+    // 🔹 Перемикач збоїв під час роботи: GET /__fault?mode=hang&rate=0.5&delay_ms=8000
+    if (request.path == "/__fault") {
+        FaultConfig newFault;
+        newFault.mode = faultModeFromString(request.query.queryItemValue("mode"));
+        if (request.query.hasQueryItem("rate")) newFault.rate = request.query.queryItemValue("rate").toDouble();
+        if (request.query.hasQueryItem("delay_ms")) newFault.delayMs = request.query.queryItemValue("delay_ms").toInt();
+        setFault(newFault);
+        writeResponse(socket, 200, R"({"status":"ok"})", request);
+        return;
+    }
+
+    if (!request.headers.contains("x-fault-bypass") && applyFault(socket, request)) {
+        return;
+    }
+
+    int clientId = request.query.queryItemValue("client_id").toInt();
+    int terminalId = request.query.queryItemValue("terminal_id").toInt();
+
+    QJsonObject body;
+    if (request.path == "/clients") {
+        body = clientsJson();
+    } else if (request.path == "/azs_list") {
+        body = azsListJson(clientId);
+    } else if (request.path == "/terminal_info") {
+        body = terminalInfoJson(clientId, terminalId);
+    } else if (request.path == "/terminal_info_batch" && batchEnabled) {
+        body = terminalInfoBatchJson(clientId, request.query.queryItemValue("terminal_ids"));
+    } else if (request.path == "/reservoirs_info") {
+        body = reservoirsJson(clientId, terminalId);
+    } else if (request.path == "/posdatas") {
+        body = posdatasJson(clientId, terminalId);
+    } else {
+        writeResponse(socket, 404, R"({"error":"Unknown endpoint"})", request);
+        return;
+    }
+
+    writeResponse(socket, 200, QJsonDocument(body).toJson(QJsonDocument::Compact), request);
+}
+
+void PalantirStub::writeResponse(QIODevice *socket, int status, const QByteArray &body, const HttpRequest &request) {
+    QByteArray encoding = body.size() >= compressionMinBytes ? negotiateEncoding(request) : QByteArray();
+    QByteArray payload = encoding.isEmpty() ? body : compress(body, encoding);
+    if (payload.isEmpty() && !body.isEmpty()) {
+        encoding.clear();
+        payload = body;
+    }
+
+    QByteArray reason = status == 200 ? "OK" : status == 404 ? "Not Found" : "Internal Server Error";
+    QByteArray response;
+    response += "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n";
+    response += "Content-Type: application/json; charset=utf-8\r\n";
+    if (!encoding.isEmpty()) {
+        response += "Content-Encoding: " + encoding + "\r\n";
+        response += "Vary: Accept-Encoding\r\n";
+    }
+    response += "Content-Length: " + QByteArray::number(payload.size()) + "\r\n";
+    response += "Connection: keep-alive\r\n\r\n";
+    response += payload;
+    sendInOrder(socket, request.sequence, response);
+}
+
+void PalantirStub::sendInOrder(QIODevice *socket, quint64 sequence, const QByteArray &response) {
+    auto it = connections.find(socket);
+    if (it == connections.end()) {
+        return;   // Клієнт уже від'єднався
+    }
+    it->ready.insert(sequence, response);
+    while (!it->ready.isEmpty() && it->ready.firstKey() == it->nextResponse) {
+        socket->write(it->ready.take(it->nextResponse));
+        ++it->nextResponse;
+    }
+}
+
+/**
+ * @brief Обирає кодування з Accept-Encoding клієнта (zstd > gzip > deflate)
+ * @return Порожній рядок — відповідати без стиснення
+ */
+QByteArray PalantirStub::negotiateEncoding(const HttpRequest &request) const {
+    if (!compressionEnabled) {
+        return QByteArray();
+    }
+
+    QList<QByteArray> accepted;
+    const QList<QByteArray> items = request.headers.value("accept-encoding").split(',');
+    for (const QByteArray &item : items) {
+        QList<QByteArray> parts = item.split(';');
+        QByteArray name = parts.first().trimmed().toLower();
+        bool disabled = parts.size() > 1 && parts[1].trimmed() == "q=0";
+        if (!name.isEmpty() && !disabled) {
+            accepted.append(name);
+        }
+    }
+
+#ifdef SHADOWFAX_HAVE_ZSTD
+    if (accepted.contains("zstd")) return "zstd";
+#endif
+#ifdef SHADOWFAX_HAVE_ZLIB
+    if (accepted.contains("gzip")) return "gzip";
+    if (accepted.contains("deflate")) return "deflate";
+#endif
+    return QByteArray();
+}
+
+QByteArray PalantirStub::compress(const QByteArray &body, const QByteArray &encoding) {
+#ifdef SHADOWFAX_HAVE_ZSTD
+    if (encoding == "zstd") {
+        QByteArray out(qsizetype(ZSTD_compressBound(size_t(body.size()))), Qt::Uninitialized);
+        size_t size = ZSTD_compress(out.data(), size_t(out.size()), body.constData(), size_t(body.size()), 3);
+        if (ZSTD_isError(size)) {
+            return QByteArray();
+        }
+        out.resize(qsizetype(size));
+        return out;
+    }
+#endif
+#ifdef SHADOWFAX_HAVE_ZLIB
+    if (encoding == "gzip" || encoding == "deflate") {
+        z_stream zs = {};
+        int windowBits = encoding == "gzip" ? 15 + 16 : 15;  // deflate у HTTP — це zlib-формат
+        if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return QByteArray();
+        }
+        QByteArray out(qsizetype(deflateBound(&zs, uLong(body.size()))), Qt::Uninitialized);
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(body.constData()));
+        zs.avail_in = uInt(body.size());
+        zs.next_out = reinterpret_cast<Bytef *>(out.data());
+        zs.avail_out = uInt(out.size());
+        int rc = deflate(&zs, Z_FINISH);
+        out.resize(qsizetype(zs.total_out));
+        deflateEnd(&zs);
+        return rc == Z_STREAM_END ? out : QByteArray();
+    }
+#endif
+    Q_UNUSED(body);
+    Q_UNUSED(encoding);
+    return QByteArray();
+}
+
+bool PalantirStub::terminalExists(int clientId, int terminalId) const {
+    return clientId >= 1 && clientId <= clientCount
+           && terminalId > 100 && terminalId <= 100 + terminalsPerClient;
+}
+
+QJsonObject PalantirStub::clientsJson() const {
+    QJsonArray data;
+    for (int id = 1; id <= clientCount; ++id) {
+        data.append(QJsonObject{{"id", id}, {"name", QString("Мережа %1").arg(id)}});
+    }
+    return QJsonObject{{"data", data}};
+}
+
+QJsonObject PalantirStub::azsListJson(int clientId) const {
+    if (clientId < 1 || clientId > clientCount) {
+        return QJsonObject{{"error", "Клієнта не знайдено"}};
+    }
+
+    QJsonArray list;
+    for (int t = 101; t <= 100 + terminalsPerClient; ++t) {
+        list.append(QJsonObject{{"terminal_id", t}, {"name", QString("АЗС №%1 Мережа %2").arg(t).arg(clientId)}});
+    }
+    return QJsonObject{{"azs_list", list}};
+}
+
+QJsonObject PalantirStub::terminalInfoJson(int clientId, int terminalId) const {
+    if (!terminalExists(clientId, terminalId)) {
+        return QJsonObject{{"error", "Термінал не знайдено"}};
+    }
+
+    QRandomGenerator rng(quint32(clientId * 100000 + terminalId));
+
+    QJsonArray dispensers;
+    int dispenserCount = 2 + int(rng.bounded(4));
+    for (int d = 1; d <= dispenserCount; ++d) {
+        QJsonArray pumps;
+        int pumpCount = 1 + int(rng.bounded(4));
+        for (int p = 1; p <= pumpCount; ++p) {
+            pumps.append(QJsonObject{
+                {"pump_id", p},
+                {"tank_id", 1 + int(rng.bounded(4))},
+                {"fuel_shortname", kFuels[rng.bounded(5)]}
+            });
+        }
+        dispensers.append(QJsonObject{
+            {"dispenser_id", d},
+            {"protocol", kProtocols[rng.bounded(5)]},
+            {"port", 1 + int(rng.bounded(8))},
+            {"speed", 9600},
+            {"address", d},
+            {"pumps_info", pumps}
+        });
+    }
+
+    return QJsonObject{
+        {"client_name", QString("Мережа %1").arg(clientId)},
+        {"terminal_id", terminalId},
+        {"adress", QString("м. Київ, вул. Тестова, %1").arg(terminalId)},
+        {"phone", QString("+38044%1").arg(clientId * 1000 + terminalId, 7, 10, QChar('0'))},
+        {"latitude", 44.4 + rng.generateDouble() * 8.0},
+        {"longitude", 22.2 + rng.generateDouble() * 17.8},
+        {"dispensers_info", dispensers}
+    };
+}
+
+/**
+ * @brief Пакетний terminal_info: terminal_ids=101,102,... -> {"terminals": [...]} у тому ж порядку
+ *
+ * Елемент для невідомого терміналу — {"terminal_id": N, "error": "..."}, як у відповіді окремого запиту.
+ */
+QJsonObject PalantirStub::terminalInfoBatchJson(int clientId, const QString &terminalIds) const {
+    if (clientId < 1 || clientId > clientCount) {
+        return QJsonObject{{"error", "Клієнта не знайдено"}};
+    }
+
+    QJsonArray terminals;
+    const QStringList ids = terminalIds.split(',', Qt::SkipEmptyParts);
+    for (const QString &id : ids) {
+        int terminalId = id.trimmed().toInt();
+        QJsonObject terminal = terminalInfoJson(clientId, terminalId);
+        if (terminal.contains("error")) {
+            terminal.insert("terminal_id", terminalId);
+        }
+        terminals.append(terminal);
+    }
+    return QJsonObject{{"terminals", terminals}};
+}
+
+QJsonObject PalantirStub::reservoirsJson(int clientId, int terminalId) const {
+    if (!terminalExists(clientId, terminalId)) {
+        return QJsonObject{{"error", "Термінал не знайдено"}};
+    }
+
+    QRandomGenerator rng(quint32(clientId * 100000 + terminalId + 7));
+    QJsonArray tanks;
+    for (int t = 1; t <= 4; ++t) {
+        int fuel = int(rng.bounded(5));
+        tanks.append(QJsonObject{
+            {"tank_id", t},
+            {"name", QString("Резервуар %1").arg(t)},
+            {"shortname", kFuels[fuel]},
+            {"minvalue", 500},
+            {"maxvalue", 20000 + int(rng.bounded(10)) * 1000},
+            {"deadmin", 100},
+            {"deadmax", 2900},
+            {"tubeamount", int(rng.bounded(300))}
+        });
+    }
+    return QJsonObject{{"reservoirs_info", tanks}};
+}
+
+QJsonObject PalantirStub::posdatasJson(int clientId, int terminalId) const {
+    if (!terminalExists(clientId, terminalId)) {
+        return QJsonObject{{"error", "Термінал не знайдено"}};
+    }
+
+    QRandomGenerator rng(quint32(clientId * 100000 + terminalId + 13));
+    QJsonArray posdatas;
+    int posCount = 1 + int(rng.bounded(3));
+    for (int p = 1; p <= posCount; ++p) {
+        QDateTime registered = QDateTime(QDate(2020, 1, 1), QTime(0, 0)).addDays(rng.bounded(2000));
+        posdatas.append(QJsonObject{
+            {"pos_id", p},
+            {"manufacturer", "ТОВ Юнісистем"},
+            {"model", kPosModels[rng.bounded(3)]},
+            {"posversion", QString("2.%1.%2").arg(rng.bounded(5)).arg(rng.bounded(20))},
+            {"mukversion", QString("1.%1").arg(rng.bounded(9))},
+            {"factorynumber", QString("ПБ%1").arg(rng.bounded(1000000), 7, 10, QChar('0'))},
+            {"regnumber", QString("30%1").arg(rng.bounded(100000000), 8, 10, QChar('0'))},
+            {"datreg", registered.toString(Qt::ISODate)}
+        });
+    }
+    return QJsonObject{{"posdatas", posdatas}};
+}
@@ -0,0 +1,95 @@
+#ifndef PALANTIRSTUB_H
+#define PALANTIRSTUB_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QUrlQuery>
+#include <QHash>
+#include <QMap>
+#include <QJsonObject>
+
+/**
+ * @brief Локальна заміна Palantír для розробки та навантажувальних перевірок.
+ *
+ * Віддає детерміновано згенеровані дані мережі АЗС на тих самих endpoint'ах,
+ * що й справжній бекенд, і вміє імітувати збої (fault injection). Слухає
+ * loopback TCP і, за потреби, Unix domain socket — з однаковою обробкою.
+ */
+class PalantirStub : public QObject {
+    Q_OBJECT
+public:
+    enum class FaultMode { Off, Slow, Hang, Error };
+
+    struct FaultConfig {
+        FaultMode mode = FaultMode::Off;
+        double rate = 1.0;   // Частка запитів, до яких застосовується збій
+        int delayMs = 8000;  // Затримка для режиму Slow
+    };
+
+    explicit PalantirStub(QObject *parent = nullptr);
+
+    bool listen(quint16 port);                            // 0 — будь-який вільний порт
+    bool listenLocal(const QString &name);                // HTTP/1.1 через Unix domain socket (ім'я або шлях)
+    quint16 serverPort() const { return server.serverPort(); }
+    void setFault(const FaultConfig &fault);
+    void setFleetSize(int clients, int terminalsPerClient);
+    void setCompression(bool enabled, int minBytes);
+    void setBatchEndpoint(bool enabled);   // Вимкнено — /terminal_info_batch відповідає 404, як бекенд без нього
+
+    static FaultMode faultModeFromString(const QString &name);
+    static QString faultModeToString(FaultMode mode);
+
+private slots:
+    void onNewConnection();
+    void onNewLocalConnection();
+
+private:
+    struct HttpRequest {
+        QString method;
+        QString path;
+        QUrlQuery query;
+        QHash<QByteArray, QByteArray> headers;
+        quint64 sequence = 0;   // Порядковий номер запиту на з'єднанні
+    };
+
+    // 🔹 HTTP/1.1: відповіді на конвеєрні запити йдуть у порядку запитів, навіть якщо
+    //    повільний запит (fault slow/hang) відповідає пізніше за наступні
+    struct Connection {
+        QByteArray buffer;                   // Незавершений запит
+        quint64 nextRequest = 0;
+        quint64 nextResponse = 0;
+        QMap<quint64, QByteArray> ready;     // Готові відповіді, що чекають на попередні
+    };
+
+    void accept(QIODevice *socket);
+    void onReadyRead(QIODevice *socket);
+    void handleRequest(QIODevice *socket, const HttpRequest &request);
+    void writeResponse(QIODevice *socket, int status, const QByteArray &body, const HttpRequest &request);
+    void sendInOrder(QIODevice *socket, quint64 sequence, const QByteArray &response);
+    bool applyFault(QIODevice *socket, const HttpRequest &request);
+    QByteArray negotiateEncoding(const HttpRequest &request) const;
+    static QByteArray compress(const QByteArray &body, const QByteArray &encoding);
+
+    QJsonObject clientsJson() const;
+    QJsonObject azsListJson(int clientId) const;
+    QJsonObject terminalInfoJson(int clientId, int terminalId) const;
+    QJsonObject terminalInfoBatchJson(int clientId, const QString &terminalIds) const;
+    QJsonObject reservoirsJson(int clientId, int terminalId) const;
+    QJsonObject posdatasJson(int clientId, int terminalId) const;
+    bool terminalExists(int clientId, int terminalId) const;
+
+    QTcpServer server;
+    QLocalServer localServer;
+    QHash<QIODevice *, Connection> connections;
+    FaultConfig fault;
+    int clientCount = 5;
+    int terminalsPerClient = 40;
+    bool compressionEnabled = true;
+    int compressionMinBytes = 1024;
+    bool batchEnabled = true;
+};
+
+#endif // PALANTIRSTUB_H